@@ -0,0 +1,535 @@
+#include "galileo_solver.h"
+#include "field_kernel.h"
+#include "inav_crc.h"
+#include "sync_scanner.h"
+#include "ubx_checksum.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+
+#ifdef GALILEO_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#include <termios.h>
+#include <unistd.h>
+
+
+// Mostly non-UBX bytes with a UBX frame every few kilobytes, like a capture
+// after corruption or a port shared with other protocols
+std::vector<uint8_t> makeDirtyCapture(size_t size)
+{
+  std::mt19937 rng(42);
+  std::vector<uint8_t> capture(size);
+
+  for (auto &byte : capture)
+    byte = rng() & 0xff;
+
+  for (size_t i = 0; i + 48 < size; i += 2048 + rng() % 4096)
+  {
+    capture[i] = 0xb5;
+    capture[i + 1] = 0x62;
+  }
+
+  return capture;
+}
+
+
+std::vector<uint8_t> readCapture(const std::string &path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+
+void report(const std::string &name, size_t bytes, size_t candidates, const std::function<size_t()> &run)
+{
+  const int repeat = 5;
+  double best = 0;
+
+  for (int i = 0; i < repeat; i++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    candidates = run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (i == 0 || elapsed.count() < best)
+      best = elapsed.count();
+  }
+
+  std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(10) << bytes / best / 1e6 << " MB/s" << std::setw(12) << candidates << " results" << std::endl;
+}
+
+
+// Per-byte state machine that read() used before the vectorized scanner
+size_t scanPerByte(const std::vector<uint8_t> &capture)
+{
+  GalileoSolver solver("");
+  size_t candidates = 0;
+
+  for (uint8_t byte : capture)
+  {
+    solver.checkSyncHeaders(byte);
+
+    if (solver.sync_lock_1_ && solver.sync_lock_2_)
+    {
+      ++candidates;
+      solver.sync_lock_1_ = false;
+      solver.sync_lock_2_ = false;
+    }
+  }
+  return candidates;
+}
+
+
+size_t scanVectorized(SyncScanner scanner, const std::vector<uint8_t> &capture)
+{
+  const uint8_t *p = capture.data();
+  const uint8_t *end = p + capture.size();
+  size_t candidates = 0;
+
+  while ((p = findSyncHeaders(scanner, p, end)) < end - 1)
+  {
+    ++candidates;
+    p += 2;
+  }
+  return candidates;
+}
+
+
+void benchSyncScanner(const std::vector<uint8_t> &capture)
+{
+  const char *names[] = {"scalar", "sse2", "avx2"};
+
+  std::cout << "\nSync header scan over " << capture.size() / (1 << 20) << " MiB" << std::endl;
+
+  report("per-byte checkSyncHeaders", capture.size(), 0, [&] { return scanPerByte(capture); });
+
+  for (SyncScanner scanner : {SCALAR_SCANNER, SSE2_SCANNER, AVX2_SCANNER})
+  {
+    if (scanner > activeSyncScanner())
+      continue;
+
+    report(std::string("findSyncHeaders ") + names[scanner], capture.size(), 0,
+           [&] { return scanVectorized(scanner, capture); });
+  }
+}
+
+
+// Checksums the capture in NAV-SIG sized pieces, 8 + 16 * 60 bytes
+void benchChecksum(const std::vector<uint8_t> &capture)
+{
+  const char *names[] = {"scalar", "sse2", "avx2"};
+  const size_t piece = 968;
+
+  std::cout << "\nUBX checksum over " << capture.size() / (1 << 20) << " MiB in " << piece << " byte payloads" << std::endl;
+
+  for (ChecksumKernel kernel : {SCALAR_CHECKSUM, SSE2_CHECKSUM, AVX2_CHECKSUM})
+  {
+    if (kernel > activeChecksumKernel())
+      continue;
+
+    report(std::string("updateChecksum ") + names[kernel], capture.size(), 0, [&] {
+      size_t matches = 0;
+
+      for (size_t i = 0; i + piece <= capture.size(); i += piece)
+      {
+        uint8_t ck_a = 0, ck_b = 0;
+        updateChecksum(kernel, ck_a, ck_b, capture.data() + i, piece);
+        matches += (ck_a == ck_b);
+      }
+      return matches;
+    });
+  }
+}
+
+
+// Ephemeris pages with random data bits, the word types 1 to 5 in turn
+// like a satellite sends them
+std::vector<InavPage> makeEphemerisPages(size_t count)
+{
+  std::mt19937 rng(42);
+  std::vector<InavPage> pages;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    uint32_t words[8] = {};
+    for (int j = 0; j < 5; j++)
+      words[j] = rng();
+
+    words[0] = (words[0] & 0x00ffffff) | (i % 5 + 1) << 24; // Word type behind the flags
+    words[4] |= 0x80000000;
+    pages.emplace_back(words);
+  }
+
+  return pages;
+}
+
+
+void benchFieldKernels()
+{
+  const char *names[] = {"scalar", "bmi2"};
+  const size_t count = 1 << 20;
+  std::vector<InavPage> pages = makeEphemerisPages(1025); // A multiple of 5, page i has word type i % 5 + 1
+
+  std::cout << "\nEphemeris field decoding of " << count << " pages" << std::endl;
+
+  for (FieldKernel kernel : {SCALAR_FIELDS, BMI2_FIELDS})
+  {
+    if (kernel > supportedFieldKernel())
+      continue;
+
+    GalileoSolver::WordType1 word_1;
+    GalileoSolver::WordType2 word_2;
+    GalileoSolver::WordType3 word_3;
+    GalileoSolver::WordType4 word_4;
+    GalileoSolver::WordType5 word_5;
+    double best = 0;
+    unsigned sum = 0;
+
+    for (int repeat = 0; repeat < 5; repeat++)
+    {
+      auto start = std::chrono::steady_clock::now();
+
+      for (size_t i = 0; i < count; i++)
+      {
+        const InavPage &page = pages[i % pages.size()];
+
+        switch (i % 5)
+        {
+        case 0: decodeWord(kernel, page, word_1); sum += word_1.issue_of_data; break;
+        case 1: decodeWord(kernel, page, word_2); sum += word_2.issue_of_data; break;
+        case 2: decodeWord(kernel, page, word_3); sum += word_3.issue_of_data; break;
+        case 3: decodeWord(kernel, page, word_4); sum += word_4.issue_of_data; break;
+        default: decodeWord(kernel, page, word_5); sum += word_5.time_of_week; break;
+        }
+      }
+
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+      if (repeat == 0 || elapsed.count() < best)
+        best = elapsed.count();
+    }
+
+    std::cout << std::left << std::setw(28) << std::string("decodeWord ") + names[kernel] << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << count / best / 1e6 << " Mpages/s" << std::setw(12) << sum
+              << " checksum" << std::endl;
+  }
+}
+
+
+// CRC of pages with random words with each kernel, in time per page
+void benchInavCrc()
+{
+  const char *names[] = {"table", "clmul"};
+  std::mt19937 rng(42);
+  std::vector<uint32_t> words(8 << 16);
+
+  for (uint32_t &word : words)
+    word = rng();
+
+  const size_t pages = words.size() / 8;
+
+  std::cout << "\nI/NAV CRC-24Q of " << pages << " pages" << std::endl;
+
+  for (CrcKernel kernel : {TABLE_CRC, CLMUL_CRC})
+  {
+    if (kernel > activeCrcKernel())
+      continue;
+
+    double best = 0;
+    uint32_t sum = 0;
+
+    for (int repeat = 0; repeat < 5; repeat++)
+    {
+      auto start = std::chrono::steady_clock::now();
+
+      for (size_t i = 0; i < pages; i++)
+        sum += inavCrc(kernel, words.data() + 8 * i);
+
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+      if (repeat == 0 || elapsed.count() < best)
+        best = elapsed.count();
+    }
+
+    std::cout << std::left << std::setw(28) << std::string("inavCrc ") + names[kernel] << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << best / pages * 1e9 << " ns/page" << std::setw(12) << sum
+              << " checksum" << std::endl;
+  }
+}
+
+
+// Navigation data sink that takes the time of every flushed record and the
+// count of UBX-RXM-SFRBX frames the solver had decoded by then
+class TimedSink : public std::streambuf
+{
+private:
+  const GalileoSolver *solver_ = nullptr;
+  std::vector<std::pair<std::chrono::steady_clock::time_point, unsigned>> flushes_;
+
+protected:
+  int overflow(int c) override { return c; }
+  std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+
+  // Called on the solver thread
+  int sync() override
+  {
+    flushes_.emplace_back(std::chrono::steady_clock::now(), solver_->sfrbxCount());
+    return 0;
+  }
+
+public:
+  void attach(const GalileoSolver *solver) { solver_ = solver; }
+  const std::vector<std::pair<std::chrono::steady_clock::time_point, unsigned>> &flushes() const { return flushes_; }
+};
+
+
+// Replays the start of a capture through a pseudo terminal like a receiver
+// on a serial port: frames at the baud rate, an idle gap before each
+// UBX-NAV-SIG frame that starts an epoch. Measures how long after the last
+// byte of the page that completes a record the record is flushed
+void benchLiveLatency(const std::vector<uint8_t> &capture, unsigned baud_rate, size_t size)
+{
+  const auto epoch_gap = std::chrono::milliseconds(20);
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    return;
+
+  const std::string device = ptsname(master);
+  int slave = open(device.c_str(), O_RDWR | O_NOCTTY);
+  termios tty;
+
+  tcgetattr(slave, &tty);
+  cfmakeraw(&tty);
+  tcsetattr(slave, TCSANOW, &tty);
+
+  TimedSink sink;
+  std::ostream nav_data_file(&sink);
+  std::ostringstream console;
+  GalileoSolver solver(device, console, nav_data_file);
+  sink.attach(&solver);
+
+  std::thread reader([&] { solver.read(); });
+
+  std::vector<std::chrono::steady_clock::time_point> sfrbx_written; // Checksum-valid UBX-RXM-SFRBX frames
+  auto start = std::chrono::steady_clock::now();
+  size_t begin = 0;
+
+  // Whole frames only, found by their sync headers and lengths
+  while (begin + 8 <= std::min(size, capture.size()))
+  {
+    const uint8_t *frame = capture.data() + begin;
+    const bool framed = frame[0] == 0xb5 && frame[1] == 0x62;
+    size_t length = std::min<size_t>(framed ? 8 + (frame[4] | frame[5] << 8) : 1, capture.size() - begin);
+
+    if (framed && frame[2] == 0x01 && frame[3] == 0x43)
+    {
+      start += epoch_gap;
+      std::this_thread::sleep_until(start + std::chrono::microseconds(begin * 10 * 1000000 / baud_rate));
+    }
+
+    if (write(master, frame, length) != static_cast<ssize_t>(length))
+      break;
+
+    begin += length;
+
+    if (framed && frame[2] == 0x02 && frame[3] == 0x13 && length >= 8)
+    {
+      uint8_t ck_a = 0, ck_b = 0;
+      updateChecksum(ck_a, ck_b, frame + 2, length - 4);
+
+      if (ck_a == frame[length - 2] && ck_b == frame[length - 1])
+        sfrbx_written.push_back(std::chrono::steady_clock::now());
+    }
+
+    std::this_thread::sleep_until(start + std::chrono::microseconds(begin * 10 * 1000000 / baud_rate));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  close(master);
+  reader.join();
+  close(slave);
+
+  std::vector<double> latencies;
+
+  for (const auto &flush : sink.flushes())
+    if (flush.second > 0 && flush.second <= sfrbx_written.size())
+      latencies.push_back(std::chrono::duration<double, std::milli>(flush.first - sfrbx_written[flush.second - 1]).count());
+
+  std::sort(latencies.begin(), latencies.end());
+
+  std::cout << "\nLive replay of " << begin / 1024 << " KiB at " << baud_rate << " baud" << std::endl;
+
+  if (latencies.empty())
+  {
+    std::cout << "no records" << std::endl;
+    return;
+  }
+
+  std::cout << std::left << std::setw(28) << "record latency" << std::right << std::fixed << std::setprecision(3)
+            << std::setw(10) << latencies[latencies.size() / 2] << " ms median" << std::setw(10)
+            << latencies.back() << " ms max" << std::setw(8) << latencies.size() << " records" << std::endl;
+}
+
+
+// Drops the pages of a file from the page cache, so the next read comes from the disk
+void evictFile(const std::string &path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+
+  if (fd >= 0)
+  {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+
+// Decodes a capture that is not in the page cache in every input mode. The
+// asynchronous modes overlap the disk reads with the decoder, like on an
+// archive larger than the memory
+void benchColdRead(const std::string &path)
+{
+  const char *names[] = {"stream", "mmap", "async", "direct"};
+  const size_t size = readCapture(path).size();
+
+  std::cout << "\nCold read of " << size / (1 << 20) << " MiB, page cache dropped before each run" << std::endl;
+
+  // The sources alone, with nothing to overlap the disk with
+  auto drain = [&](ByteSource &source) {
+    std::vector<uint8_t> chunk(ChunkBuffer::DEFAULT_CHUNK_SIZE);
+    size_t bytes = 0;
+    long count;
+
+    while ((count = source.read(chunk.data(), chunk.size())) > 0)
+      bytes += count;
+
+    return bytes;
+  };
+
+  report("FileSource", size, 0, [&] {
+    FileSource source;
+    evictFile(path);
+    source.open(path);
+    return drain(source);
+  });
+
+  for (bool direct : {false, true})
+  {
+    report(direct ? "AsyncFileSource direct" : "AsyncFileSource", size, 0, [&] {
+      AsyncFileSource source;
+      evictFile(path);
+      source.open(path, direct);
+      return drain(source);
+    });
+  }
+
+  for (GalileoSolver::InputMode mode : {GalileoSolver::STREAM, GalileoSolver::MMAP, GalileoSolver::ASYNC, GalileoSolver::DIRECT})
+  {
+    report(std::string("read() ") + names[mode], size, 0, [&] {
+      std::ostringstream console;
+      std::ostream nav_data_file(nullptr);
+      GalileoSolver solver(path, console, nav_data_file, mode);
+
+      evictFile(path);
+      solver.read();
+
+      return solver.sfrbxCount();
+    });
+  }
+}
+
+
+// Writes a gzip copy of a capture with zlib, or the capture as it is without
+bool writeGzip(const std::vector<uint8_t> &capture, const std::string &path)
+{
+#ifdef GALILEO_HAVE_ZLIB
+  gzFile file = gzopen(path.c_str(), "wb6");
+
+  if (file == nullptr)
+    return false;
+
+  for (size_t i = 0; i < capture.size(); i += 1 << 20)
+    gzwrite(file, capture.data() + i, std::min<size_t>(1 << 20, capture.size() - i));
+
+  return gzclose(file) == Z_OK;
+#else
+  return false;
+#endif
+}
+
+
+// Decodes a gzip capture while it is decompressed, against decompressing it
+// to a scratch file first and decoding that
+void benchCompressed(const std::vector<uint8_t> &capture)
+{
+  const std::string compressed = "/tmp/galileo_bench.ubx.gz";
+  const std::string scratch = "/tmp/galileo_bench_scratch.ubx";
+
+  if (!writeGzip(capture, compressed))
+    return;
+
+  std::cout << "\nCompressed capture, " << capture.size() / (1 << 20) << " MiB decoded" << std::endl;
+
+  auto decode = [](const std::string &path) {
+    std::ostringstream console;
+    std::ostream nav_data_file(nullptr);
+    GalileoSolver solver(path, console, nav_data_file);
+
+    solver.read();
+    return solver.sfrbxCount();
+  };
+
+  report("read() of the .gz", capture.size(), 0, [&] { return decode(compressed); });
+
+  report("decompress, then read()", capture.size(), 0, [&] {
+    FileSource file;
+    CompressedSource source;
+    std::ofstream out(scratch, std::ios::binary);
+    std::vector<uint8_t> chunk(ChunkBuffer::DEFAULT_CHUNK_SIZE);
+    long count;
+
+    file.open(compressed);
+    source.open(&file);
+
+    while ((count = source.read(chunk.data(), chunk.size())) > 0)
+      out.write(reinterpret_cast<const char *>(chunk.data()), count);
+
+    out.close();
+    return decode(scratch);
+  });
+
+  std::remove(compressed.c_str());
+  std::remove(scratch.c_str());
+}
+
+
+int main(int argc, char **argv) 
+{
+  std::vector<uint8_t> capture = (argc > 1) ? readCapture(argv[1]) : makeDirtyCapture(64 << 20);
+
+  benchSyncScanner(capture);
+  benchChecksum(capture);
+  benchFieldKernels();
+  benchInavCrc();
+
+  if (argc > 1)
+  {
+    benchColdRead(argv[1]);
+    benchCompressed(capture);
+  }
+
+  // galileo_bench CAPTURE BAUD replays the capture like a receiver on a serial port
+  if (argc > 2)
+    benchLiveLatency(capture, std::stoul(argv[2]), 256 << 10);
+
+  return 0;
+}
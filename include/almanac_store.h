@@ -0,0 +1,139 @@
+#ifndef GALILEO_ALMANAC_STORE_H
+#define GALILEO_ALMANAC_STORE_H
+
+#include "inav_fields.h"
+#include "orbit_store.h"
+
+
+/**
+ * @brief Almanac of one satellite. Angles in radians, as in the field
+ *        descriptors of the word types 7 to 10
+ *
+ * @param svid Satellite the almanac describes
+ * @param issue_of_data IODa of the almanac set
+ * @param week_num 2 least significant bits of the reference week
+ * @param ref_time Reference time of week t0a [s]
+ * @param delta_root_a Difference to the nominal square root of the semi-major axis [sqrt(m)]
+ * @param diff_ia_na Difference to the nominal inclination
+ * @param clock_corr_bias Clock correction af0 [s]
+ * @param clock_corr_linear Clock correction af1 [s/s]
+ */
+struct Almanac
+{
+  unsigned svid = 0;
+  unsigned issue_of_data = 0;
+  unsigned week_num = 0;
+  unsigned ref_time = 0;
+  double delta_root_a = 0;
+  double eccentricity = 0;
+  double perigee = 0;
+  double diff_ia_na = 0;
+  double longitude = 0;
+  double roc_ra = 0;
+  double mean_anomaly = 0;
+  double clock_corr_bias = 0;
+  double clock_corr_linear = 0;
+  uint8_t sig_health_e5b = 0;
+  uint8_t sig_health_e1 = 0;
+};
+
+
+/**
+ * @brief Almanacs of the constellation, one per satellite with the IODa
+ *        it came with. The words 7 to 10 carry the almanacs of 3
+ *        satellites, each split over 2 consecutive words. A satellite
+ *        is stored once both words of one transmission agree on the IODa,
+ *        so a lost word never joins the halves of two different sets.
+ *        Every transmitting satellite and signal has its own partial
+ *        almanac, the complete ones are shared
+ *
+ */
+class AlmanacStore
+{
+private:
+  struct Pending
+  {
+    Almanac almanac;
+    unsigned next_word = 0; // Word type that completes the almanac, 0 if none is pending
+  };
+
+  Pending pending_[36][2]; // Transmitting satellite, E1-B and E5b-I
+  Almanac almanacs_[36];
+  bool valid_[36] = {};
+
+  // Starts the almanac of svid from the first word, none for an invalid svid
+  void start(Pending &pending, unsigned svid, unsigned issue_of_data, unsigned next_word);
+
+  // Takes the second word when it is the one the pending almanac waits for
+  Almanac *finish(Pending &pending, unsigned issue_of_data, unsigned word_type);
+
+  // Stores a complete almanac over the one of its satellite
+  const Almanac *keep(const Almanac &almanac);
+
+public:
+  /**
+   * @brief Adds an almanac word
+   *
+   * @param page Page of word type 7 to 10, other pages are ignored
+   * @param svId Transmitting satellite, 1..36
+   * @param sigId Signal of the page, 1 for E1-B and 5 for E5b-I, pages of
+   *        other signals are ignored
+   * @return const Almanac* almanac completed by the word, nullptr if none
+   */
+  const Almanac *add(const InavPage &page, unsigned svId, unsigned sigId);
+
+
+  /**
+   * @brief Returns the almanac of a satellite
+   *
+   * @param svid Satellite ID
+   * @return const Almanac* nullptr if no almanac is stored
+   */
+  const Almanac *find(unsigned svid) const
+  {
+    return (svid >= 1 && svid <= 36 && valid_[svid - 1]) ? &almanacs_[svid - 1] : nullptr;
+  }
+
+
+  /**
+   * @brief Returns the almanac of a satellite from one almanac set
+   *
+   * @param svid Satellite ID
+   * @param issue_of_data IODa of the set
+   * @return const Almanac* nullptr if the stored almanac is of another set
+   */
+  const Almanac *find(unsigned svid, unsigned issue_of_data) const
+  {
+    const Almanac *almanac = find(svid);
+    return (almanac != nullptr && almanac->issue_of_data == issue_of_data) ? almanac : nullptr;
+  }
+
+
+  /**
+   * @brief Returns the number of satellites with an almanac
+   *
+   * @return unsigned
+   */
+  unsigned count() const;
+
+
+  /**
+   * @brief Forgets all almanacs and partial almanacs
+   *
+   */
+  void clear();
+};
+
+
+/**
+ * @brief Converts an almanac into an orbit model for visibility prediction
+ *
+ * @param almanac Almanac
+ * @param gst Time of use, GST seconds. The 2 bit reference week is taken
+ *        as the one closest to it
+ * @return KeplerOrbit
+ */
+KeplerOrbit almanacOrbit(const Almanac &almanac, double gst);
+
+
+#endif // GALILEO_ALMANAC_STORE_H
@@ -0,0 +1,116 @@
+#ifndef GALILEO_ASYNC_SOURCE_H
+#define GALILEO_ASYNC_SOURCE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ubx_reader.h"
+
+
+/**
+ * @brief Reads a file with several large reads in flight through
+ *        io_uring, so the disk works on the next blocks while the parser
+ *        frames and decodes the current one. The blocks are read into
+ *        aligned buffers in file order and copied out by read(). Direct
+ *        I/O opens the file with O_DIRECT, so reprocessing an archive
+ *        does not push everything else out of the page cache. Where
+ *        io_uring is not available, like on old kernels or under seccomp
+ *        filters that block it, the blocks are read with pread(2) one
+ *        after another. The file is read as it is when opened
+ *
+ */
+class AsyncFileSource : public ByteSource
+{
+public:
+  static const size_t DEFAULT_BLOCK_SIZE = 4 << 20; // 4 MiB
+  static const unsigned DEFAULT_DEPTH = 4; // Blocks in flight
+  static const size_t DIRECT_ALIGNMENT = 4096; // Alignment of the buffers, offsets and sizes of direct I/O
+
+private:
+  struct Block
+  {
+    uint8_t *data = nullptr;
+    uint64_t offset = 0;
+    size_t size = 0; // Bytes of the file in this block
+    bool pending = false; // Submitted and not completed yet
+    bool queued = false; // In flight in the ring, otherwise a pending block is read with pread
+    int result = 0; // Byte count or negative errno of the completed read
+  };
+
+  struct Ring; // Queues shared with the kernel, defined in the translation unit
+
+  const size_t block_size_;
+  const unsigned depth_;
+
+  int fd_ = -1;
+  bool direct_ = false;
+  uint64_t file_size_ = 0;
+  uint64_t next_offset_ = 0; // Offset of the next block to submit
+
+  std::vector<Block> blocks_; // Ring of the blocks in file order
+  unsigned current_ = 0; // Block that read() copies from
+  size_t position_ = 0; // Bytes of the current block already copied
+
+  std::unique_ptr<Ring> ring_;
+
+
+  /**
+   * @brief Starts reading the next block of the file into a free block
+   *
+   * @param block Block whose bytes are used up
+   */
+  void submit(Block &block);
+
+
+  /**
+   * @brief Waits until a block is read
+   *
+   * @param block Submitted block
+   * @return true when the bytes of the file are in the block
+   * @return false when the read failed
+   */
+  bool complete(Block &block);
+
+
+  void close();
+
+public:
+  /**
+   * @brief Constructs a new Async File Source object, the buffers are
+   *        allocated by open
+   *
+   * @param block_size Bytes per read, rounded up to DIRECT_ALIGNMENT
+   * @param depth Number of reads in flight
+   */
+  explicit AsyncFileSource(size_t block_size = DEFAULT_BLOCK_SIZE, unsigned depth = DEFAULT_DEPTH);
+
+  ~AsyncFileSource() override;
+
+
+  AsyncFileSource(const AsyncFileSource &) = delete;
+  AsyncFileSource &operator=(const AsyncFileSource &) = delete;
+
+
+  /**
+   * @brief Opens the file and submits the first reads
+   *
+   * @param path Path to the binary file
+   * @param direct Bypasses the page cache. Falls back to buffered reads
+   *               when the file system does not support it
+   * @return true when the file is opened
+   * @return false when the file cannot be opened or the buffers cannot be allocated
+   */
+  bool open(const std::string &path, bool direct = false);
+
+
+  long read(uint8_t *dst, size_t size) override;
+
+
+  bool async() const { return ring_ != nullptr; }
+  bool direct() const { return direct_; }
+};
+
+
+#endif // GALILEO_ASYNC_SOURCE_H
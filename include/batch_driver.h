@@ -0,0 +1,148 @@
+#ifndef GALILEO_BATCH_DRIVER_H
+#define GALILEO_BATCH_DRIVER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "galileo_solver.h"
+
+
+/**
+ * @brief Outcome of one input file of a batch
+ *
+ * @param path Path of the input file
+ * @param hash Content hash of the file, 16 hex digits
+ * @param status CONVERTED, SKIPPED when a previous run converted the same
+ *               content, FAILED when the file or its outputs cannot be opened
+ * @param bytes File size
+ * @param sfrbx UBX-RXM-SFRBX frames
+ * @param nav_sig UBX-NAV-SIG frames
+ * @param pages Galileo pages decoded
+ * @param resync Frames rejected by checksum or length
+ * @param seconds Conversion time
+ */
+struct BatchResult
+{
+  enum Status { CONVERTED, SKIPPED, FAILED };
+
+  std::string path;
+  std::string hash;
+  Status status = FAILED;
+  uint64_t bytes = 0;
+  unsigned int sfrbx = 0;
+  unsigned int nav_sig = 0;
+  unsigned int pages = 0;
+  unsigned int resync = 0;
+  double seconds = 0;
+};
+
+
+
+/**
+ * @brief Converts many captures with one GalileoSolver per file on a
+ *        bounded pool of worker threads. Each file gets its own navigation
+ *        data and console log in the output directory. Content hashes of
+ *        the converted files are kept in a manifest there, so files that
+ *        were converted before are skipped, even when renamed or moved
+ *
+ */
+class BatchDriver
+{
+private:
+  const std::string output_dir_;
+  const unsigned jobs_;
+  const GalileoSolver::InputMode mode_;
+
+  std::vector<std::string> inputs_;
+  std::vector<BatchResult> results_;
+
+  std::mutex mutex_; // Guards the manifest and the claimed hashes
+  std::set<std::string> claimed_; // Hashes converted before or claimed by an input of this run
+
+public:
+  static const char *MANIFEST_NAME; // Converted hashes, one "hash<TAB>path" line per file
+  static const char *SUMMARY_NAME; // Summary of the last run
+
+  /**
+   * @brief Constructs a new Batch Driver object
+   *
+   * @param output_dir Directory of the outputs, the manifest and the summary
+   * @param jobs Number of files converted at the same time
+   * @param mode Input mode of the solvers
+   */
+  BatchDriver(const std::string &output_dir, unsigned jobs,
+              GalileoSolver::InputMode mode = GalileoSolver::STREAM);
+
+
+  /**
+   * @brief Adds input files. A directory adds the .ubx, .ubx.gz and
+   *        .ubx.zst files under it, a pattern adds the files it matches
+   *
+   * @param input File, directory or glob pattern
+   * @return true when at least one file is added
+   * @return false when nothing matches
+   */
+  bool addInput(const std::string &input);
+
+
+  /**
+   * @brief Converts the inputs and writes the summary
+   *
+   * @return true when no file failed
+   * @return false when a file failed or the output directory cannot be made
+   */
+  bool run();
+
+
+  const std::vector<BatchResult> &results() const { return results_; }
+
+
+  /**
+   * @brief 64 bit FNV-1a hash of a whole file
+   *
+   * @param path Path of the file
+   * @param hash Hash in 16 hex digits
+   * @param bytes File size
+   * @return true when the file is read
+   * @return false when the file cannot be read
+   */
+  static bool hashFile(const std::string &path, std::string &hash, uint64_t &bytes);
+
+private:
+  /**
+   * @brief Reads the hashes of the manifest into the claimed hashes
+   *
+   */
+  void loadManifest();
+
+
+  /**
+   * @brief Runs a task for every input on the pool of jobs
+   *
+   * @param task Task run with the result of one input
+   */
+  void forEachInput(const std::function<void(BatchResult &)> &task);
+
+
+  /**
+   * @brief Converts one file whose content is claimed by this run
+   *
+   * @param result Result holding the path and the hash of the file
+   */
+  void convert(BatchResult &result);
+
+
+  /**
+   * @brief Writes the per file lines and the totals into the summary
+   *        file and to the console
+   *
+   */
+  void writeSummary() const;
+};
+
+
+#endif // GALILEO_BATCH_DRIVER_H
@@ -0,0 +1,114 @@
+#ifndef GALILEO_COMPRESSED_SOURCE_H
+#define GALILEO_COMPRESSED_SOURCE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ubx_reader.h"
+
+
+/**
+ * @brief Decompresses gzip and zstd captures on the fly. The format is
+ *        taken from the magic bytes at the start of the input, so the
+ *        file name does not matter and a plain capture is passed through.
+ *        The compressed bytes are read in blocks of INPUT_SIZE and
+ *        decompressed straight into the buffer of the caller, there is no
+ *        intermediate file and the memory stays bounded. Concatenated
+ *        gzip members and zstd frames are read one after another.
+ *        gzip needs zlib and zstd needs libzstd at build time
+ *
+ */
+class CompressedSource : public ByteSource
+{
+public:
+  enum Format { PLAIN, GZIP, ZSTD };
+
+  static const size_t INPUT_SIZE = 256 << 10; // 256 KiB of compressed input per read
+  static const size_t MAGIC_SIZE = 4; // Bytes needed to tell the formats apart
+
+  struct Decoder; // Decompressor state of the format, defined in the translation unit
+
+private:
+  ByteSource *source_ = nullptr;
+  Format format_ = PLAIN;
+  std::unique_ptr<Decoder> decoder_;
+
+  // Bytes read from the source and not used yet, the magic bytes first
+  std::vector<uint8_t> input_;
+  size_t input_begin_ = 0;
+  size_t input_end_ = 0;
+  bool input_done_ = false; // The source ended
+
+  bool corrupt_ = false;
+
+
+  /**
+   * @brief Decompresses into dst until some bytes are produced
+   *
+   * @param dst destination
+   * @param size maximum byte count
+   * @param wait Whether to wait for the source, like read
+   * @return long number of bytes produced, 0 at the end of the input
+   *         or without wait when no input is available, negative on error
+   */
+  long decode(uint8_t *dst, size_t size, bool wait);
+
+public:
+  CompressedSource();
+  ~CompressedSource() override;
+
+
+  /**
+   * @brief Tells the format from the first bytes of an input
+   *
+   * @param data first bytes
+   * @param size byte count, MAGIC_SIZE tells all formats apart
+   * @return Format GZIP or ZSTD for their magic bytes, PLAIN otherwise
+   */
+  static Format detect(const uint8_t *data, size_t size);
+
+
+  /**
+   * @brief Tells the format of a file from its first bytes
+   *
+   * @param path Path to the file
+   * @return Format PLAIN also when the file cannot be read
+   */
+  static Format detect(const std::string &path);
+
+
+  /**
+   * @brief Checks whether the decompressor of a format is built in
+   *
+   * @param format Format
+   * @return true when inputs of the format can be read
+   * @return false when the library was missing at build time
+   */
+  static bool supported(Format format);
+
+
+  /**
+   * @brief Reads the magic bytes of a source and starts the decompressor
+   *
+   * @param source Opened source, it has to stay valid while this one is read
+   * @return true when the input can be read
+   * @return false when it is compressed in a format that is not built in
+   */
+  bool open(ByteSource *source);
+
+
+  long read(uint8_t *dst, size_t size) override;
+
+  long readAvailable(uint8_t *dst, size_t size) override;
+
+
+  Format format() const { return format_; }
+
+  // Set when the compressed data is damaged or ends in the middle of a stream
+  bool corrupt() const { return corrupt_; }
+};
+
+
+#endif // GALILEO_COMPRESSED_SOURCE_H
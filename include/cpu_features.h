@@ -0,0 +1,27 @@
+#ifndef GALILEO_CPU_FEATURES_H
+#define GALILEO_CPU_FEATURES_H
+
+
+/**
+ * @brief Instruction set extensions used by the vectorized kernels.
+ *        Detected once at runtime, all false on non-x86 builds
+ * 
+ */
+struct CpuFeatures
+{
+  bool sse2 = false;
+  bool avx2 = false;
+  bool bmi2 = false; // With a fast pext, not on the microcoded one of AMD family 17h
+  bool pclmul = false;
+};
+
+
+/**
+ * @brief Returns the features of the running CPU
+ * 
+ * @return const CpuFeatures& 
+ */
+const CpuFeatures &cpuFeatures();
+
+
+#endif // GALILEO_CPU_FEATURES_H
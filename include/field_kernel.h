@@ -0,0 +1,59 @@
+#ifndef GALILEO_FIELD_KERNEL_H
+#define GALILEO_FIELD_KERNEL_H
+
+#include "galileo_solver.h"
+#include "inav_fields.h"
+
+
+/**
+ * @brief Kernels that extract the fields of the ephemeris words 1 to 5.
+ *        The BMI2 kernel gathers each field with one pext per 64 bit
+ *        half of the page. It measured slower than the scalar kernel, so
+ *        the scalar one is the default and BMI2 is only used when asked
+ *        for, as by the benchmark
+ *
+ */
+enum FieldKernel { SCALAR_FIELDS, BMI2_FIELDS };
+
+
+/**
+ * @brief Decodes an ephemeris word of a page with a fixed kernel. A
+ *        kernel the CPU does not support falls back to the best
+ *        supported one. Defined for GalileoSolver::WordType1 to WordType5
+ *
+ * @tparam Word Word type struct of the page
+ * @param kernel Kernel
+ * @param page Reassembled page of the word type
+ * @param word Decoded fields
+ */
+template <class Word> void decodeWord(FieldKernel kernel, const InavPage &page, Word &word);
+
+
+/**
+ * @brief Returns the best kernel this CPU supports
+ *
+ * @return FieldKernel
+ */
+FieldKernel supportedFieldKernel();
+
+
+/**
+ * @brief Returns the kernel that decodeWord uses by default
+ *
+ * @return FieldKernel
+ */
+FieldKernel activeFieldKernel();
+
+
+/**
+ * @brief Decodes an ephemeris word of a page with the active kernel
+ *
+ */
+template <class Word>
+inline void decodeWord(const InavPage &page, Word &word)
+{
+  decodeWord(activeFieldKernel(), page, word);
+}
+
+
+#endif // GALILEO_FIELD_KERNEL_H
@@ -0,0 +1,257 @@
+#ifndef GALILEO_FRAME_INDEX_H
+#define GALILEO_FRAME_INDEX_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+#pragma pack(1) // Entries are written to the sidecar file as they are
+
+/**
+ * @brief One checksum-valid UBX frame of a capture
+ *
+ * @param offset Offset of the sync headers in the capture
+ * @param length Payload length
+ * @param message_class UBX message class
+ * @param message_id UBX message id
+ * @param gnssId GNSS of an UBX-RXM-SFRBX frame, NONE otherwise
+ * @param svId Satellite of an UBX-RXM-SFRBX frame, NONE otherwise
+ * @param sigId Signal of an UBX-RXM-SFRBX frame, NONE otherwise
+ * @param word_type Word type of a nominal Galileo I/NAV page, NONE otherwise
+ * @param iTOW iTOW of the last UBX-NAV-SIG frame up to this one, NO_ITOW before the first
+ * @param gst Galileo System Time of the frame in seconds since the GST
+ *            epoch, week number * 604800 + time of week. Taken from the
+ *            word types 0, 5 and 6 and advanced by the UBX-NAV-SIG iTOW in
+ *            between. It never decreases along the file, NO_GST before the
+ *            first time
+ */
+struct FrameIndexEntry
+{
+  static const uint8_t NONE = 0xff;
+  static const uint32_t NO_ITOW = 0xffffffff;
+  static const uint32_t NO_GST = 0;
+
+  uint64_t offset;
+  uint16_t length;
+  uint8_t message_class;
+  uint8_t message_id;
+  uint8_t gnssId;
+  uint8_t svId;
+  uint8_t sigId;
+  uint8_t word_type;
+  uint32_t iTOW;
+  uint32_t gst;
+};
+
+#pragma pack()
+
+
+
+/**
+ * @brief Frame index of a capture, kept in a binary sidecar file next to
+ *        it. The sidecar starts with a header that holds the size and the
+ *        modification time of the indexed capture, so a stale index is
+ *        noticed, followed by the entries in capture order. A loaded
+ *        sidecar is memory mapped, so looking up a time window touches
+ *        only the pages of the entries it needs
+ *
+ */
+class FrameIndex
+{
+public:
+  static const uint32_t MAGIC = 0x58444947; // "GIDX"
+  static const uint16_t VERSION = 2; // 2 added the GST of the entries
+
+private:
+#pragma pack(1)
+  struct Header
+  {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entry_size;
+    uint64_t capture_size;
+    int64_t capture_mtime; // Nanoseconds
+    uint64_t count;
+  };
+#pragma pack()
+
+  uint64_t capture_size_ = 0;
+  int64_t capture_mtime_ = 0;
+  std::vector<FrameIndexEntry> entries_; // Entries of an index being built
+
+  // Mapped sidecar of a loaded index
+  void *map_ = nullptr;
+  size_t map_size_ = 0;
+
+  const FrameIndexEntry *begin_ = nullptr;
+  const FrameIndexEntry *end_ = nullptr;
+
+  void unmap();
+
+public:
+  FrameIndex() = default;
+  ~FrameIndex() { unmap(); }
+
+  // The entries may point into the mapping
+  FrameIndex(const FrameIndex &) = delete;
+  FrameIndex &operator=(const FrameIndex &) = delete;
+
+
+  /**
+   * @brief Path of the sidecar file of a capture
+   *
+   * @param capture Path to the capture
+   * @return std::string capture path with ".idx" appended
+   */
+  static std::string sidecarPath(const std::string &capture);
+
+
+  /**
+   * @brief Drops the entries and takes the size and the modification
+   *        time of the capture that is indexed next
+   *
+   * @param capture Path to the capture
+   * @return true when the capture can be stat'ed
+   * @return false when it cannot
+   */
+  bool reset(const std::string &capture);
+
+
+  /**
+   * @brief Checks that the capture is still the one that was indexed
+   *
+   * @param capture Path to the capture
+   * @return true when its size and modification time are unchanged
+   * @return false when the capture changed or cannot be stat'ed
+   */
+  bool isCurrent(const std::string &capture) const;
+
+
+  /**
+   * @brief Maps a sidecar file
+   *
+   * @param path Path to the sidecar file
+   * @return true when the file is mapped
+   * @return false when it cannot be mapped, is truncated or has another version
+   */
+  bool load(const std::string &path);
+
+
+  /**
+   * @brief Writes the sidecar file. It is written under a temporary name
+   *        and renamed, so readers never see a half written index
+   *
+   * @param path Path to the sidecar file
+   * @return true when the file is written
+   * @return false when it cannot be written
+   */
+  bool write(const std::string &path) const;
+
+
+  void add(const FrameIndexEntry &entry);
+
+
+  /**
+   * @brief Finds the entries of a time window by binary search
+   *
+   * @param first First GST of the window
+   * @param last Last GST of the window
+   * @param begin First entry whose time is not before first
+   * @param end First entry whose time is after last
+   */
+  void findWindow(uint32_t first, uint32_t last, const FrameIndexEntry *&begin, const FrameIndexEntry *&end) const;
+
+
+  const FrameIndexEntry *begin() const { return begin_; }
+  const FrameIndexEntry *end() const { return end_; }
+  size_t size() const { return end_ - begin_; }
+  const FrameIndexEntry &operator[](size_t i) const { return begin_[i]; }
+
+  uint64_t captureSize() const { return capture_size_; }
+};
+
+
+
+/**
+ * @brief Selection of Galileo I/NAV pages by satellite, word type and
+ *        GST window. An empty satellite or word type set selects all of
+ *        them, no window selects the whole file
+ *
+ */
+class FrameQuery
+{
+public:
+  static const uint32_t DEFAULT_LEAD_IN = 60; // Two I/NAV subframes, every word type 1 to 10 is sent in them
+
+private:
+  uint64_t satellites_ = 0; // Bit svId for each selected satellite
+  uint64_t word_types_ = 0; // Bit word_type for each selected word type
+
+  bool windowed_ = false;
+  uint32_t first_time_ = 0;
+  uint32_t last_time_ = 0;
+
+public:
+  void addSatellite(unsigned svId) { satellites_ |= 1ULL << (svId & 63); }
+
+  void addWordTypes(unsigned first, unsigned last);
+
+
+  /**
+   * @brief Limits the selection to a GST window. The window is extended
+   *        backwards by the lead-in, so the ephemerides that are valid at
+   *        its start are complete
+   *
+   * @param first First GST of the window
+   * @param last Last GST of the window
+   * @param lead_in Seconds decoded before the window
+   */
+  void setWindow(uint32_t first, uint32_t last, uint32_t lead_in = DEFAULT_LEAD_IN);
+
+
+  bool windowed() const { return windowed_; }
+  uint32_t firstTime() const { return first_time_; }
+  uint32_t lastTime() const { return last_time_; }
+
+
+  /**
+   * @brief Checks whether a frame is a selected page
+   *
+   * @param entry Index entry of the frame
+   * @return true when the frame is a Galileo page of the selection
+   * @return false otherwise
+   */
+  bool matches(const FrameIndexEntry &entry) const;
+
+
+  /**
+   * @brief Parses a selection like "E11,E12:1-5,10". Satellites are
+   *        written as E<svId>, word types as numbers or ranges after
+   *        the colon. Either part may be left out, "E11" and ":1-5"
+   *        are valid too
+   *
+   * @param spec Selection text
+   * @param query Parsed selection
+   * @return true when the text is valid
+   * @return false when it is not
+   */
+  static bool parse(const std::string &spec, FrameQuery &query);
+
+
+  /**
+   * @brief Parses a GST window like "1148:302400,1148:309600", the first
+   *        and the last time as week number and time of week
+   *
+   * @param spec Window text
+   * @param first First GST of the window
+   * @param last Last GST of the window
+   * @return true when the text is valid
+   * @return false when it is not
+   */
+  static bool parseWindow(const std::string &spec, uint32_t &first, uint32_t &last);
+};
+
+
+#endif // GALILEO_FRAME_INDEX_H
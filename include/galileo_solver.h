@@ -1,6 +1,8 @@
 #ifndef GALILEO_GALILEO_SOLVER_H
 #define GALILEO_GALILEO_SOLVER_H
 
+#include <cstdint>
+#include <cstddef>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -9,9 +11,71 @@
 #include <bitset>
 #include <cfloat>
 #include <iomanip>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "almanac_store.h"
+#include "async_source.h"
+#include "compressed_source.h"
+#include "frame_index.h"
+#include "gst_clock.h"
+#include "inav_fec2.h"
+#include "inav_fields.h"
+#include "orbit_store.h"
+#include "ubx_reader.h"
 
 #define INIT DBL_MAX
 
+/**
+ * @brief State that the 36 navigation data batches of one solver share.
+ *        Holds the output streams and the flags of the header, so several
+ *        solvers in one process do not write into each other's output.
+ *        Records are formatted in the text streams of the context, which
+ *        keep the number format of this solver, and handed to the sinks
+ *        in one piece. The format state of the sinks is never changed
+ * 
+ * @param console Sink of the console messages and the ephemeris print out
+ * @param nav_data_file Sink of the navigation data output
+ * @param console_text Formatting stream of the console records
+ * @param nav_data_text Formatting stream of the navigation data records
+ */
+struct NavigationContext
+{
+  std::ostream *console = &std::cout;
+  std::ostream *nav_data_file = nullptr;
+
+  std::ostringstream console_text;
+  std::ostringstream nav_data_text;
+
+  /**
+   * @brief These flags makes sure the joint Ionospheric and Time System Correction
+   *        parameters are processed once
+   * 
+   */
+  bool flag1_ = false;
+  bool flag2_ = false;
+  bool flag3_ = false;
+  bool flag4_ = false;
+
+
+  bool live = false; // Records of a live input are flushed to the navigation data file right away too
+
+  OrbitStore orbits; // Provisional orbits from the reduced data and the full ephemerides
+  AlmanacStore almanacs; // Almanacs of the constellation, assembled from the words of every satellite
+  GstClock clock; // Time of every replayed page and the GST-UTC and GST-GPS conversions
+
+
+  /**
+   * @brief Hands the formatted records to the sinks. The console is
+   *        flushed, the navigation data file is left to its own buffer
+   *        unless the input is live
+   * 
+   */
+  void flush();
+};
+
+
 /**
  * @brief Encapsulates the navigation data and provides functions that
  *        are capable of managing a set of data. This class will have 36 
@@ -87,51 +151,54 @@ private:
 
 private:
   /**
-   * @brief Almanac data sent by E5b freq. Naming is the same as page type member structs.
-   *        Page Type 7, 8, 9, 10
+   * @brief Words 1 to 4 of one IODnav. After an upload the words of the
+   *        new IODnav arrive among those of the previous one, so each
+   *        IODnav is assembled in its own slot and only a complete set
+   *        becomes the ephemeris above
    * 
+   * @param words Bit n - 1 is set once the word type n arrived
+   * @param age Order in which the slots were taken, the oldest is reused
    */
-  double alm_e5_issue_of_data_ = INIT;
-  unsigned int alm_e5_week_num_;
-  unsigned int alm_e5_ref_time_;
-  unsigned int alm_e5_svid_;
-  double alm_e5_delta_root_a_ = INIT;
-  double alm_e5_eccentricity_ = INIT;
-  double alm_e5_perigee_ = INIT;
-  double alm_e5_diff_ia_na_ = INIT;
-  double alm_e5_longitude_ = INIT;
-  double alm_e5_roc_ra_ = INIT;
-  double alm_e5_mean_anomaly_ = INIT;
-  double alm_e5_clock_corr_bias_ = INIT;
-  double alm_e5_clock_corr_linear_ = INIT;
-  uint8_t alm_e5_sig_health_e5b_;
-  uint8_t alm_e5_sig_health_e1_; 
+  struct Staging
+  {
+    unsigned issue_of_data = 0;
+    unsigned words = 0;
+    unsigned age = 0;
+    unsigned svId;
+    unsigned epoch;
+    double ref_time, mean_anomaly, eccentricity, semi_major_root;
+    double omega0, inclination_angle, omega, roc_inclination_angle;
+    double omega_dot, delta_n, cuc, cus, crc, crs, sisa;
+    double cic, cis, clock_bias, clock_drift, clock_drift_rate;
+  };
+
+  static const unsigned STAGING_SLOTS = 3; // The current IODnav, an upload and a stray word
+  static const unsigned ALL_WORDS = 0xf;
+
+  Staging staging_[STAGING_SLOTS];
+  unsigned staged_ = 0; // Slots taken so far, for their age
 
 
-private:
   /**
-   * @brief Almanac data sent by E1 freq. Naming is the same as page type member structs.
-   *        Page Type 7, 8, 9, 10
+   * @brief Returns the slot of an IODnav. A new IODnav takes a free slot
+   *        or the oldest one
    * 
+   * @param issue_of_data IODnav
+   * @return Staging& 
    */
-  double alm_e1_issue_of_data_ = INIT;
-  unsigned int alm_e1_week_num_;
-  unsigned int alm_e1_ref_time_;
-  unsigned int alm_e1_svid_;
-  double alm_e1_delta_root_a_ = INIT;
-  double alm_e1_eccentricity_ = INIT;
-  double alm_e1_perigee_ = INIT;
-  double alm_e1_diff_ia_na_ = INIT;
-  double alm_e1_longitude_ = INIT;
-  double alm_e1_roc_ra_ = INIT;
-  double alm_e1_mean_anomaly_ = INIT;
-  double alm_e1_clock_corr_bias_ = INIT;
-  double alm_e1_clock_corr_linear_ = INIT;
-  uint8_t alm_e1_sig_health_e5b_;
-  uint8_t alm_e1_sig_health_e1_; 
+  Staging &stage(unsigned issue_of_data);
+
+
+  /**
+   * @brief Marks a word of a slot as received. The set of a slot that
+   *        is complete becomes the ephemeris and frees the slot
+   * 
+   * @param slot Slot of the word
+   * @param word_type 1 to 4
+   */
+  void arrive(Staging &slot, unsigned word_type);
 
 
-private:
   /**
    * @brief Ionospheric and Time System Correction Parameters
    * 
@@ -162,18 +229,18 @@ private:
   unsigned gpga_tow_;
   unsigned gpga_week_;
 
-public: 
+  NavigationContext *context_ = nullptr; // Shared with the other batches of the solver
+
+public:
   /**
-   * @brief These flags makes sure the joint Ionospheric and Time System Correction
-   *        parameters are processed once
+   * @brief Attaches the batch to the context of its solver. Has to be
+   *        called before any word is added
    * 
+   * @param context 
    */
-  static bool flag1_;
-  static bool flag2_;
-  static bool flag3_;
-  static bool flag4_;
+  void setContext(NavigationContext *context) { context_ = context; }
+
 
-public:
   /**
    * @brief Assigns the words read to the navigation data batch member variables
    *        according to related page types. This template function is defined
@@ -196,28 +263,20 @@ public:
 
 
   /**
-   * @brief Resets the member almanac e5 variables to INIT values 
-   *        when the data batch is fully assigned
-   * 
-   */
-  void resetAlmanacE5();
-
-
-  /**
-   * @brief Resets the member almanac e1 variables to INIT values 
-   *        when the data batch is fully assigned
+   * @brief Checks whether the navigation data batch is full or not.
+   *        If it is full, then calls write and and reset functions.
+   *        Also checks if the header information is obtained.
    * 
    */
-  void resetAlmanacE1();
+  void checkFull();
 
 
   /**
-   * @brief Checks whether the navigation data batch is full or not.
-   *        If it is full, then calls write and and reset functions.
-   *        Also checks if the header information is obtained.
+   * @brief Returns the orbit and clock model of a full batch
    * 
+   * @return KeplerOrbit 
    */
-  void checkFull();
+  KeplerOrbit orbit() const;
 
 
   /**
@@ -234,10 +293,12 @@ public:
    * @brief Writes the almanac data to console. This function is 
    *        actually designed to be as an example. Users can implement
    *        their own function to meet their needs after receiving a
-   *        full batch of navigation data.
+   *        full almanac from the almanac store.
    * 
+   * @param almanac Almanac of one satellite
+   * @param sigId Signal the almanac was received on
    */
-  void writeAlmanac(uint8_t sigId);
+  void writeAlmanac(const Almanac &almanac, uint8_t sigId);
 
 
   /**
@@ -247,17 +308,73 @@ public:
    * 
    */
   void writeHeader();
+
+
+  /**
+   * @brief Writes the partially assembled batch into a checkpoint. The
+   *        object is written byte by byte, so only the same build reads
+   *        it back
+   * 
+   * @param out Checkpoint stream
+   */
+  void save(std::ostream &out) const;
+
+
+  /**
+   * @brief Reads a batch written by save. The context is kept
+   * 
+   * @param in Checkpoint stream
+   * @return true when the batch is read
+   * @return false when the stream ends before
+   */
+  bool load(std::istream &in);
 };
 
 
 
 class GalileoSolver 
 {
-private:
-  const std::string file_; // Path to the binary file
-  std::ifstream raw_data_; // Input stream object to read through file
+public:
+  /**
+   * @brief Input modes of the solver. STREAM reads the input in large 
+   *        chunks into a reused buffer, so pipes and growing files work too.
+   *        MMAP maps the whole file into memory and frames, checksums and
+   *        decodes directly from the mapped pages, a compressed file is
+   *        streamed instead. ASYNC reads like STREAM
+   *        but keeps several block reads in flight through io_uring, so a
+   *        cold file is read while it is decoded. DIRECT is ASYNC with
+   *        direct I/O that bypasses the page cache
+   * 
+   */
+  enum InputMode { STREAM, MMAP, ASYNC, DIRECT };
 
+private:
+  const std::string file_; // Path to the binary file, "-" for standard input
+
+  const InputMode input_mode_;
+
+  FileSource source_; // Input of the STREAM mode
+  LiveSource live_source_; // Input of the STREAM mode for terminals, FIFOs and pipes
+  AsyncFileSource async_source_; // Input of the ASYNC and DIRECT modes
+  CompressedSource compressed_source_; // Decompresses or passes on the input of the chunk buffer
+  bool live_ = false; // The input is live, the parser never waits for bytes it does not need yet
+  BufferSource feed_source_; // Input of feed, the bytes of the current piece
+  bool fed_ = false; // Set by the first feed until finishFeed
+  unsigned baud_rate_ = 0; // Baud rate set on a serial input, 0 keeps the current one
+  ChunkBuffer buffer_; // Chunk buffer of the STREAM, ASYNC and DIRECT modes
+
+  // Mapped file region used in MMAP mode
+  const uint8_t *map_begin_ = nullptr;
+  const uint8_t *map_end_ = nullptr;
+
+  // Window of the input bytes that are ready to be parsed
+  const uint8_t *cursor_ = nullptr;
+  const uint8_t *end_ = nullptr;
+
+  NavigationContext context_; // Output streams and header flags of this solver
+  std::ofstream owned_nav_data_file_; // Default navigation data output of the path only constructor
   NavigationData nav_data[36]{}; // NavigationData instances for all possible Satellite ID numbers
+  Fec2Recovery fec2_[36]; // Words 1 to 4 and 17 to 20 of each satellite, to rebuild lost ephemeris words
 
   uint8_t byte_;
 
@@ -278,14 +395,15 @@ private:
   unsigned int true_counter = 0;
   unsigned int false_counter = 0;
 
+  unsigned int skipped_counter = 0; // Unhandled frames jumped over by length
+  unsigned int resync_counter = 0; // Frames rejected by checksum or length
+  unsigned int crc_counter = 0; // Pages rejected by the I/NAV CRC, counted as false too
+  unsigned int fec2_counter = 0; // Words 1 to 4 rebuilt from the FEC2 words
+
   unsigned short even_; // To check even and odd components are in right order
-  unsigned int pos_; // To arrange the bit position dynamically while reading the bits through data words
-  unsigned int bitsize_ = 32;
 
-  // 8 bytes masks to concatenate data bits at dword4 and dword5
-  const uint64_t MASK1_ = 0x3F00C0000000;
-  const uint64_t MASK2_ = 0xFFFFC00000000000;
-  const uint64_t MASK3_ = 0x3FFFC000;
+  uint32_t page_words_[8]; // Data words of the current SFRBX frame, loaded with its checksum
+  InavPage page_; // The page of the data words, reassembled once by loadSfrbx
 
   enum MessageType { UBX_RXM_SFRBX, UBX_NAV_SIG, NOT_DEFINED } msg_type_;
 
@@ -850,25 +968,434 @@ private:
   unsigned int wordtype63_counter = 0;
 
 
+  /**
+   * @brief Head of a follow mode checkpoint. The followed file is known
+   *        by its device and inode, so a rotated log starts over. The 36
+   *        navigation data batches follow the head, then the GST clock
+   *        with the time of the last page of each satellite and the FEC2
+   *        words collected for each satellite
+   * 
+   * @param offset Input offset where the decoding continues
+   * @param flags Header flags of the navigation context
+   */
+  struct CheckpointHead
+  {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t nav_data_size;
+    uint64_t device;
+    uint64_t inode;
+    uint64_t offset;
+    uint8_t flags[4];
+  };
+
+
+  /**
+   * @brief Output of one decoded frame that has to be replayed in capture
+   *        order. Pages are the words added to the navigation data, the
+   *        other kinds stand for the console messages of the frame
+   * 
+   */
+  struct DecodedPage
+  {
+    enum Kind { PAGE, WARNING, CHECKSUM_FALSE } kind = PAGE;
+    WordType word_type = SPARE;
+    uint8_t svId = 0;
+    uint8_t sigId = 0;
+
+    union
+    {
+      WordType1 word_type_1 = {};
+      WordType2 word_type_2;
+      WordType3 word_type_3;
+      WordType4 word_type_4;
+      WordType5 word_type_5;
+      WordType6 word_type_6;
+      WordType10 word_type_10;
+    };
+
+    InavPage raw; // Page as received, the FEC2 recovery reads its bits
+  };
+
+
+  /**
+   * @brief One byte range of a parallel read. The worker starts at the first
+   *        frame in the range that passes its checksum and decodes every
+   *        frame whose sync headers start before the range end
+   * 
+   * @param begin First byte of the range
+   * @param end End of the range, frames may run past it
+   * @param lock Sync headers of the first validated frame, nullptr if none
+   * @param exit Cursor after the last frame decoded by the worker
+   * @param solver Worker solver that holds the counters of the range
+   * @param pages Decoded pages and messages in capture order
+   * @param done Set by the worker when the range is decoded
+   */
+  struct DecodedRange
+  {
+    const uint8_t *begin = nullptr;
+    const uint8_t *end = nullptr;
+    const uint8_t *lock = nullptr;
+    const uint8_t *exit = nullptr;
+    std::unique_ptr<GalileoSolver> solver;
+    std::vector<DecodedPage> pages;
+    bool done = false;
+  };
+
+  std::vector<DecodedPage> *pages_ = nullptr; // Set on workers, which record pages instead of adding them
+
+  bool follow_ = false; // Set by follow, the end of the input is where the file grows
+  bool stalled_ = false; // A frame ran past the end of a followed file, it is retried at the cursor
+
+  FrameIndex *index_ = nullptr; // Set while building an index, frames are recorded instead of decoded
+  uint32_t iTOW_ = FrameIndexEntry::NO_ITOW; // iTOW of the last UBX-NAV-SIG frame, for the index
+  uint32_t gst_ = FrameIndexEntry::NO_GST; // Last Galileo System Time seen, for the index
+
+
 public:
+  static const size_t DEFAULT_RANGE_SIZE = 32 << 20; // 32 MiB
+  static const char *DEFAULT_NAV_DATA_PATH; // Output of the path only constructor
+  static const uint32_t CHECKPOINT_MAGIC = 0x504b4347; // "GCKP"
+  static const uint16_t CHECKPOINT_VERSION = 2;
+  static const int FOLLOW_POLL_MS = 500; // Longest wait for the file to grow before the stop flag is checked
+
   /**
    * @brief Constructs a new Galileo Solver object and initializes
-   *        the member file variable
+   *        the member file variable. Writes to the console and opens
+   *        DEFAULT_NAV_DATA_PATH for the navigation data, so only one
+   *        such solver should run at a time
+   * 
+   * @param path Path to the binary file
+   * @param mode Input mode, stream or memory mapped
+   * @param chunk_size Byte count read per chunk in STREAM mode
+   */
+  explicit GalileoSolver(const std::string &path, InputMode mode = STREAM,
+                         size_t chunk_size = ChunkBuffer::DEFAULT_CHUNK_SIZE);
+
+
+  /**
+   * @brief Constructs a new Galileo Solver object that writes into the
+   *        given streams instead of the console and the default output
+   *        file. Solvers with their own streams can run concurrently.
+   *        A sink shared by concurrent solvers has to take concurrent
+   *        writes, like std::cout does
    * 
    * @param path Path to the binary file
+   * @param console Stream of the console messages
+   * @param nav_data_file Stream of the navigation data output
+   * @param mode Input mode, stream or memory mapped
+   * @param chunk_size Byte count read per chunk in STREAM mode
    */
-  explicit GalileoSolver(const std::string &path);
+  GalileoSolver(const std::string &path, std::ostream &console, std::ostream &nav_data_file,
+                InputMode mode = STREAM, size_t chunk_size = ChunkBuffer::DEFAULT_CHUNK_SIZE);
+
+
+  // The navigation data batches point to the context of their solver
+  GalileoSolver(const GalileoSolver &) = delete;
+  GalileoSolver &operator=(const GalileoSolver &) = delete;
+
+
+  /**
+   * @brief Unmaps the file if it is still mapped
+   * 
+   */
+  ~GalileoSolver();
 
   
   /**
-   * @brief Main reading function
+   * @brief Sets the baud rate of a serial input, read() sets it when it
+   *        opens the device
+   * 
+   * @param baud_rate Baud rate, 0 keeps the current one
+   */
+  void setBaudRate(unsigned baud_rate) { baud_rate_ = baud_rate; }
+
+
+  /**
+   * @brief Main reading function. Terminals, FIFOs and pipes are read as
+   *        live inputs in STREAM mode: a frame is decoded as soon as its
+   *        last byte arrives and every record is flushed to the sinks
+   *        when it is complete
+   * 
+   * @return true when the input is read to its end
+   * @return false when the input cannot be opened
+   */
+  bool read();
+
+
+  /**
+   * @brief Decodes a memory mapped file on several threads. The file is
+   *        split into byte ranges that workers resynchronize and decode
+   *        into page records. The calling thread merges the ranges in
+   *        capture order, re-decoding the frames at the range seams, so
+   *        the navigation data and the output are the same as read()
+   * 
+   * @param threads Worker thread count
+   * @param range_size Byte count of each range
+   * @return true when the file is read to its end
+   * @return false when the file cannot be mapped
+   */
+  bool readParallel(unsigned threads, size_t range_size = DEFAULT_RANGE_SIZE);
+
+
+  /**
+   * @brief Follows a growing file. Decodes what is in the file, then waits
+   *        with inotify for appended bytes and decodes only those. A frame
+   *        that is not completely written yet is retried when the file
+   *        grows. Ends when stop is set or the file is moved or deleted,
+   *        after decoding what was written up to then.
+   *        Each time the decoder catches up with the file, the checkpoint
+   *        is saved. A later call with the same checkpoint continues at its
+   *        offset with the saved navigation data and header flags, so the
+   *        output continues where it stopped. The counters cover only the
+   *        frames decoded by this call
+   * 
+   * @param checkpoint Path to the checkpoint file, empty for none
+   * @param stop Set by another thread or a signal handler to end following
+   * @return true when the file is followed until stop
+   * @return false when the file cannot be opened or is truncated
+   */
+  bool follow(const std::string &checkpoint, const std::atomic<bool> &stop);
+
+
+  /**
+   * @brief Decodes bytes of a stream that arrives in pieces, like the
+   *        bytes of a socket. The frames that are complete are decoded
+   *        right away, the bytes of an incomplete one are kept until the
+   *        next piece. Records are flushed when they are complete
+   * 
+   * @param data Bytes of the next piece, only used during the call
+   * @param size Byte count
+   */
+  void feed(const uint8_t *data, size_t size);
+
+
+  /**
+   * @brief Ends the fed stream. The bytes left over are decoded like the
+   *        end of a file and the summary is written to the console, so
+   *        the output is the same as read() of the whole stream
+   * 
+   */
+  void finishFeed();
+
+
+  /**
+   * @brief Decodes the frames that are completely in the followed file
+   *        or in the fed bytes
+   * 
+   */
+  void decodeAvailable();
+
+
+  /**
+   * @brief Waits until the followed file grows, at most FOLLOW_POLL_MS
+   * 
+   * @param notify inotify descriptor watching the file, negative to poll
+   * @return true when the file is still followed
+   * @return false when it was moved, deleted or truncated
+   */
+  bool waitForGrowth(int notify);
+
+
+  /**
+   * @brief Writes the offset, the header flags, the navigation data, the
+   *        GST clock and the FEC2 words into the checkpoint under a
+   *        temporary name and renames it
+   * 
+   * @param path Path to the checkpoint file
+   * @param head Head with the file identity and the offset
+   * @return true when the checkpoint is written
+   * @return false when it cannot be written
+   */
+  bool saveCheckpoint(const std::string &path, CheckpointHead head) const;
+
+
+  /**
+   * @brief Reads a checkpoint of the same file written by this build
+   * 
+   * @param path Path to the checkpoint file
+   * @param head Head with the identity of the followed file, gets the offset
+   * @return true when the checkpoint is read into the navigation data
+   * @return false when it is missing or belongs to another file or build
+   */
+  bool loadCheckpoint(const std::string &path, CheckpointHead &head);
+
+
+  /**
+   * @brief Frames the whole file like read() and records every valid
+   *        frame into the index instead of decoding it. The file is
+   *        memory mapped, so the offsets are file offsets
+   * 
+   * @param index Index of the file, reset first
+   * @return true when the file is indexed to its end
+   * @return false when the file cannot be mapped
+   */
+  bool buildIndex(FrameIndex &index) const;
+
+
+  /**
+   * @brief Decodes only the frames of the index that the query selects.
+   *        Each selected frame is framed and checksummed again at its
+   *        offset, the bytes in between are never touched. A GST window
+   *        is looked up by binary search, so only the index entries of
+   *        the window are read
+   * 
+   * @param index Index of the file
+   * @param query Selected satellites and word types
+   * @return true when the selected frames are read
+   * @return false when the file cannot be mapped or changed since it was
+   *         indexed
+   */
+  bool readIndexed(const FrameIndex &index, const FrameQuery &query);
+
+
+  /**
+   * @brief Records the valid frame at the cursor into the index
+   * 
+   */
+  void indexFrame();
+
+
+  /**
+   * @brief Advances the index time by a Galileo System Time. Times before
+   *        the current one are ignored, so the entry times never decrease
+   * 
+   * @param week Week number, the current week when only the time of week is known
+   * @param time_of_week Time of week in seconds
+   * @param has_week Whether week is known
+   */
+  void advanceTime(uint32_t week, uint32_t time_of_week, bool has_week);
+
+
+  /**
+   * @brief Decodes the frames from the cursor whose sync headers start
+   *        before limit. Frames may run past limit. The cursor is left
+   *        where the next sync hunt starts
+   * 
+   * @param limit End of the sync header positions
+   */
+  void decodeRange(const uint8_t *limit);
+
+
+  /**
+   * @brief Decodes one range on a worker solver that shares the mapping
+   * 
+   * @param range Range to decode
+   */
+  void decodeWorkerRange(DecodedRange &range) const;
+
+
+  /**
+   * @brief Continues the serial decoding over one range. The pages of the
+   *        worker are replayed when the sync hunt reaches its first
+   *        validated frame, otherwise the range is decoded again here
+   * 
+   * @param range Range decoded by a worker
+   */
+  void mergeRange(DecodedRange &range);
+
+
+  /**
+   * @brief Finds the first frame that starts before limit and passes
+   *        its checksum
+   * 
+   * @param begin Start of the search
+   * @param limit End of the sync header positions
+   * @return const uint8_t* sync headers of the frame, nullptr if none
+   */
+  const uint8_t *findValidFrame(const uint8_t *begin, const uint8_t *limit);
+
+
+  /**
+   * @brief Replays a page recorded by a worker on this solver
+   * 
+   * @param page Recorded page
+   */
+  void replayPage(const DecodedPage &page);
+
+
+  /**
+   * @brief Rebuilds the words 1 to 4 of a satellite that were lost, once
+   *        its FEC2 store holds enough words, and adds them to its
+   *        navigation data
+   * 
+   * @param svId Satellite ID
+   * @param sigId Signal ID of the page that completed the store
+   */
+  void recoverWords(uint8_t svId, uint8_t sigId);
+
+
+  /**
+   * @brief Adds the counters of a worker solver to this solver
+   * 
+   * @param other Worker solver
+   */
+  void mergeCounters(const GalileoSolver &other);
+
+
+  /**
+   * @brief Opens the input according to the input mode
+   * 
+   * @return true when the input is ready
+   * @return false when the file cannot be opened or mapped
+   */
+  bool openInput();
+
+
+  /**
+   * @brief Maps the whole file read-only into memory
+   * 
+   * @return true when the file is mapped
+   * @return false when the file cannot be opened or mapped
+   */
+  bool mapFile();
+
+
+  /**
+   * @brief Unmaps the file mapped by mapFile
    * 
    */
-  void read();
+  void unmapFile();
 
 
   /**
-   * @brief Checks the sync header bytes and controls lock flags
+   * @brief Makes sure size bytes are available after the cursor.
+   *        Refills the chunk buffer when the input is not mapped
+   * 
+   * @param size byte count
+   * @return true when the bytes are available
+   * @return false when the input ends before
+   */
+  bool fetch(size_t size);
+
+
+  /**
+   * @brief Makes sure size bytes are available after the cursor, like
+   *        fetch, but a live input is only read for the bytes that have
+   *        already arrived
+   * 
+   * @param size byte count
+   * @return true when the bytes are available
+   * @return false when the input ends before or they have not arrived yet
+   */
+  bool fetchAvailable(size_t size);
+
+
+  /**
+   * @brief Copies bytes from the input window and moves the cursor
+   * 
+   * @param dst destination
+   * @param size byte count
+   * @return true when all the bytes are read
+   * @return false when the input ends before size bytes
+   */
+  bool readBytes(void *dst, size_t size);
+
+
+  /**
+   * @brief Checks the sync header bytes and controls lock flags.
+   *        Per-byte reference of findSyncHeaders, read() no longer
+   *        calls it
    * 
    * @param byte_ Current byte
    */
@@ -876,22 +1403,46 @@ public:
 
 
   /**
-   * @brief Checksum algorithm for UBX messages
+   * @brief Frames one UBX message right after the sync headers. The
+   *        frame length is used to jump over the whole message, so
+   *        sync hunting restarts only after a checksum or length failure.
+   *        Unhandled messages are checksummed lazily, only when the
+   *        jump does not land on the sync headers of the next message
+   * 
+   */
+  void parseFrame();
+
+
+  /**
+   * @brief Checksum algorithm for UBX messages. Computed in place
+   *        over the buffered or mapped frame at the cursor
    * 
-   * @param raw_data_ input stream object
    * @return true when the checksum protection is correct
    * @return false when the checksum protection is wrong
    */
-  bool checkSum(std::ifstream &raw_data_);
+  bool checkSum();
 
 
   /**
-   * @brief Controls the message class and message id to lock
-   *        UBX_RXM_SFRBX messages
+   * @brief Loads the SFRBX payload head and the first 8 data words while
+   *        computing the checksum in the same forward pass. The decoder
+   *        then works on the loaded words instead of reading the frame
+   *        a second time
    * 
-   * @param raw_data_ input stream object
+   * @return true when the checksum protection is correct
+   * @return false when the checksum protection is wrong
    */
-  void parseInitialData(std::ifstream &raw_data_);
+  bool loadSfrbx();
+
+
+  /**
+   * @brief Reads the message class, message id and length at the
+   *        cursor and determines the message type
+   * 
+   * @return true when the header is available
+   * @return false when the input ends before the header
+   */
+  bool parseInitialData();
 
 
   /**
@@ -900,50 +1451,31 @@ public:
    *        the 8 words (each word is 32 bit - 4 byte)
    *        to get the actual navigation data
    * 
-   * @param raw_data_ input stream object
    * @return true when the data is valid
    * @return false when the data is not valid
    */
-  bool parsePayloadData(std::ifstream &raw_data_);
+  bool parsePayloadData();
 
 
   /**
    * @brief Reads and solves the actual navigation data
-   *        through data words. 
+   *        through data words. The fields of each word type are
+   *        extracted at the positions of their descriptors
+   *        in inav_fields.h
    * 
-   * @param raw_data_ input stream
-   * @param dword first data word
-   * @param svId satellite id
+   * @param page reassembled page
    * @return true true when the data is valid
    * @return false when the data is not valid
    */
-  bool parseDataWord(std::ifstream &raw_data_, uint32_t dword);
+  bool parseDataWord(const InavPage &page);
 
 
   /**
-   * @brief Gets the data word
+   * @brief Adds the decoded word to the navigation data of its satellite,
+   *        or records it as a page on worker solvers
    * 
-   * @return uint32_t one 32 bit data word
    */
-  uint32_t getDataWord();
-
-
-  /**
-   * @brief Masks and shapes the tail and even/odd parts
-   *        of the 4th and 5th data words
-   * 
-   * @param dword_util 
-   */
-  void maskWordUtilMiddle(uint64_t& dword_util);
-
-
-  /**
-   * @brief Masks and shapes the data part
-   *        of the 4th and 5th data words
-   * 
-   * @param dword_data 
-   */
-  void maskWordDataMiddle(uint64_t& dword_data);
+  void addWord();
 
 
   /**
@@ -979,18 +1511,6 @@ public:
   void classifySvid();
 
 
-  /**
-   * @brief Reads n number of bits in a data word.
-   *        Defined in this header file
-   * 
-   * @tparam T 
-   * @param x data word
-   * @param n bit number
-   * @return T data
-   */
-  template <typename T> T getBits(T x, int n);
-
-
   /**
    * @brief Concatenate split bits for the nav data that is 
    *        seperated between data words.
@@ -1011,6 +1531,19 @@ public:
    */
   void log() const;
 
+
+  // Counters for summaries of several files
+  unsigned int sfrbxCount() const { return rxm_sfrbx_counter; }
+  unsigned int navSigCount() const { return nav_sig_counter; }
+  unsigned int pageCount() const { return true_counter; }
+  unsigned int resyncCount() const { return resync_counter; }
+  unsigned int crcFailCount() const { return crc_counter; }
+  unsigned int fec2RecoveredCount() const { return fec2_counter; }
+
+  const OrbitStore &orbits() const { return context_.orbits; }
+  const AlmanacStore &almanacs() const { return context_.almanacs; }
+  const GstClock &clock() const { return context_.clock; }
+
   /**
    * @brief Send warning message to console
    * 
@@ -1019,13 +1552,21 @@ public:
 };
 
 
-template <typename T> 
-T GalileoSolver::getBits(T x, int n) 
+inline bool GalileoSolver::fetch(size_t size)
+{
+  if (static_cast<size_t>(end_ - cursor_) >= size)
+    return true;
+
+  return buffer_.refill(cursor_, end_, size); // Fails at once without a source, like in MMAP mode
+}
+
+
+inline bool GalileoSolver::fetchAvailable(size_t size)
 {
-  T res = (x << pos_) & (~0 << ((sizeof(x) * 8) - n));
-  res = (res >> ((sizeof(x) * 8) - n));
-  pos_ = (pos_ + n) % bitsize_;
-  return res;
+  if (static_cast<size_t>(end_ - cursor_) >= size)
+    return true;
+
+  return buffer_.refill(cursor_, end_, size, !live_);
 }
 
 
@@ -1044,12 +1585,13 @@ inline void NavigationData::add(T word, uint8_t svId, uint8_t sigId) {}
 template <> 
 inline void NavigationData::add<GalileoSolver::WordType1>(GalileoSolver::WordType1 word, uint8_t svId, uint8_t sigId) 
 {
-  svId_ = svId;
-  issue_of_data_ = word.issue_of_data;
-  ref_time_ = word.reference_time * 60; // scale factor 60
-  mean_anomaly_ = word.mean_anomaly * pow(2, -31) * M_PI; // scale factor  2e-31
-  eccentricity_ = word.eccentricity * pow(2, -33); // scale factor 2e-33
-  semi_major_root_ = word.root_semi_major_axis * pow(2, -19); // scale factor 2e-19
+  Staging &slot = stage(word.issue_of_data);
+  slot.svId = svId;
+  slot.ref_time = scaleField<InavWord1::reference_time>(word.reference_time);
+  slot.mean_anomaly = scaleField<InavWord1::mean_anomaly>(word.mean_anomaly);
+  slot.eccentricity = scaleField<InavWord1::eccentricity>(word.eccentricity);
+  slot.semi_major_root = scaleField<InavWord1::root_semi_major_axis>(word.root_semi_major_axis);
+  arrive(slot, 1);
 
   this->checkFull();
 }
@@ -1058,11 +1600,12 @@ inline void NavigationData::add<GalileoSolver::WordType1>(GalileoSolver::WordTyp
 template <> 
 inline void NavigationData::add<GalileoSolver::WordType2>(GalileoSolver::WordType2 word, uint8_t svId, uint8_t sigId) 
 {
-  issue_of_data_ = word.issue_of_data; 
-  omega0_ = word.longitude * pow(2, -31) * M_PI; // scale factor 2e-31 
-  inclination_angle_ = word.inclination_angle * pow(2, -31) * M_PI; // scale factor 2e-31
-  omega_ = word.perigee * pow(2, -31) * M_PI; // scale factor 2e-31 
-  roc_inclination_angle_ = word.ia_rate_of_change * pow(2, -43) * M_PI; // scale factor 2e-43 
+  Staging &slot = stage(word.issue_of_data);
+  slot.omega0 = scaleField<InavWord2::longitude>(word.longitude);
+  slot.inclination_angle = scaleField<InavWord2::inclination_angle>(word.inclination_angle);
+  slot.omega = scaleField<InavWord2::perigee>(word.perigee);
+  slot.roc_inclination_angle = scaleField<InavWord2::ia_rate_of_change>(word.ia_rate_of_change);
+  arrive(slot, 2);
 
   this->checkFull();
 }
@@ -1071,18 +1614,20 @@ inline void NavigationData::add<GalileoSolver::WordType2>(GalileoSolver::WordTyp
 template <> 
 inline void NavigationData::add<GalileoSolver::WordType3>(GalileoSolver::WordType3 word, uint8_t svId, uint8_t sigId) 
 {
-  issue_of_data_ = word.issue_of_data; 
-  omega_dot_ = word.ra_rate_of_change * pow(2, -43) * M_PI; // scale factor 2e-43
-  delta_n_ = word.mean_motion_difference * pow(2, -43) * M_PI; // scale factor 2e-43 
-  cuc_ = word.C_uc * pow(2, -29); // scale factor 2e-29 
-  cus_ = word.C_us * pow(2, -29); // scale factor 2e-29 
-  crc_ = word.C_rc * pow(2, -5); // scale factor 2e-5 
-  crs_ = word.C_rs * pow(2, -5); // scale factor 2e-5 
-
-  if (word.sisa > 0 && word.sisa <= 50) sisa_ = word.sisa * 0.01;
-  else if (word.sisa > 50 && word.sisa <= 75) sisa_ = 0.5 + ((word.sisa - 50) * 0.02);
-  else if (word.sisa > 75 && word.sisa <= 100) sisa_ = 1 + ((word.sisa - 75) * 0.04);
-  else if (word.sisa > 100 && word.sisa <= 125) sisa_ = 2 + ((word.sisa - 100) * 0.16);
+  Staging &slot = stage(word.issue_of_data);
+  slot.omega_dot = scaleField<InavWord3::ra_rate_of_change>(word.ra_rate_of_change);
+  slot.delta_n = scaleField<InavWord3::mean_motion_difference>(word.mean_motion_difference);
+  slot.cuc = scaleField<InavWord3::C_uc>(word.C_uc);
+  slot.cus = scaleField<InavWord3::C_us>(word.C_us);
+  slot.crc = scaleField<InavWord3::C_rc>(word.C_rc);
+  slot.crs = scaleField<InavWord3::C_rs>(word.C_rs);
+
+  if (word.sisa > 0 && word.sisa <= 50) slot.sisa = word.sisa * 0.01;
+  else if (word.sisa > 50 && word.sisa <= 75) slot.sisa = 0.5 + ((word.sisa - 50) * 0.02);
+  else if (word.sisa > 75 && word.sisa <= 100) slot.sisa = 1 + ((word.sisa - 75) * 0.04);
+  else if (word.sisa > 100 && word.sisa <= 125) slot.sisa = 2 + ((word.sisa - 100) * 0.16);
+  else slot.sisa = sisa_; // No accuracy prediction, the ephemeris keeps the last one
+  arrive(slot, 3);
 
   this->checkFull();
 }
@@ -1091,13 +1636,14 @@ inline void NavigationData::add<GalileoSolver::WordType3>(GalileoSolver::WordTyp
 template <> 
 inline void NavigationData::add<GalileoSolver::WordType4>(GalileoSolver::WordType4 word, uint8_t svId, uint8_t sigId) // svid not included
 {
-  issue_of_data_ = word.issue_of_data; 
-  cic_ = word.C_ic * pow(2, -29); // scale factor 2e-29
-  cis_ = word.C_is * pow(2, -29); // scale factor 2e-29
-  epoch_ = word.reference * 60; // scale factor 60
-  clock_bias_ = word.clock_bias_corr * pow(2, -34); // scale factor 2e-34
-  clock_drift_ = word.clock_drift_corr * pow(2, -46); // scale factor 2e-46
-  clock_drift_rate_ = word.clock_drift_rate_corr * pow(2, -59); // scale factor 2e-59
+  Staging &slot = stage(word.issue_of_data);
+  slot.cic = scaleField<InavWord4::C_ic>(word.C_ic);
+  slot.cis = scaleField<InavWord4::C_is>(word.C_is);
+  slot.epoch = scaleField<InavWord4::reference>(word.reference);
+  slot.clock_bias = scaleField<InavWord4::clock_bias_corr>(word.clock_bias_corr);
+  slot.clock_drift = scaleField<InavWord4::clock_drift_corr>(word.clock_drift_corr);
+  slot.clock_drift_rate = scaleField<InavWord4::clock_drift_rate_corr>(word.clock_drift_rate_corr);
+  arrive(slot, 4);
 
   this->checkFull();
 }
@@ -1106,16 +1652,16 @@ inline void NavigationData::add<GalileoSolver::WordType4>(GalileoSolver::WordTyp
 template <> 
 inline void NavigationData::add<GalileoSolver::WordType5>(GalileoSolver::WordType5 word, uint8_t svId, uint8_t sigId) 
 {
-  if (!flag1_) 
+  if (!context_->flag1_) 
   {
-    gal_ai0_ = word.effionl_0 * pow(2, -2);
-    gal_ai1_ = word.effionl_1 * pow(2, -8);
-    gal_ai2_ = word.effionl_2 * pow(2, -15);
-    flag1_ = true;
+    gal_ai0_ = scaleField<InavWord5::effionl_0>(word.effionl_0);
+    gal_ai1_ = scaleField<InavWord5::effionl_1>(word.effionl_1);
+    gal_ai2_ = scaleField<InavWord5::effionl_2>(word.effionl_2);
+    context_->flag1_ = true;
   }
 
-  bgd1_ = word.bgd_1 * pow(2, -32); // scale factor 2e-32
-  bgd2_ = word.bgd_2 * pow(2, -32); // scale factor 2e-32
+  bgd1_ = scaleField<InavWord5::bgd_1>(word.bgd_1);
+  bgd2_ = scaleField<InavWord5::bgd_2>(word.bgd_2);
 
   sig_health_validity_ = word.sig_health_validity;
 
@@ -1128,232 +1674,29 @@ inline void NavigationData::add<GalileoSolver::WordType5>(GalileoSolver::WordTyp
 template <> 
 inline void NavigationData::add<GalileoSolver::WordType6>(GalileoSolver::WordType6 word, uint8_t svId, uint8_t sigId) 
 {
-  if (!flag2_) 
+  if (!context_->flag2_) 
   {
-    gaut_a0_ = word.A0 * pow(2, -30);
-    gaut_a1_ = word.A1 * pow(2, -50);
-    gaut_tow_ = word.utc_reference_tow * 3600;
+    gaut_a0_ = scaleField<InavWord6::A0>(word.A0);
+    gaut_a1_ = scaleField<InavWord6::A1>(word.A1);
+    gaut_tow_ = scaleField<InavWord6::utc_reference_tow>(word.utc_reference_tow);
     gaut_week_ = word.utc_reference_week;
-    flag2_ = true;
+    context_->flag2_ = true;
   }
 
   this->checkFull();
 }
 
 
-/*
-NOT TESTED 
-*/
-template <> 
-inline void NavigationData::add<GalileoSolver::WordType7>(GalileoSolver::WordType7 word, uint8_t svId, uint8_t sigId) 
-{
-  if (word.svid_1 != 0)
-  {
-    if (sigId == 5)
-    {
-      alm_e5_issue_of_data_ = word.issue_of_data;
-      alm_e5_week_num_ = word.week_num;
-      alm_e5_ref_time_ = word.ref_time * 600;
-      alm_e5_svid_ = word.svid_1;
-      alm_e5_delta_root_a_ = word.delta_root_a * pow(2, -9);
-      alm_e5_eccentricity_ = word.eccentricity * pow(2, -16);
-      alm_e5_perigee_ = word.perigee * pow(2, -15) * M_PI;
-      alm_e5_diff_ia_na_ = word.diff_ia_na * pow(2, -14) * M_PI;
-      alm_e5_longitude_ = word.longitude * pow(2, -15) * M_PI;
-      alm_e5_roc_ra_ = word.roc_ra * pow(2, -33) * M_PI;
-      alm_e5_mean_anomaly_ = word.mean_anomaly * pow(2, -15) * M_PI;
-    }
-
-    else if (sigId == 1)
-    {
-      alm_e1_issue_of_data_ = word.issue_of_data;
-      alm_e1_week_num_ = word.week_num;
-      alm_e1_ref_time_ = word.ref_time * 600;
-      alm_e1_svid_ = word.svid_1;
-      alm_e1_delta_root_a_ = word.delta_root_a * pow(2, -9);
-      alm_e1_eccentricity_ = word.eccentricity * pow(2, -16);
-      alm_e1_perigee_ = word.perigee * pow(2, -15) * M_PI;
-      alm_e1_diff_ia_na_ = word.diff_ia_na * pow(2, -14) * M_PI;
-      alm_e1_longitude_ = word.longitude * pow(2, -15) * M_PI;
-      alm_e1_roc_ra_ = word.roc_ra * pow(2, -33) * M_PI;
-      alm_e1_mean_anomaly_ = word.mean_anomaly * pow(2, -15) * M_PI;
-    }
-  }
-}
-
-
-/*
-NOT TESTED 
-*/
-template <> 
-inline void NavigationData::add<GalileoSolver::WordType8>(GalileoSolver::WordType8 word, uint8_t svId, uint8_t sigId)
-{
-  if (sigId == 5)
-  {
-    if (word.issue_of_data == alm_e5_issue_of_data_)
-    {
-      alm_e5_clock_corr_bias_ = word.clock_corr_bias * pow(2, -19);
-      alm_e5_clock_corr_linear_ = word.clock_corr_linear * pow(2, -38);
-      alm_e5_sig_health_e5b_ = word.sig_health_e5b;
-      alm_e5_sig_health_e1_ = word.sig_health_e1;
-
-      writeAlmanac(sigId);
-      resetAlmanacE5();
-    }
-
-    if (word.svid_2 != 0)
-    {
-      alm_e5_issue_of_data_ = word.issue_of_data;
-      alm_e5_svid_ = word.svid_2;
-      alm_e5_delta_root_a_ = word.delta_root_a * pow(2, -9);
-      alm_e5_eccentricity_ = word.eccentricity * pow(2, -16);
-      alm_e5_perigee_ = word.perigee * pow(2, -15) * M_PI;
-      alm_e5_diff_ia_na_ = word.diff_ia_na * pow(2, -14) * M_PI;
-      alm_e5_longitude_ = word.longitude * pow(2, -15) * M_PI;
-      alm_e5_roc_ra_ = word.roc_ra * pow(2, -33) * M_PI;
-    }
-  }
-
-  else if (sigId == 1)
-  {
-    if (word.issue_of_data == alm_e1_issue_of_data_)
-    {
-      alm_e1_clock_corr_bias_ = word.clock_corr_bias * pow(2, -19);
-      alm_e1_clock_corr_linear_ = word.clock_corr_linear * pow(2, -38);
-      alm_e1_sig_health_e5b_ = word.sig_health_e5b;
-      alm_e1_sig_health_e1_ = word.sig_health_e1;
-
-      writeAlmanac(sigId);
-      resetAlmanacE1();
-    }
-
-    if (word.svid_2 != 0)
-    {
-      alm_e1_issue_of_data_ = word.issue_of_data;
-      alm_e1_svid_ = word.svid_2;
-      alm_e1_delta_root_a_ = word.delta_root_a * pow(2, -9);
-      alm_e1_eccentricity_ = word.eccentricity * pow(2, -16);
-      alm_e1_perigee_ = word.perigee * pow(2, -15) * M_PI;
-      alm_e1_diff_ia_na_ = word.diff_ia_na * pow(2, -14) * M_PI;
-      alm_e1_longitude_ = word.longitude * pow(2, -15) * M_PI;
-      alm_e1_roc_ra_ = word.roc_ra * pow(2, -33) * M_PI;
-    }
-  }
-}
-
-
-/*
-NOT TESTED
-*/
-template <> 
-inline void NavigationData::add<GalileoSolver::WordType9>(GalileoSolver::WordType9 word, uint8_t svId, uint8_t sigId)
-{
-  if (sigId == 5)
-  {
-    if (word.issue_of_data == alm_e5_issue_of_data_)
-    {
-      alm_e5_week_num_ = word.week_num;
-      alm_e5_ref_time_ = word.ref_time * 600;
-      alm_e5_mean_anomaly_ = word.mean_anomaly * pow(2, -15) * M_PI;
-      alm_e5_clock_corr_bias_ = word.clock_corr_bias * pow(2, -19);
-      alm_e5_clock_corr_linear_ = word.clock_corr_linear * pow(2, -38);
-      alm_e5_sig_health_e5b_ = word.sig_health_e5b;
-      alm_e5_sig_health_e1_ = word.sig_health_e1;
-
-      writeAlmanac(sigId);
-      resetAlmanacE5();
-    }
-
-    if (word.svid_3 != 0)
-    {
-      alm_e5_issue_of_data_ = word.issue_of_data;
-      alm_e5_week_num_ = word.week_num;
-      alm_e5_ref_time_ = word.ref_time * 600;
-      alm_e5_svid_ = word.svid_3;
-      alm_e5_delta_root_a_ = word.delta_root_a * pow(2, -9);
-      alm_e5_eccentricity_ = word.eccentricity * pow(2, -16);
-      alm_e5_perigee_ = word.perigee * pow(2, -15) * M_PI;
-      alm_e5_diff_ia_na_ = word.diff_ia_na * pow(2, -14) * M_PI;
-    }
-  }
-
-  else if (sigId == 1)
-  {
-    if (word.issue_of_data == alm_e1_issue_of_data_)
-    {
-      alm_e1_week_num_ = word.week_num;
-      alm_e1_ref_time_ = word.ref_time * 600;
-      alm_e1_mean_anomaly_ = word.mean_anomaly * pow(2, -15) * M_PI;
-      alm_e1_clock_corr_bias_ = word.clock_corr_bias * pow(2, -19);
-      alm_e1_clock_corr_linear_ = word.clock_corr_linear * pow(2, -38);
-      alm_e1_sig_health_e5b_ = word.sig_health_e5b;
-      alm_e1_sig_health_e1_ = word.sig_health_e1;
-
-      writeAlmanac(sigId);
-      resetAlmanacE1();
-    }
-
-    if (word.svid_3 != 0)
-    {
-      alm_e1_issue_of_data_ = word.issue_of_data;
-      alm_e1_week_num_ = word.week_num;
-      alm_e1_ref_time_ = word.ref_time * 600;
-      alm_e1_svid_ = word.svid_3;
-      alm_e1_delta_root_a_ = word.delta_root_a * pow(2, -9);
-      alm_e1_eccentricity_ = word.eccentricity * pow(2, -16);
-      alm_e1_perigee_ = word.perigee * pow(2, -15) * M_PI;
-      alm_e1_diff_ia_na_ = word.diff_ia_na * pow(2, -14) * M_PI;
-    }
-  }
-}
-
-/*
-NOT TESTED
-*/
 template <> 
 inline void NavigationData::add<GalileoSolver::WordType10>(GalileoSolver::WordType10 word, uint8_t svId, uint8_t sigId) 
 {
-  if (!flag3_) 
+  if (!context_->flag3_) 
   {
-    gpga_a0g_ = word.const_term_offset * pow(2, -35);
-    gpga_a1g_ = word.roc_offset * pow(2, -51);
-    gpga_tow_ = word.ref_time * 3600;
+    gpga_a0g_ = scaleField<InavWord10::const_term_offset>(word.const_term_offset);
+    gpga_a1g_ = scaleField<InavWord10::roc_offset>(word.roc_offset);
+    gpga_tow_ = scaleField<InavWord10::ref_time>(word.ref_time);
     gpga_week_ = word.week_num;
-    flag3_ = true;
-  }
-
-  if (sigId == 5)
-  {
-    if (word.issue_of_data == alm_e5_issue_of_data_)
-    {
-      alm_e5_longitude_ = word.longitude * pow(2, -15) * M_PI;
-      alm_e5_roc_ra_ = word.roc_ra * pow(2, -33) * M_PI;
-      alm_e5_mean_anomaly_ = word.mean_anomaly * pow(2, -15) * M_PI;
-      alm_e5_clock_corr_bias_ = word.clock_corr_bias * pow(2, -19);
-      alm_e5_clock_corr_linear_ = word.clock_corr_linear * pow(2, -38);
-      alm_e5_sig_health_e5b_ = word.sig_health_e5b;
-      alm_e5_sig_health_e1_ = word.sig_health_e1;
-
-      writeAlmanac(sigId);
-      resetAlmanacE5();
-    }
-  }
-
-  else if (sigId == 1)
-  {
-    if (word.issue_of_data == alm_e1_issue_of_data_)
-    {
-      alm_e1_longitude_ = word.longitude * pow(2, -15) * M_PI;
-      alm_e1_roc_ra_ = word.roc_ra * pow(2, -33) * M_PI;
-      alm_e1_mean_anomaly_ = word.mean_anomaly * pow(2, -15) * M_PI;
-      alm_e1_clock_corr_bias_ = word.clock_corr_bias * pow(2, -19);
-      alm_e1_clock_corr_linear_ = word.clock_corr_linear * pow(2, -38);
-      alm_e1_sig_health_e5b_ = word.sig_health_e5b;
-      alm_e1_sig_health_e1_ = word.sig_health_e1;
-
-      writeAlmanac(sigId);
-      resetAlmanacE1();
-    }
+    context_->flag3_ = true;
   }
 }
 
@@ -0,0 +1,280 @@
+#ifndef GALILEO_GST_CLOCK_H
+#define GALILEO_GST_CLOCK_H
+
+#include "inav_fields.h"
+#include <cstdint>
+#include <iosfwd>
+
+
+/**
+ * @brief Seconds of a week and the GPS week of GST week 0. GST is aligned
+ *        to GPS time and its start epoch is the start of GPS week 1024
+ *
+ */
+constexpr uint32_t GST_WEEK = 604800;
+constexpr uint32_t GST_GPS_WEEK_OFFSET = 1024;
+
+
+/**
+ * @brief Leap second count GST - UTC from a GST time on
+ *
+ * @param gst First GST second of the count
+ * @param count ΔtLS
+ */
+struct LeapSecond
+{
+  uint32_t gst;
+  int count;
+};
+
+
+// Leap seconds since the GST start epoch, used until word 6 is received
+constexpr LeapSecond LEAP_SECONDS[] = {
+  {0, 13},          // 1999-08-22
+  {200793614, 14},  // 2006-01-01
+  {295488015, 15},  // 2009-01-01
+  {405820816, 16},  // 2012-07-01
+  {500428817, 17},  // 2015-07-01
+  {547948818, 18},  // 2017-01-01
+};
+
+
+/**
+ * @brief Returns the leap second count GST - UTC of the table at a time
+ *
+ * @param gst GST seconds
+ * @return int ΔtLS
+ */
+constexpr int leapSeconds(double gst)
+{
+  int count = LEAP_SECONDS[0].count;
+
+  for (const LeapSecond &leap : LEAP_SECONDS)
+    if (gst >= leap.gst)
+      count = leap.count;
+
+  return count;
+}
+
+
+/**
+ * @brief Returns the full week closest to a reference week with the least
+ *        significant bits of a truncated week number
+ *
+ * @param truncated Truncated week number
+ * @param bits Bit count of the truncated week number
+ * @param week Reference week
+ * @return int64_t full week
+ */
+constexpr int64_t nearestWeek(uint32_t truncated, unsigned bits, int64_t week)
+{
+  const int64_t span = int64_t(1) << bits;
+  const int64_t full = week - ((week - truncated) % span + span) % span;
+
+  // The closest week, or the next one when the closest is before week 0
+  return (week - full > span / 2 || full < 0) ? full + span : full;
+}
+
+
+/**
+ * @brief GST-UTC conversion parameters of word type 6
+ *
+ */
+struct UtcParameters
+{
+  double a0 = 0; // [s]
+  double a1 = 0; // [s/s]
+  int ls_count_before = 0;
+  uint32_t ref_time = 0; // t0t [s]
+  uint32_t ref_week = 0; // WN0t, 8 bits
+  uint32_t leap_week = 0; // WNLSF, 8 bits
+  uint32_t leap_day = 0; // DN, 1 (Sunday) to 7
+  int ls_count_after = 0;
+};
+
+
+/**
+ * @brief GST-GPS conversion parameters of word type 10
+ *
+ */
+struct GgtoParameters
+{
+  double a0g = 0; // [s]
+  double a1g = 0; // [s/s]
+  uint32_t ref_time = 0; // t0G [s]
+  uint32_t ref_week = 0; // WN0G, 6 bits
+};
+
+
+/**
+ * @brief Galileo System Time of the received pages and the conversions to
+ *        UTC and GPS time. Each transmitting satellite and signal has its
+ *        own page clock: the time words 0 and 5 set it, word 6 sets its
+ *        time of week, and every page in between advances it by the 2 s of
+ *        a nominal page. The 12 bit week numbers are extended across their
+ *        rollover with the latest time of the receiver. Times are GST
+ *        seconds since the start epoch, 0 while unknown
+ *
+ */
+class GstClock
+{
+public:
+  static constexpr uint32_t UNKNOWN = 0;
+
+private:
+  uint32_t pages_[36][2] = {}; // GST at the start of the last page, E1-B and E5b-I
+  uint32_t latest_ = UNKNOWN;
+
+  UtcParameters utc_;
+  GgtoParameters ggto_;
+  bool has_utc_ = false;
+  bool has_ggto_ = false;
+
+  // Difference GST - UTC at a time
+  double utcOffset(double gst) const;
+
+  // Difference GST - GPS time at a time
+  double gpsOffset(double gst) const;
+
+public:
+  /**
+   * @brief Tags a page with its time and takes the time and conversion
+   *        parameters it carries
+   *
+   * @param page Page in the order of reception
+   * @param svId Transmitting satellite, 1..36, the pages of others are
+   *        ignored
+   * @param sigId Signal of the page, 5 and up for E5b-I
+   * @return uint32_t GST at the start of the page, UNKNOWN until a time
+   *         word of the satellite and signal is received
+   */
+  uint32_t stamp(const InavPage &page, unsigned svId, unsigned sigId);
+
+
+  /**
+   * @brief Returns the full GST of a week number and time of week. The 12
+   *        bit week number is taken in the rollover period of a reference
+   *        time
+   *
+   * @param week_num Week number WN
+   * @param time_of_week Time of week [s]
+   * @param reference GST close to the time, UNKNOWN for the first period
+   * @return uint32_t GST
+   */
+  static uint32_t fromWeek(uint32_t week_num, uint32_t time_of_week, uint32_t reference);
+
+
+  /**
+   * @brief Returns the full GST of a time of week, in the week of a
+   *        reference time or the next one when the time of week wrapped
+   *
+   * @param reference GST close to the time, not UNKNOWN
+   * @param time_of_week Time of week [s]
+   * @return uint32_t GST
+   */
+  static uint32_t fromTimeOfWeek(uint32_t reference, uint32_t time_of_week);
+
+
+  /**
+   * @brief Returns the GST at the start of the last page of a satellite
+   *
+   * @param svId Transmitting satellite, 1..36
+   * @param sigId Signal ID
+   * @return uint32_t GST, UNKNOWN if none
+   */
+  uint32_t pageTime(unsigned svId, unsigned sigId) const
+  {
+    return (svId >= 1 && svId <= 36) ? pages_[svId - 1][sigId >= 5] : UNKNOWN;
+  }
+
+
+  /**
+   * @brief Returns the latest GST of all pages
+   *
+   * @return uint32_t GST, UNKNOWN if none
+   */
+  uint32_t now() const { return latest_; }
+
+
+  /**
+   * @brief Returns whether the broadcast GST-UTC parameters are known.
+   *        The leap second table stands in for them until then
+   *
+   */
+  bool hasUtc() const { return has_utc_; }
+
+
+  /**
+   * @brief Returns whether the broadcast GGTO is known. GPS time is taken
+   *        as GST until then
+   *
+   */
+  bool hasGgto() const { return has_ggto_; }
+
+
+  /**
+   * @brief Converts GST into UTC. The leap second itself, 23:59:60, is not
+   *        told apart from the next second
+   *
+   * @param gst GST seconds
+   * @return double UTC in seconds since the GST start epoch
+   */
+  double toUtc(double gst) const;
+
+
+  /**
+   * @brief Converts UTC into GST
+   *
+   * @param utc UTC in seconds since the GST start epoch
+   * @return double GST seconds
+   */
+  double fromUtc(double utc) const;
+
+
+  /**
+   * @brief Converts GST into GPS time
+   *
+   * @param gst GST seconds
+   * @return double GPS time in seconds since the GPS start epoch
+   */
+  double toGps(double gst) const;
+
+
+  /**
+   * @brief Converts GPS time into GST
+   *
+   * @param gps GPS time in seconds since the GPS start epoch
+   * @return double GST seconds
+   */
+  double fromGps(double gps) const;
+
+
+  /**
+   * @brief Forgets the page times and the conversion parameters
+   *
+   */
+  void clear();
+
+
+  /**
+   * @brief Writes the page times and the conversion parameters into a
+   *        checkpoint. The object is written byte by byte, so only the
+   *        same build reads it back
+   *
+   * @param out Checkpoint stream
+   */
+  void save(std::ostream &out) const;
+
+
+  /**
+   * @brief Reads a clock written by save
+   *
+   * @param in Checkpoint stream
+   * @return true when the clock is read
+   * @return false when the stream ends before
+   */
+  bool load(std::istream &in);
+};
+
+
+#endif // GALILEO_GST_CLOCK_H
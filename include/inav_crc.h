@@ -0,0 +1,81 @@
+#ifndef GALILEO_INAV_CRC_H
+#define GALILEO_INAV_CRC_H
+
+#include <cstdint>
+#include <cstddef>
+
+
+/**
+ * @brief Kernels of the I/NAV CRC-24Q. The table kernel reads eight bytes
+ *        per step, the carry-less multiply kernel folds 64 bits per step.
+ *        The best one the CPU supports is selected at runtime
+ *
+ */
+enum CrcKernel { TABLE_CRC, CLMUL_CRC };
+
+
+/**
+ * @brief CRC-24Q of a byte string, polynomial 0x1864cfb, most
+ *        significant bit first, zero initial value
+ *
+ * @param data First byte
+ * @param size Byte count
+ * @return uint32_t CRC in the low 24 bits
+ */
+uint32_t crc24q(const uint8_t *data, size_t size);
+
+
+/**
+ * @brief CRC-24Q of a nominal I/NAV page as received in the 8 data words
+ *        of an UBX-RXM-SFRBX frame. It covers the 114 bits of the even
+ *        half in front of its tail and the 82 bits of the odd half in
+ *        front of the CRC
+ *
+ * @param words Data words of the frame, even half in 0..3, odd in 4..7
+ * @return uint32_t CRC in the low 24 bits
+ */
+uint32_t inavCrc(const uint32_t *words);
+
+
+/**
+ * @brief Same as inavCrc with a fixed kernel. A kernel the CPU does not
+ *        support falls back to the best supported one
+ *
+ */
+uint32_t inavCrc(CrcKernel kernel, const uint32_t *words);
+
+
+/**
+ * @brief Returns the CRC transmitted in the odd half of the page
+ *
+ * @param words Data words of the frame
+ * @return uint32_t CRC in the low 24 bits
+ */
+inline uint32_t transmittedInavCrc(const uint32_t *words)
+{
+  return (words[6] & 0x3fff) << 10 | words[7] >> 22;
+}
+
+
+/**
+ * @brief Checks the CRC of a nominal I/NAV page
+ *
+ * @param words Data words of the frame
+ * @return true when the computed CRC matches the transmitted one
+ * @return false when the page is corrupt
+ */
+inline bool checkInavCrc(const uint32_t *words)
+{
+  return inavCrc(words) == transmittedInavCrc(words);
+}
+
+
+/**
+ * @brief Returns the kernel that inavCrc uses on this CPU
+ *
+ * @return CrcKernel
+ */
+CrcKernel activeCrcKernel();
+
+
+#endif // GALILEO_INAV_CRC_H
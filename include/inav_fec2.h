@@ -0,0 +1,109 @@
+#ifndef GALILEO_INAV_FEC2_H
+#define GALILEO_INAV_FEC2_H
+
+#include "inav_fields.h"
+#include <iosfwd>
+
+
+/**
+ * @brief Reed-Solomon outer code of the I/NAV clock and ephemeris data,
+ *        the words 1 to 4. The 58 information bytes are word type 1 with
+ *        its word type, followed by the words 2 to 4 without word type and
+ *        IODnav. The 60 parity bytes of the code, RS(255, 195) over
+ *        GF(2^8) shortened to 118 bytes, are sent in the words 17 to 20,
+ *        15 in each. Any 4 of the 8 words rebuild the other ones, a
+ *        fifth one confirms them
+ *
+ */
+const unsigned FEC2_INFO_SIZE = 58;
+const unsigned FEC2_PARITY_SIZE = 60;
+const unsigned FEC2_CODE_SIZE = FEC2_INFO_SIZE + FEC2_PARITY_SIZE;
+
+
+/**
+ * @brief Computes the parity bytes of the information bytes
+ *
+ * @param info FEC2_INFO_SIZE bytes
+ * @param parity FEC2_PARITY_SIZE bytes
+ */
+void fec2Encode(const uint8_t *info, uint8_t *parity);
+
+
+/**
+ * @brief Rebuilds the erased bytes of a code word
+ *
+ * @param code Information bytes followed by the parity bytes
+ * @param erased Flag of each byte, the values of erased bytes are ignored
+ * @return true when the erased bytes are rebuilt and the code word is
+ *         consistent
+ * @return false when more than FEC2_PARITY_SIZE bytes are erased or the
+ *         known bytes contradict each other, code is left as it was
+ */
+bool fec2Decode(uint8_t *code, const bool *erased);
+
+
+/**
+ * @brief Collects the words 1 to 4 and 17 to 20 of one satellite and
+ *        rebuilds the missing words 1 to 4 once enough of them are known.
+ *        All words belong to one IODnav, the words 17 to 20 carry its 2
+ *        least significant bits
+ *
+ */
+class Fec2Recovery
+{
+private:
+  uint8_t code_[FEC2_CODE_SIZE] = {};
+  unsigned words_ = 0; // Bits 0..3 for the word types 1..4, bits 4..7 for 17..20
+  int iod_ = -1; // IODnav of the words 1 to 4, -1 while unknown
+  int iod_lsb_ = -1; // IODnav bits of the words 17 to 20, -1 while unknown
+
+public:
+  /**
+   * @brief Adds the word of a page. A word of another IODnav starts over
+   *
+   * @param page Complete page
+   * @return true for the word types of the code
+   * @return false for the others, the page is not added
+   */
+  bool add(const InavPage &page);
+
+
+  /**
+   * @brief Rebuilds the words 1 to 4 that were not added, when at least
+   *        5 of the 8 words were added and agree with each other. A rebuilt
+   *        word counts as added
+   *
+   * @param pages Rebuilt pages, word type n at index n - 1
+   * @return unsigned bit n - 1 set for each rebuilt word type n, 0 if none
+   */
+  unsigned recover(InavPage (&pages)[4]);
+
+
+  /**
+   * @brief Forgets all words
+   *
+   */
+  void clear();
+
+
+  /**
+   * @brief Writes the collected words into a checkpoint. The object is
+   *        written byte by byte, so only the same build reads it back
+   *
+   * @param out Checkpoint stream
+   */
+  void save(std::ostream &out) const;
+
+
+  /**
+   * @brief Reads the words written by save
+   *
+   * @param in Checkpoint stream
+   * @return true when the words are read
+   * @return false when the stream ends before
+   */
+  bool load(std::istream &in);
+};
+
+
+#endif // GALILEO_INAV_FEC2_H
@@ -0,0 +1,479 @@
+#ifndef GALILEO_INAV_FIELDS_H
+#define GALILEO_INAV_FIELDS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Position, signedness and scale factor of one field of an I/NAV
+ *        nominal word. The offset counts the 122 data bits behind the
+ *        word type, 106 in the even half and 16 in the odd half of the
+ *        page, as listed in the tables of the Galileo OS SIS ICD
+ *
+ */
+struct InavField
+{
+  unsigned offset; // First bit behind the word type
+  unsigned width; // 1..64 bits
+  bool is_signed; // Two's complement
+  double scale; // Value of the least significant bit, 1 for counts and flags
+};
+
+
+// Data bits behind the word type of a nominal page
+constexpr unsigned INAV_DATA_BITS = 122;
+
+
+/**
+ * @brief 2^exponent, exact for every exponent of the I/NAV scale factors
+ *
+ */
+constexpr double pow2(int exponent)
+{
+  return exponent < 0 ? pow2(exponent + 1) / 2 : exponent > 0 ? pow2(exponent - 1) * 2 : 1;
+}
+
+
+/**
+ * @brief Checks that the fields of a word follow each other without gaps
+ *        or overlaps and fill its data bits
+ *
+ */
+template <size_t N>
+constexpr bool tilesWord(const InavField (&fields)[N])
+{
+  unsigned next = 0;
+
+  for (size_t i = 0; i < N; i++)
+  {
+    if (fields[i].offset != next || fields[i].width == 0 || fields[i].width > 64)
+      return false;
+
+    next += fields[i].width;
+  }
+
+  return next == INAV_DATA_BITS;
+}
+
+
+/**
+ * @brief Word Type 0: Spare word, carries GST when time is 2
+ *
+ */
+struct InavWord0
+{
+  static constexpr InavField time = {0, 2, false, 1};
+  static constexpr InavField spare = {2, 64, false, 1};
+  static constexpr InavField spare2 = {66, 24, false, 1};
+  static constexpr InavField week_num = {90, 12, false, 1};
+  static constexpr InavField time_of_week = {102, 20, false, 1};
+
+  static constexpr InavField fields[] = {time, spare, spare2, week_num, time_of_week};
+};
+
+
+/**
+ * @brief Word Type 1: Ephemeris (1/4)
+ *
+ */
+struct InavWord1
+{
+  static constexpr InavField issue_of_data = {0, 10, false, 1};
+  static constexpr InavField reference_time = {10, 14, false, 60};
+  static constexpr InavField mean_anomaly = {24, 32, true, pow2(-31) * M_PI};
+  static constexpr InavField eccentricity = {56, 32, false, pow2(-33)};
+  static constexpr InavField root_semi_major_axis = {88, 32, false, pow2(-19)};
+  static constexpr InavField reserved = {120, 2, false, 1};
+
+  static constexpr InavField fields[] = {issue_of_data, reference_time, mean_anomaly, eccentricity,
+                                         root_semi_major_axis, reserved};
+};
+
+
+/**
+ * @brief Word Type 2: Ephemeris (2/4)
+ *
+ */
+struct InavWord2
+{
+  static constexpr InavField issue_of_data = {0, 10, false, 1};
+  static constexpr InavField longitude = {10, 32, true, pow2(-31) * M_PI};
+  static constexpr InavField inclination_angle = {42, 32, true, pow2(-31) * M_PI};
+  static constexpr InavField perigee = {74, 32, true, pow2(-31) * M_PI};
+  static constexpr InavField ia_rate_of_change = {106, 14, true, pow2(-43) * M_PI};
+  static constexpr InavField reserved = {120, 2, false, 1};
+
+  static constexpr InavField fields[] = {issue_of_data, longitude, inclination_angle, perigee,
+                                         ia_rate_of_change, reserved};
+};
+
+
+/**
+ * @brief Word Type 3: Ephemeris (3/4) and SISA
+ *
+ */
+struct InavWord3
+{
+  static constexpr InavField issue_of_data = {0, 10, false, 1};
+  static constexpr InavField ra_rate_of_change = {10, 24, true, pow2(-43) * M_PI};
+  static constexpr InavField mean_motion_difference = {34, 16, true, pow2(-43) * M_PI};
+  static constexpr InavField C_uc = {50, 16, true, pow2(-29)};
+  static constexpr InavField C_us = {66, 16, true, pow2(-29)};
+  static constexpr InavField C_rc = {82, 16, true, pow2(-5)};
+  static constexpr InavField C_rs = {98, 16, true, pow2(-5)};
+  static constexpr InavField sisa = {114, 8, false, 1};
+
+  static constexpr InavField fields[] = {issue_of_data, ra_rate_of_change, mean_motion_difference, C_uc,
+                                         C_us, C_rc, C_rs, sisa};
+};
+
+
+/**
+ * @brief Word Type 4: SVID, Ephemeris (4/4) and Clock correction parameters
+ *
+ */
+struct InavWord4
+{
+  static constexpr InavField issue_of_data = {0, 10, false, 1};
+  static constexpr InavField svid = {10, 6, false, 1};
+  static constexpr InavField C_ic = {16, 16, true, pow2(-29)};
+  static constexpr InavField C_is = {32, 16, true, pow2(-29)};
+  static constexpr InavField reference = {48, 14, false, 60};
+  static constexpr InavField clock_bias_corr = {62, 31, true, pow2(-34)};
+  static constexpr InavField clock_drift_corr = {93, 21, true, pow2(-46)};
+  static constexpr InavField clock_drift_rate_corr = {114, 6, true, pow2(-59)};
+  static constexpr InavField spare = {120, 2, false, 1};
+
+  static constexpr InavField fields[] = {issue_of_data, svid, C_ic, C_is, reference, clock_bias_corr,
+                                         clock_drift_corr, clock_drift_rate_corr, spare};
+};
+
+
+/**
+ * @brief Word Type 5: Ionospheric correction, BGD, signal health and
+ *        data validity status and GST
+ *
+ */
+struct InavWord5
+{
+  static constexpr InavField effionl_0 = {0, 11, false, pow2(-2)};
+  static constexpr InavField effionl_1 = {11, 11, true, pow2(-8)};
+  static constexpr InavField effionl_2 = {22, 14, true, pow2(-15)};
+  static constexpr InavField region1 = {36, 1, false, 1};
+  static constexpr InavField region2 = {37, 1, false, 1};
+  static constexpr InavField region3 = {38, 1, false, 1};
+  static constexpr InavField region4 = {39, 1, false, 1};
+  static constexpr InavField region5 = {40, 1, false, 1};
+  static constexpr InavField bgd_1 = {41, 10, true, pow2(-32)};
+  static constexpr InavField bgd_2 = {51, 10, true, pow2(-32)};
+  static constexpr InavField sig_health_e5b = {61, 2, false, 1};
+  static constexpr InavField sig_health_e1 = {63, 2, false, 1};
+  static constexpr InavField data_validity_e5b = {65, 1, false, 1};
+  static constexpr InavField data_validity_e1 = {66, 1, false, 1};
+  static constexpr InavField week_num = {67, 12, false, 1};
+  static constexpr InavField time_of_week = {79, 20, false, 1};
+  static constexpr InavField spare = {99, 23, false, 1};
+
+  static constexpr InavField fields[] = {effionl_0, effionl_1, effionl_2, region1, region2, region3, region4,
+                                         region5, bgd_1, bgd_2, sig_health_e5b, sig_health_e1,
+                                         data_validity_e5b, data_validity_e1, week_num, time_of_week, spare};
+};
+
+
+/**
+ * @brief Word Type 6: GST-UTC conversion parameters
+ *
+ */
+struct InavWord6
+{
+  static constexpr InavField A0 = {0, 32, true, pow2(-30)};
+  static constexpr InavField A1 = {32, 24, true, pow2(-50)};
+  static constexpr InavField ls_count_before = {56, 8, true, 1};
+  static constexpr InavField utc_reference_tow = {64, 8, false, 3600};
+  static constexpr InavField utc_reference_week = {72, 8, false, 1};
+  static constexpr InavField WN_lsf = {80, 8, false, 1};
+  static constexpr InavField day_num = {88, 3, false, 1};
+  static constexpr InavField ls_count_after = {91, 8, true, 1};
+  static constexpr InavField time_of_week = {99, 20, false, 1};
+  static constexpr InavField spare = {119, 3, false, 1};
+
+  static constexpr InavField fields[] = {A0, A1, ls_count_before, utc_reference_tow, utc_reference_week,
+                                         WN_lsf, day_num, ls_count_after, time_of_week, spare};
+};
+
+
+/**
+ * @brief Word Type 7: Almanac for SVID1 (1/2), almanac reference time
+ *        and almanac reference week number
+ *
+ */
+struct InavWord7
+{
+  static constexpr InavField issue_of_data = {0, 4, false, 1};
+  static constexpr InavField week_num = {4, 2, false, 1};
+  static constexpr InavField ref_time = {6, 10, false, 600};
+  static constexpr InavField svid_1 = {16, 6, false, 1};
+  static constexpr InavField delta_root_a = {22, 13, true, pow2(-9)};
+  static constexpr InavField eccentricity = {35, 11, false, pow2(-16)};
+  static constexpr InavField perigee = {46, 16, true, pow2(-15) * M_PI};
+  static constexpr InavField diff_ia_na = {62, 11, true, pow2(-14) * M_PI};
+  static constexpr InavField longitude = {73, 16, true, pow2(-15) * M_PI};
+  static constexpr InavField roc_ra = {89, 11, true, pow2(-33) * M_PI};
+  static constexpr InavField mean_anomaly = {100, 16, true, pow2(-15) * M_PI};
+  static constexpr InavField reserved = {116, 6, false, 1};
+
+  static constexpr InavField fields[] = {issue_of_data, week_num, ref_time, svid_1, delta_root_a, eccentricity,
+                                         perigee, diff_ia_na, longitude, roc_ra, mean_anomaly, reserved};
+};
+
+
+/**
+ * @brief Word Type 8: Almanac for SVID1 (2/2) and SVID2 (1/2)
+ *
+ */
+struct InavWord8
+{
+  static constexpr InavField issue_of_data = {0, 4, false, 1};
+  static constexpr InavField clock_corr_bias = {4, 16, true, pow2(-19)};
+  static constexpr InavField clock_corr_linear = {20, 13, true, pow2(-38)};
+  static constexpr InavField sig_health_e5b = {33, 2, false, 1};
+  static constexpr InavField sig_health_e1 = {35, 2, false, 1};
+  static constexpr InavField svid_2 = {37, 6, false, 1};
+  static constexpr InavField delta_root_a = {43, 13, true, pow2(-9)};
+  static constexpr InavField eccentricity = {56, 11, false, pow2(-16)};
+  static constexpr InavField perigee = {67, 16, true, pow2(-15) * M_PI};
+  static constexpr InavField diff_ia_na = {83, 11, true, pow2(-14) * M_PI};
+  static constexpr InavField longitude = {94, 16, true, pow2(-15) * M_PI};
+  static constexpr InavField roc_ra = {110, 11, true, pow2(-33) * M_PI};
+  static constexpr InavField spare = {121, 1, false, 1};
+
+  static constexpr InavField fields[] = {issue_of_data, clock_corr_bias, clock_corr_linear, sig_health_e5b,
+                                         sig_health_e1, svid_2, delta_root_a, eccentricity, perigee,
+                                         diff_ia_na, longitude, roc_ra, spare};
+};
+
+
+/**
+ * @brief Word Type 9: Almanac for SVID2 (2/2) and SVID3 (1/2)
+ *
+ */
+struct InavWord9
+{
+  static constexpr InavField issue_of_data = {0, 4, false, 1};
+  static constexpr InavField week_num = {4, 2, false, 1};
+  static constexpr InavField ref_time = {6, 10, false, 600};
+  static constexpr InavField mean_anomaly = {16, 16, true, pow2(-15) * M_PI};
+  static constexpr InavField clock_corr_bias = {32, 16, true, pow2(-19)};
+  static constexpr InavField clock_corr_linear = {48, 13, true, pow2(-38)};
+  static constexpr InavField sig_health_e5b = {61, 2, false, 1};
+  static constexpr InavField sig_health_e1 = {63, 2, false, 1};
+  static constexpr InavField svid_3 = {65, 6, false, 1};
+  static constexpr InavField delta_root_a = {71, 13, true, pow2(-9)};
+  static constexpr InavField eccentricity = {84, 11, false, pow2(-16)};
+  static constexpr InavField perigee = {95, 16, true, pow2(-15) * M_PI};
+  static constexpr InavField diff_ia_na = {111, 11, true, pow2(-14) * M_PI};
+
+  static constexpr InavField fields[] = {issue_of_data, week_num, ref_time, mean_anomaly, clock_corr_bias,
+                                         clock_corr_linear, sig_health_e5b, sig_health_e1, svid_3,
+                                         delta_root_a, eccentricity, perigee, diff_ia_na};
+};
+
+
+/**
+ * @brief Word Type 10: Almanac for SVID3 (2/2) and GST-GPS conversion
+ *        parameters
+ *
+ */
+struct InavWord10
+{
+  static constexpr InavField issue_of_data = {0, 4, false, 1};
+  static constexpr InavField longitude = {4, 16, true, pow2(-15) * M_PI};
+  static constexpr InavField roc_ra = {20, 11, true, pow2(-33) * M_PI};
+  static constexpr InavField mean_anomaly = {31, 16, true, pow2(-15) * M_PI};
+  static constexpr InavField clock_corr_bias = {47, 16, true, pow2(-19)};
+  static constexpr InavField clock_corr_linear = {63, 13, true, pow2(-38)};
+  static constexpr InavField sig_health_e5b = {76, 2, false, 1};
+  static constexpr InavField sig_health_e1 = {78, 2, false, 1};
+  static constexpr InavField const_term_offset = {80, 16, true, pow2(-35)};
+  static constexpr InavField roc_offset = {96, 12, true, pow2(-51)};
+  static constexpr InavField ref_time = {108, 8, false, 3600};
+  static constexpr InavField week_num = {116, 6, false, 1};
+
+  static constexpr InavField fields[] = {issue_of_data, longitude, roc_ra, mean_anomaly, clock_corr_bias,
+                                         clock_corr_linear, sig_health_e5b, sig_health_e1, const_term_offset,
+                                         roc_offset, ref_time, week_num};
+};
+
+
+/**
+ * @brief Word Type 16: Reduced Clock and Ephemeris Data (CED) parameters
+ *
+ */
+struct InavWord16
+{
+  static constexpr InavField delta_rced_smajor = {0, 5, true, pow2(8)};
+  static constexpr InavField eccentricity_rced_x = {5, 13, true, pow2(-22)};
+  static constexpr InavField eccentricity_rced_y = {18, 13, true, pow2(-22)};
+  static constexpr InavField delta_rced_inclination = {31, 17, true, pow2(-22) * M_PI};
+  static constexpr InavField rced_longitude = {48, 23, true, pow2(-22) * M_PI};
+  static constexpr InavField lambda_rced = {71, 23, true, pow2(-22) * M_PI};
+  static constexpr InavField rced_clock_corr_bias = {94, 22, true, pow2(-26)};
+  static constexpr InavField rced_clock_corr_drift = {116, 6, true, pow2(-35)};
+
+  static constexpr InavField fields[] = {delta_rced_smajor, eccentricity_rced_x, eccentricity_rced_y,
+                                         delta_rced_inclination, rced_longitude, lambda_rced,
+                                         rced_clock_corr_bias, rced_clock_corr_drift};
+};
+
+
+/**
+ * @brief Word Types 17, 18, 19 and 20: FEC2 Reed-Solomon for CED
+ *
+ */
+struct InavWord17
+{
+  static constexpr InavField fec2_1 = {0, 8, false, 1};
+  static constexpr InavField lsb = {8, 2, false, 1};
+  static constexpr InavField fec2_2 = {10, 64, false, 1};
+  static constexpr InavField fec2_3 = {74, 48, false, 1};
+
+  static constexpr InavField fields[] = {fec2_1, lsb, fec2_2, fec2_3};
+};
+
+
+static_assert(tilesWord(InavWord0::fields), "Word Type 0 fields do not fill the word");
+static_assert(tilesWord(InavWord1::fields), "Word Type 1 fields do not fill the word");
+static_assert(tilesWord(InavWord2::fields), "Word Type 2 fields do not fill the word");
+static_assert(tilesWord(InavWord3::fields), "Word Type 3 fields do not fill the word");
+static_assert(tilesWord(InavWord4::fields), "Word Type 4 fields do not fill the word");
+static_assert(tilesWord(InavWord5::fields), "Word Type 5 fields do not fill the word");
+static_assert(tilesWord(InavWord6::fields), "Word Type 6 fields do not fill the word");
+static_assert(tilesWord(InavWord7::fields), "Word Type 7 fields do not fill the word");
+static_assert(tilesWord(InavWord8::fields), "Word Type 8 fields do not fill the word");
+static_assert(tilesWord(InavWord9::fields), "Word Type 9 fields do not fill the word");
+static_assert(tilesWord(InavWord10::fields), "Word Type 10 fields do not fill the word");
+static_assert(tilesWord(InavWord16::fields), "Word Type 16 fields do not fill the word");
+static_assert(tilesWord(InavWord17::fields), "Word Types 17-20 fields do not fill the word");
+
+
+/**
+ * @brief Nominal I/NAV page reassembled once from the 8 data words of an
+ *        SFRBX frame. The word type and the 122 data bits of the even and
+ *        odd halves are one contiguous 128 bit string, read by position
+ *        without a cursor. A value type without side effects, so a page
+ *        stays in registers and pages can be read from several threads
+ *
+ */
+class InavPage
+{
+  uint64_t high_ = 0; // Bits 0..63, the word type first
+  uint64_t low_ = 0; // Bits 64..127
+  uint8_t even_flags_ = 0; // Even/odd and page type bits of the even half
+  uint8_t odd_flags_ = 0; // Even/odd and page type bits of the odd half
+  uint8_t tail_ = 0; // Tail bits of the even half
+
+public:
+  InavPage() = default;
+
+
+  /**
+   * @brief Reassembles the page. Bits 0..29 are bits 29..0 of word 0,
+   *        bits 30..93 fill words 1 and 2, bits 94..111 are bits 31..14
+   *        of word 3 and bits 112..127 are bits 29..14 of word 4
+   *
+   * @param words Data words of the SFRBX frame
+   */
+  explicit InavPage(const uint32_t *words)
+    : high_(uint64_t(words[0] & 0x3fffffff) << 34 | uint64_t(words[1]) << 2 | words[2] >> 30),
+      low_(uint64_t(words[2] & 0x3fffffff) << 34 | uint64_t(words[3] >> 14) << 16 | (words[4] >> 14 & 0xffff)),
+      even_flags_(words[0] >> 30),
+      odd_flags_(words[4] >> 30),
+      tail_(words[3] >> 8 & 0x3f)
+  {
+  }
+
+
+  /**
+   * @brief Nominal page of 128 bits, even half first, with a zero tail
+   *
+   * @param high Bits 0..63, the word type first
+   * @param low Bits 64..127
+   */
+  InavPage(uint64_t high, uint64_t low) : high_(high), low_(low), odd_flags_(2)
+  {
+  }
+
+
+  /**
+   * @brief Reads bits of the page
+   *
+   * @param first First bit, 0 is the first bit of the word type
+   * @param count Bit count, 1..64
+   * @return uint64_t the bits, right aligned
+   */
+  uint64_t bits(unsigned first, unsigned count) const
+  {
+    // 64 bits from first on, left aligned
+    uint64_t window = (first >= 64) ? low_ << (first - 64) : (first == 0) ? high_ : high_ << first | low_ >> (64 - first);
+
+    return window >> (64 - count);
+  }
+
+
+  /**
+   * @brief Reads a field of the word, the shifts are known at compile time
+   *
+   * @tparam F Field descriptor of the word type
+   * @return int64_t sign extended for signed fields, uint64_t otherwise
+   */
+  template <const InavField &F>
+  auto field() const
+  {
+    static_assert(F.width >= 1 && F.width <= 64 && F.offset + F.width <= INAV_DATA_BITS, "Field outside of the word");
+
+    const uint64_t value = bits(6 + F.offset, F.width); // Behind the word type
+
+    if constexpr (F.is_signed)
+      return static_cast<int64_t>(value << (64 - F.width)) >> (64 - F.width);
+    else
+      return value;
+  }
+
+
+  // The 128 bits as two words, bit 0 is the most significant bit of high
+  uint64_t high() const { return high_; }
+  uint64_t low() const { return low_; }
+
+  unsigned evenOdd() const { return even_flags_ >> 1; }
+  unsigned pageType() const { return even_flags_ & 1; }
+  unsigned wordType() const { return high_ >> 58; }
+
+  unsigned oddEvenOdd() const { return odd_flags_ >> 1; }
+  unsigned oddPageType() const { return odd_flags_ & 1; }
+  unsigned tail() const { return tail_; }
+
+  // The tail of the even half is zero and the halves are in the right order
+  bool complete() const { return tail_ == 0 && evenOdd() != oddEvenOdd(); }
+};
+
+
+/**
+ * @brief Scales a raw field to its physical unit with the factor of its
+ *        descriptor, folded into one constant at compile time
+ *
+ * @tparam F Field descriptor
+ * @param raw Raw value as decoded
+ * @return double physical value
+ */
+template <const InavField &F, typename T>
+constexpr double scaleField(T raw)
+{
+  constexpr double scale = F.scale;
+
+  return raw * scale;
+}
+
+
+#endif // GALILEO_INAV_FIELDS_H
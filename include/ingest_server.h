@@ -0,0 +1,160 @@
+#ifndef GALILEO_INGEST_SERVER_H
+#define GALILEO_INGEST_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "galileo_solver.h"
+
+
+/**
+ * @brief Takes UBX streams of many receivers over TCP. Connections are
+ *        spread over a few event loops, each one a thread with its own
+ *        epoll set, so a couple of cores serve all receivers. Every
+ *        connection has its own GalileoSolver, that is its own framing
+ *        state and navigation data, fed with the bytes as they arrive.
+ *        The navigation data and the console log of a connection are
+ *        written into the output directory, named by the receiver
+ *        address and port
+ *
+ */
+class IngestServer
+{
+public:
+  static const int POLL_MS = 500; // Longest wait for events before the stop flag is checked
+  static const size_t READ_SIZE = 64 << 10; // Bytes read from a connection per event
+  static const size_t CHUNK_SIZE = 64 << 10; // Chunk size of the solvers, receivers send a few kB per epoch
+
+private:
+  struct Connection
+  {
+    int fd = -1;
+    std::string name; // address:port of the receiver
+    std::ofstream nav_data_file;
+    std::ofstream console;
+    std::unique_ptr<GalileoSolver> solver;
+  };
+
+  using Connections = std::unordered_map<int, std::unique_ptr<Connection>>;
+
+  const std::string output_dir_;
+  std::ostream &console_;
+  std::mutex console_mutex_; // Loops report connections on the same console
+
+  int listen_fd_ = -1;
+  uint16_t port_ = 0;
+
+  std::atomic<unsigned> open_count_{0};
+  std::atomic<unsigned> accept_count_{0};
+
+public:
+  /**
+   * @brief Constructs a new Ingest Server object
+   *
+   * @param output_dir Directory of the outputs of the connections
+   * @param console Stream of the connect and disconnect messages
+   */
+  explicit IngestServer(const std::string &output_dir, std::ostream &console = std::cout);
+
+
+  /**
+   * @brief Closes the listening socket
+   *
+   */
+  ~IngestServer();
+
+
+  IngestServer(const IngestServer &) = delete;
+  IngestServer &operator=(const IngestServer &) = delete;
+
+
+  /**
+   * @brief Opens the listening socket
+   *
+   * @param port TCP port, 0 takes a free one
+   * @param address IPv4 address to listen on
+   * @return true when the socket listens
+   * @return false when the address is invalid or the port cannot be bound
+   */
+  bool listen(uint16_t port, const std::string &address = "0.0.0.0");
+
+
+  /**
+   * @brief Serves the connections until stop is set. The open connections
+   *        are then ended like closed ones
+   *
+   * @param loops Number of event loops, the calling thread runs one of them
+   * @param stop Stop flag, checked at least every POLL_MS
+   * @return true when the server ran until stop
+   * @return false when it does not listen or the output directory cannot be made
+   */
+  bool run(unsigned loops, const std::atomic<bool> &stop);
+
+
+  uint16_t port() const { return port_; }
+
+  unsigned openCount() const { return open_count_; }
+  unsigned acceptCount() const { return accept_count_; }
+
+
+  /**
+   * @brief Base path of the outputs of a receiver, the ".nav.txt" and
+   *        ".log.txt" files are named after it
+   *
+   * @param output_dir Output directory
+   * @param address IPv4 address of the receiver
+   * @param port TCP port of the receiver
+   * @return std::string path without extension
+   */
+  static std::string outputBase(const std::string &output_dir, const std::string &address, uint16_t port);
+
+private:
+  /**
+   * @brief Event loop of one thread
+   *
+   * @param epoll_fd epoll set of the loop, holding the listening socket
+   * @param stop Stop flag
+   */
+  void loop(int epoll_fd, const std::atomic<bool> &stop);
+
+
+  /**
+   * @brief Accepts the pending connections into the epoll set of a loop.
+   *        Other loops may take some of them first
+   *
+   * @param epoll_fd epoll set of the loop
+   * @param connections Connections of the loop
+   */
+  void accept(int epoll_fd, Connections &connections);
+
+
+  /**
+   * @brief Reads what a connection delivered and feeds it to its solver
+   *
+   * @param connection Readable connection
+   * @param buffer Read buffer of the loop
+   * @return true while the connection is open
+   * @return false when the receiver closed it or it failed
+   */
+  bool receive(Connection &connection, std::vector<uint8_t> &buffer);
+
+
+  /**
+   * @brief Ends the stream of a connection and closes it
+   *
+   * @param connection Connection
+   */
+  void finish(Connection &connection);
+
+
+  void report(const std::string &message);
+};
+
+
+#endif // GALILEO_INGEST_SERVER_H
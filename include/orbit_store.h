@@ -0,0 +1,147 @@
+#ifndef GALILEO_ORBIT_STORE_H
+#define GALILEO_ORBIT_STORE_H
+
+#include "inav_fields.h"
+
+
+/**
+ * @brief Orbit and clock model of one satellite in the form of the full
+ *        broadcast ephemeris. Angles in radians, reference times in GST
+ *        seconds since the start of week 0
+ *
+ */
+struct KeplerOrbit
+{
+  double root_semi_major_axis = 0; // [sqrt(m)]
+  double delta_n = 0; // Mean motion difference [rad/s]
+  double mean_anomaly = 0; // At the reference time
+  double eccentricity = 0;
+  double perigee = 0;
+  double inclination = 0; // At the reference time
+  double inclination_rate = 0; // [rad/s]
+  double longitude = 0; // Of the ascending node at the weekly epoch
+  double longitude_rate = 0; // Of the right ascension [rad/s]
+  double cuc = 0, cus = 0; // Harmonic corrections of the argument of latitude [rad]
+  double crc = 0, crs = 0; // Harmonic corrections of the orbit radius [m]
+  double cic = 0, cis = 0; // Harmonic corrections of the inclination [rad]
+  double toe = 0; // Ephemeris reference time
+  double toc = 0; // Clock reference time
+  double af0 = 0, af1 = 0, af2 = 0; // Clock bias [s], drift [s/s] and drift rate [s/s^2]
+};
+
+
+/**
+ * @brief Position and clock of a satellite at one time
+ *
+ * @param position Earth-centered, Earth-fixed coordinates [m]
+ * @param clock_offset Satellite clock offset from GST, relativistic
+ *        correction included [s]
+ */
+struct SatelliteState
+{
+  double position[3] = {};
+  double clock_offset = 0;
+};
+
+
+/**
+ * @brief Computes the position and clock of a satellite with the user
+ *        algorithm of the broadcast ephemeris
+ *
+ * @param orbit Orbit and clock model
+ * @param gst Time of the state, GST seconds
+ * @return SatelliteState
+ */
+SatelliteState keplerState(const KeplerOrbit &orbit, double gst);
+
+
+/**
+ * @brief Converts the reduced clock and ephemeris data of word type 16 into
+ *        an orbit model. The semi-major axis and inclination are offsets
+ *        from the nominal orbit, the eccentricity vector gives the
+ *        eccentricity and perigee, and the other terms of the model are
+ *        zero
+ *
+ * @param page Page of word type 16
+ * @param t0r Reference time of the reduced data, GST seconds
+ * @return KeplerOrbit
+ */
+KeplerOrbit reducedOrbit(const InavPage &page, double t0r);
+
+
+/**
+ * @brief Orbit models of the constellation. A satellite gets a provisional
+ *        model from the reduced data within seconds of acquisition, and the
+ *        full ephemeris takes over once it is assembled. A model is used
+ *        only within its validity interval around its reference time
+ *
+ */
+class OrbitStore
+{
+public:
+  enum Source { NONE, REDUCED, FULL };
+
+  static constexpr double FULL_VALIDITY = 4 * 3600; // Fit interval of the full ephemeris, each side of toe [s]
+  static constexpr double REDUCED_VALIDITY = 15 * 60; // Use of the reduced data, each side of t0r [s]
+
+private:
+  struct Entry
+  {
+    KeplerOrbit full;
+    KeplerOrbit reduced;
+    bool has_full = false;
+    bool has_reduced = false;
+  };
+
+  Entry entries_[36];
+
+public:
+  /**
+   * @brief Sets the full ephemeris of a satellite
+   *
+   * @param svId Satellite ID, 1..36, others are ignored
+   * @param orbit Orbit model
+   */
+  void setEphemeris(unsigned svId, const KeplerOrbit &orbit);
+
+
+  /**
+   * @brief Sets the provisional model of a satellite from its reduced data
+   *
+   * @param svId Satellite ID, 1..36, others are ignored
+   * @param orbit Orbit model
+   */
+  void setReduced(unsigned svId, const KeplerOrbit &orbit);
+
+
+  /**
+   * @brief Returns the model a satellite state at a time would come from
+   *
+   * @param svId Satellite ID, 1..36
+   * @param gst Time, GST seconds
+   * @return Source FULL when a full ephemeris is valid, otherwise REDUCED
+   *         when the reduced data is, otherwise NONE
+   */
+  Source source(unsigned svId, double gst) const;
+
+
+  /**
+   * @brief Computes the state of a satellite with its best valid model
+   *
+   * @param svId Satellite ID, 1..36
+   * @param gst Time, GST seconds
+   * @param state Set when a model is valid
+   * @return Source model used, NONE if the state is not set
+   */
+  Source state(unsigned svId, double gst, SatelliteState &state) const;
+
+
+  /**
+   * @brief Forgets all models
+   *
+   */
+  void clear();
+};
+
+
+#endif // GALILEO_ORBIT_STORE_H
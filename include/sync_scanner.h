@@ -0,0 +1,48 @@
+#ifndef GALILEO_SYNC_SCANNER_H
+#define GALILEO_SYNC_SCANNER_H
+
+#include <cstdint>
+#include <cstddef>
+
+
+/**
+ * @brief Scanner backends for the UBX sync headers. The best one the
+ *        CPU supports is selected at runtime
+ * 
+ */
+enum SyncScanner { SCALAR_SCANNER, SSE2_SCANNER, AVX2_SCANNER };
+
+
+/**
+ * @brief Finds the next sync header candidate, 0xb5 followed by 0x62.
+ *        A 0xb5 in the last byte is returned too, since its 0x62 may
+ *        arrive with the next chunk of the input
+ * 
+ * @param begin First byte to scan
+ * @param end End of the scanned bytes
+ * @return const uint8_t* the candidate, end when there is none
+ */
+const uint8_t *findSyncHeaders(const uint8_t *begin, const uint8_t *end);
+
+
+/**
+ * @brief Same as findSyncHeaders with a fixed backend. A backend the
+ *        CPU does not support falls back to the best supported one
+ * 
+ * @param scanner Backend
+ * @param begin First byte to scan
+ * @param end End of the scanned bytes
+ * @return const uint8_t* the candidate, end when there is none
+ */
+const uint8_t *findSyncHeaders(SyncScanner scanner, const uint8_t *begin, const uint8_t *end);
+
+
+/**
+ * @brief Returns the backend that findSyncHeaders uses on this CPU
+ * 
+ * @return SyncScanner 
+ */
+SyncScanner activeSyncScanner();
+
+
+#endif // GALILEO_SYNC_SCANNER_H
@@ -0,0 +1,58 @@
+#ifndef GALILEO_UBX_CHECKSUM_H
+#define GALILEO_UBX_CHECKSUM_H
+
+#include <cstdint>
+#include <cstddef>
+
+
+/**
+ * @brief Kernels of the UBX Fletcher-8 checksum. The best one the CPU
+ *        supports is selected at runtime for long payloads
+ * 
+ */
+enum ChecksumKernel { SCALAR_CHECKSUM, SSE2_CHECKSUM, AVX2_CHECKSUM };
+
+
+/**
+ * @brief One Fletcher-8 step of the UBX checksum
+ * 
+ * @param ck_a Running CK_A
+ * @param ck_b Running CK_B
+ * @param byte Next byte
+ */
+inline void checksumStep(uint8_t &ck_a, uint8_t &ck_b, uint8_t byte)
+{
+  ck_a = ck_a + byte;
+  ck_b = ck_b + ck_a;
+}
+
+
+/**
+ * @brief Continues the UBX checksum over size bytes. Long inputs are
+ *        summed in 16 or 32 byte blocks with the vectorized kernels
+ * 
+ * @param ck_a Running CK_A
+ * @param ck_b Running CK_B
+ * @param data First byte
+ * @param size Byte count
+ */
+void updateChecksum(uint8_t &ck_a, uint8_t &ck_b, const uint8_t *data, size_t size);
+
+
+/**
+ * @brief Same as updateChecksum with a fixed kernel. A kernel the CPU
+ *        does not support falls back to the best supported one
+ * 
+ */
+void updateChecksum(ChecksumKernel kernel, uint8_t &ck_a, uint8_t &ck_b, const uint8_t *data, size_t size);
+
+
+/**
+ * @brief Returns the kernel that updateChecksum uses on this CPU
+ * 
+ * @return ChecksumKernel 
+ */
+ChecksumKernel activeChecksumKernel();
+
+
+#endif // GALILEO_UBX_CHECKSUM_H
@@ -0,0 +1,237 @@
+#ifndef GALILEO_UBX_READER_H
+#define GALILEO_UBX_READER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Source of raw capture bytes. Implementations fill the caller's
+ *        buffer with whatever is available, so files, pipes and other
+ *        inputs that cannot be mapped are read the same way
+ * 
+ */
+class ByteSource
+{
+public:
+  virtual ~ByteSource() = default;
+
+
+  /**
+   * @brief Reads up to size bytes into dst
+   * 
+   * @param dst destination
+   * @param size maximum byte count
+   * @return long number of bytes read, 0 at the end of the input
+   *         and negative on error
+   */
+  virtual long read(uint8_t *dst, size_t size) = 0;
+
+
+  /**
+   * @brief Reads only the bytes that are available without waiting.
+   *        Files always have their bytes available
+   * 
+   * @param dst destination
+   * @param size maximum byte count
+   * @return long number of bytes read, 0 when none are available now
+   *         or at the end of the input and negative on error
+   */
+  virtual long readAvailable(uint8_t *dst, size_t size) { return read(dst, size); }
+};
+
+
+
+/**
+ * @brief Reads from a file descriptor with read(2). Path "-" is the
+ *        standard input
+ * 
+ */
+class FileSource : public ByteSource
+{
+private:
+  int fd_ = -1;
+  bool owned_ = false;
+
+public:
+  ~FileSource() override;
+
+
+  /**
+   * @brief Opens the file at path
+   * 
+   * @param path Path to the binary file or "-" for standard input
+   * @return true when the file is opened
+   * @return false when the file cannot be opened
+   */
+  bool open(const std::string &path);
+
+
+  /**
+   * @brief Moves the read position of an opened file
+   * 
+   * @param offset Byte offset from the start of the file
+   * @return true when the position is moved
+   * @return false when the input cannot seek, like a pipe
+   */
+  bool seek(uint64_t offset);
+
+
+  long read(uint8_t *dst, size_t size) override;
+
+  int fd() const { return fd_; }
+};
+
+
+
+/**
+ * @brief Reads live inputs: serial and pseudo terminals, FIFOs, pipes and
+ *        a standard input that is not a file. Reads are non-blocking and
+ *        wait in poll(2), so the parser gets every byte as soon as it
+ *        arrives. A terminal is switched to raw mode. The hangup of a
+ *        terminal ends the input
+ * 
+ */
+class LiveSource : public ByteSource
+{
+private:
+  int fd_ = -1;
+  bool owned_ = false;
+
+
+  /**
+   * @brief Waits up to timeout_ms for the input to be readable and reads it
+   * 
+   * @param dst destination
+   * @param size maximum byte count
+   * @param timeout_ms poll timeout, -1 waits until bytes arrive or the input ends
+   * @return long number of bytes read, 0 at the end of the input or when
+   *         nothing arrived in time and negative on error
+   */
+  long readReady(uint8_t *dst, size_t size, int timeout_ms);
+
+public:
+  ~LiveSource() override;
+
+
+  /**
+   * @brief Checks whether a path is a live input
+   * 
+   * @param path Path to the input or "-" for standard input
+   * @return true for terminals, FIFOs, sockets and a standard input that is not a file
+   * @return false for regular files and missing paths
+   */
+  static bool isLive(const std::string &path);
+
+
+  /**
+   * @brief Opens the input
+   * 
+   * @param path Path to the device or "-" for standard input
+   * @param baud_rate Baud rate set on a serial port, 0 keeps the current one
+   * @return true when the input is opened
+   * @return false when it cannot be opened or the baud rate is not supported
+   */
+  bool open(const std::string &path, unsigned baud_rate = 0);
+
+
+  long read(uint8_t *dst, size_t size) override;
+
+  long readAvailable(uint8_t *dst, size_t size) override;
+};
+
+
+
+/**
+ * @brief Reads bytes handed over by the caller, like the bytes a socket
+ *        delivered. The input ends whenever they are consumed
+ * 
+ */
+class BufferSource : public ByteSource
+{
+private:
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+
+public:
+  /**
+   * @brief Hands over the next bytes, they have to stay valid until read
+   * 
+   * @param data bytes
+   * @param size byte count
+   */
+  void assign(const uint8_t *data, size_t size);
+
+
+  long read(uint8_t *dst, size_t size) override;
+};
+
+
+
+/**
+ * @brief Chunked read buffer between a ByteSource and the parser. The
+ *        buffer is filled in large chunks and reused for the whole input.
+ *        Before every fill the unconsumed bytes are moved to the front,
+ *        so a frame split between two chunks is contiguous again when
+ *        the parser asks for it
+ * 
+ */
+class ChunkBuffer
+{
+public:
+  static const size_t DEFAULT_CHUNK_SIZE = 2 << 20; // 2 MiB
+
+private:
+  std::vector<uint8_t> buffer_;
+  ByteSource *source_ = nullptr;
+  size_t chunk_size_;
+  uint64_t offset_ = 0; // Input offset of the first buffered byte
+
+public:
+  /**
+   * @brief Constructs a new Chunk Buffer object
+   * 
+   * @param chunk_size Byte count requested from the source per read
+   */
+  explicit ChunkBuffer(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+
+  /**
+   * @brief Attaches the buffer to a source, nullptr detaches it
+   * 
+   * @param source 
+   * @param offset Input offset of the next byte the source reads
+   */
+  void attach(ByteSource *source, uint64_t offset = 0);
+
+
+  /**
+   * @brief Input offset of a buffered byte
+   * 
+   * @param p Byte in the buffer, nullptr before the first refill
+   * @return uint64_t offset of the byte from the start of the input
+   */
+  uint64_t offsetOf(const uint8_t *p) const { return (p == nullptr) ? offset_ : offset_ + (p - buffer_.data()); }
+
+
+  /**
+   * @brief Reads from the source until at least size bytes are available
+   *        after cursor. The unconsumed bytes are compacted to the front of
+   *        the buffer first, cursor and end are updated to the new window
+   * 
+   * @param cursor First unconsumed byte, inside the buffer or nullptr
+   * @param end End of the valid bytes
+   * @param size Required byte count
+   * @param wait Whether to wait for bytes that have not arrived yet
+   * @return true when size bytes are available
+   * @return false when the source ends before, or without wait when
+   *         the bytes have not arrived yet
+   */
+  bool refill(const uint8_t *&cursor, const uint8_t *&end, size_t size, bool wait = true);
+};
+
+
+#endif // GALILEO_UBX_READER_H
@@ -0,0 +1,183 @@
+#include "almanac_store.h"
+#include <cmath>
+
+
+namespace
+{
+
+const double WEEK = 604800;
+const double NOMINAL_SEMI_MAJOR_AXIS = 29600000; // [m]
+const double NOMINAL_INCLINATION = 56.0 / 180 * M_PI;
+
+} // namespace
+
+
+void AlmanacStore::start(Pending &pending, unsigned svid, unsigned issue_of_data, unsigned next_word)
+{
+  pending.next_word = (svid >= 1 && svid <= 36) ? next_word : 0;
+  pending.almanac = Almanac();
+  pending.almanac.svid = svid;
+  pending.almanac.issue_of_data = issue_of_data;
+}
+
+
+Almanac *AlmanacStore::finish(Pending &pending, unsigned issue_of_data, unsigned word_type)
+{
+  if (pending.next_word != word_type || pending.almanac.issue_of_data != issue_of_data)
+    return nullptr;
+
+  pending.next_word = 0;
+  return &pending.almanac;
+}
+
+
+const Almanac *AlmanacStore::keep(const Almanac &almanac)
+{
+  almanacs_[almanac.svid - 1] = almanac;
+  valid_[almanac.svid - 1] = true;
+
+  return &almanacs_[almanac.svid - 1];
+}
+
+
+const Almanac *AlmanacStore::add(const InavPage &page, unsigned svId, unsigned sigId)
+{
+  if (svId < 1 || svId > 36 || (sigId != 1 && sigId != 5))
+    return nullptr;
+
+  Pending &pending = pending_[svId - 1][sigId == 5];
+  Almanac *done = nullptr;
+  const Almanac *stored = nullptr;
+
+  switch (page.wordType())
+  {
+  case 7: // SVID1 without its clock and health
+    start(pending, page.field<InavWord7::svid_1>(), page.field<InavWord7::issue_of_data>(), 8);
+    pending.almanac.week_num = page.field<InavWord7::week_num>();
+    pending.almanac.ref_time = scaleField<InavWord7::ref_time>(page.field<InavWord7::ref_time>());
+    pending.almanac.delta_root_a = scaleField<InavWord7::delta_root_a>(page.field<InavWord7::delta_root_a>());
+    pending.almanac.eccentricity = scaleField<InavWord7::eccentricity>(page.field<InavWord7::eccentricity>());
+    pending.almanac.perigee = scaleField<InavWord7::perigee>(page.field<InavWord7::perigee>());
+    pending.almanac.diff_ia_na = scaleField<InavWord7::diff_ia_na>(page.field<InavWord7::diff_ia_na>());
+    pending.almanac.longitude = scaleField<InavWord7::longitude>(page.field<InavWord7::longitude>());
+    pending.almanac.roc_ra = scaleField<InavWord7::roc_ra>(page.field<InavWord7::roc_ra>());
+    pending.almanac.mean_anomaly = scaleField<InavWord7::mean_anomaly>(page.field<InavWord7::mean_anomaly>());
+    return nullptr;
+
+  case 8: // The rest of SVID1, SVID2 without its time, mean anomaly, clock and health
+    if ((done = finish(pending, page.field<InavWord8::issue_of_data>(), 8)) != nullptr)
+    {
+      done->clock_corr_bias = scaleField<InavWord8::clock_corr_bias>(page.field<InavWord8::clock_corr_bias>());
+      done->clock_corr_linear = scaleField<InavWord8::clock_corr_linear>(page.field<InavWord8::clock_corr_linear>());
+      done->sig_health_e5b = page.field<InavWord8::sig_health_e5b>();
+      done->sig_health_e1 = page.field<InavWord8::sig_health_e1>();
+      stored = keep(*done);
+    }
+
+    start(pending, page.field<InavWord8::svid_2>(), page.field<InavWord8::issue_of_data>(), 9);
+    pending.almanac.delta_root_a = scaleField<InavWord8::delta_root_a>(page.field<InavWord8::delta_root_a>());
+    pending.almanac.eccentricity = scaleField<InavWord8::eccentricity>(page.field<InavWord8::eccentricity>());
+    pending.almanac.perigee = scaleField<InavWord8::perigee>(page.field<InavWord8::perigee>());
+    pending.almanac.diff_ia_na = scaleField<InavWord8::diff_ia_na>(page.field<InavWord8::diff_ia_na>());
+    pending.almanac.longitude = scaleField<InavWord8::longitude>(page.field<InavWord8::longitude>());
+    pending.almanac.roc_ra = scaleField<InavWord8::roc_ra>(page.field<InavWord8::roc_ra>());
+    return stored;
+
+  case 9: // The rest of SVID2, SVID3 without its node, mean anomaly, clock and health
+    if ((done = finish(pending, page.field<InavWord9::issue_of_data>(), 9)) != nullptr)
+    {
+      done->week_num = page.field<InavWord9::week_num>();
+      done->ref_time = scaleField<InavWord9::ref_time>(page.field<InavWord9::ref_time>());
+      done->mean_anomaly = scaleField<InavWord9::mean_anomaly>(page.field<InavWord9::mean_anomaly>());
+      done->clock_corr_bias = scaleField<InavWord9::clock_corr_bias>(page.field<InavWord9::clock_corr_bias>());
+      done->clock_corr_linear = scaleField<InavWord9::clock_corr_linear>(page.field<InavWord9::clock_corr_linear>());
+      done->sig_health_e5b = page.field<InavWord9::sig_health_e5b>();
+      done->sig_health_e1 = page.field<InavWord9::sig_health_e1>();
+      stored = keep(*done);
+    }
+
+    start(pending, page.field<InavWord9::svid_3>(), page.field<InavWord9::issue_of_data>(), 10);
+    pending.almanac.week_num = page.field<InavWord9::week_num>();
+    pending.almanac.ref_time = scaleField<InavWord9::ref_time>(page.field<InavWord9::ref_time>());
+    pending.almanac.delta_root_a = scaleField<InavWord9::delta_root_a>(page.field<InavWord9::delta_root_a>());
+    pending.almanac.eccentricity = scaleField<InavWord9::eccentricity>(page.field<InavWord9::eccentricity>());
+    pending.almanac.perigee = scaleField<InavWord9::perigee>(page.field<InavWord9::perigee>());
+    pending.almanac.diff_ia_na = scaleField<InavWord9::diff_ia_na>(page.field<InavWord9::diff_ia_na>());
+    return stored;
+
+  case 10: // The rest of SVID3
+    if ((done = finish(pending, page.field<InavWord10::issue_of_data>(), 10)) != nullptr)
+    {
+      done->longitude = scaleField<InavWord10::longitude>(page.field<InavWord10::longitude>());
+      done->roc_ra = scaleField<InavWord10::roc_ra>(page.field<InavWord10::roc_ra>());
+      done->mean_anomaly = scaleField<InavWord10::mean_anomaly>(page.field<InavWord10::mean_anomaly>());
+      done->clock_corr_bias = scaleField<InavWord10::clock_corr_bias>(page.field<InavWord10::clock_corr_bias>());
+      done->clock_corr_linear = scaleField<InavWord10::clock_corr_linear>(page.field<InavWord10::clock_corr_linear>());
+      done->sig_health_e5b = page.field<InavWord10::sig_health_e5b>();
+      done->sig_health_e1 = page.field<InavWord10::sig_health_e1>();
+      stored = keep(*done);
+    }
+
+    pending.next_word = 0;
+    return stored;
+
+  default:
+    return nullptr;
+  }
+}
+
+
+unsigned AlmanacStore::count() const
+{
+  unsigned count = 0;
+
+  for (bool valid : valid_)
+    count += valid;
+
+  return count;
+}
+
+
+void AlmanacStore::clear()
+{
+  for (auto &signals : pending_)
+    for (Pending &pending : signals)
+      pending = Pending();
+
+  for (int i = 0; i < 36; i++)
+  {
+    almanacs_[i] = Almanac();
+    valid_[i] = false;
+  }
+}
+
+
+KeplerOrbit almanacOrbit(const Almanac &almanac, double gst)
+{
+  // The week with the 2 bits of the almanac whose reference time is closest
+  const double current = std::floor(gst / WEEK);
+  double week = current;
+  double distance = HUGE_VAL;
+
+  for (double candidate = current - 2; candidate <= current + 2; candidate++)
+    if (candidate >= 0 && static_cast<unsigned>(candidate) % 4 == almanac.week_num &&
+        std::fabs(candidate * WEEK + almanac.ref_time - gst) < distance)
+    {
+      week = candidate;
+      distance = std::fabs(candidate * WEEK + almanac.ref_time - gst);
+    }
+
+  KeplerOrbit orbit;
+  orbit.root_semi_major_axis = std::sqrt(NOMINAL_SEMI_MAJOR_AXIS) + almanac.delta_root_a;
+  orbit.eccentricity = almanac.eccentricity;
+  orbit.perigee = almanac.perigee;
+  orbit.inclination = NOMINAL_INCLINATION + almanac.diff_ia_na;
+  orbit.longitude = almanac.longitude;
+  orbit.longitude_rate = almanac.roc_ra;
+  orbit.mean_anomaly = almanac.mean_anomaly;
+  orbit.toe = orbit.toc = week * WEEK + almanac.ref_time;
+  orbit.af0 = almanac.clock_corr_bias;
+  orbit.af1 = almanac.clock_corr_linear;
+
+  return orbit;
+}
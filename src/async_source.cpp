@@ -0,0 +1,350 @@
+#include "async_source.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+const size_t AsyncFileSource::DEFAULT_BLOCK_SIZE;
+const unsigned AsyncFileSource::DEFAULT_DEPTH;
+const size_t AsyncFileSource::DIRECT_ALIGNMENT;
+
+
+/**
+ * @brief Submission and completion queues of an io_uring instance, used
+ *        through the system calls, so no liburing is needed
+ *
+ */
+struct AsyncFileSource::Ring
+{
+  int fd = -1;
+
+  void *sq_map = MAP_FAILED;
+  void *cq_map = MAP_FAILED;
+  size_t sq_map_size = 0;
+  size_t cq_map_size = 0;
+
+  io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+  size_t sqes_size = 0;
+
+  unsigned *sq_tail = nullptr;
+  unsigned *sq_mask = nullptr;
+  unsigned *sq_array = nullptr;
+
+  unsigned *cq_head = nullptr;
+  unsigned *cq_tail = nullptr;
+  unsigned *cq_mask = nullptr;
+  io_uring_cqe *cqes = nullptr;
+
+
+  ~Ring()
+  {
+    if (sqes != MAP_FAILED)
+      munmap(sqes, sqes_size);
+
+    if (cq_map != MAP_FAILED && cq_map != sq_map)
+      munmap(cq_map, cq_map_size);
+
+    if (sq_map != MAP_FAILED)
+      munmap(sq_map, sq_map_size);
+
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+
+  bool setup(unsigned entries)
+  {
+    io_uring_params params{};
+
+    fd = syscall(__NR_io_uring_setup, entries, &params);
+
+    if (fd < 0)
+      return false;
+
+    sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    // Newer kernels map both rings at once
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+      sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+
+    sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+
+    if (sq_map == MAP_FAILED)
+      return false;
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+      cq_map = sq_map;
+    else
+      cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe *>(
+        mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+
+    if (cq_map == MAP_FAILED || sqes == MAP_FAILED)
+      return false;
+
+    uint8_t *sq = static_cast<uint8_t *>(sq_map);
+    uint8_t *cq = static_cast<uint8_t *>(cq_map);
+
+    sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+    cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    return true;
+  }
+
+
+  bool read(int file, uint8_t *dst, size_t size, uint64_t offset, uint64_t user_data)
+  {
+    const unsigned tail = *sq_tail;
+    const unsigned index = tail & *sq_mask;
+
+    io_uring_sqe &sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = file;
+    sqe.addr = reinterpret_cast<uint64_t>(dst);
+    sqe.len = size;
+    sqe.off = offset;
+    sqe.user_data = user_data;
+
+    sq_array[index] = index;
+
+    // The kernel sees the entry before the new tail
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    long submitted;
+
+    do
+      submitted = syscall(__NR_io_uring_enter, fd, 1, 0, 0, nullptr, 0);
+    while (submitted < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY));
+
+    return submitted == 1;
+  }
+
+
+  bool wait(uint64_t &user_data, int &result)
+  {
+    while (true)
+    {
+      const unsigned head = *cq_head;
+
+      if (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+      {
+        const io_uring_cqe &cqe = cqes[head & *cq_mask];
+
+        user_data = cqe.user_data;
+        result = cqe.res;
+
+        __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+        return true;
+      }
+
+      if (syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+        return false;
+    }
+  }
+};
+
+
+AsyncFileSource::AsyncFileSource(size_t block_size, unsigned depth)
+  : block_size_((std::max<size_t>(block_size, 1) + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT),
+    depth_(std::max(depth, 1u))
+{
+}
+
+
+AsyncFileSource::~AsyncFileSource() { close(); }
+
+
+void AsyncFileSource::close()
+{
+  // The kernel may still write into the buffers of the reads in flight
+  for (Block &block : blocks_)
+    if (block.queued)
+      complete(block);
+
+  ring_.reset();
+
+  for (Block &block : blocks_)
+    std::free(block.data);
+
+  blocks_.clear();
+
+  if (fd_ >= 0)
+    ::close(fd_);
+
+  fd_ = -1;
+}
+
+
+bool AsyncFileSource::open(const std::string &path, bool direct)
+{
+  close();
+
+  direct_ = direct;
+  fd_ = ::open(path.c_str(), O_RDONLY | (direct ? O_DIRECT : 0));
+
+  // tmpfs and some other file systems take no direct I/O
+  if (fd_ < 0 && direct && errno == EINVAL)
+  {
+    direct_ = false;
+    fd_ = ::open(path.c_str(), O_RDONLY);
+  }
+
+  struct stat info;
+
+  if (fd_ < 0 || fstat(fd_, &info) != 0)
+  {
+    close();
+    return false;
+  }
+
+  file_size_ = info.st_size;
+  next_offset_ = 0;
+  current_ = 0;
+  position_ = 0;
+
+  if (!direct_)
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  blocks_.resize(depth_);
+
+  for (Block &block : blocks_)
+  {
+    if (posix_memalign(reinterpret_cast<void **>(&block.data), DIRECT_ALIGNMENT, block_size_) != 0)
+    {
+      block.data = nullptr;
+      close();
+      return false;
+    }
+  }
+
+  ring_ = std::make_unique<Ring>();
+
+  if (!ring_->setup(depth_))
+    ring_.reset(); // Read with pread instead
+
+  for (Block &block : blocks_)
+    submit(block);
+
+  return true;
+}
+
+
+void AsyncFileSource::submit(Block &block)
+{
+  block.offset = next_offset_;
+  block.size = (next_offset_ < file_size_) ? std::min<uint64_t>(block_size_, file_size_ - next_offset_) : 0;
+  block.pending = block.size > 0;
+  block.result = 0;
+
+  next_offset_ += block.size;
+
+  // Whole blocks, direct reads need aligned sizes and the last one just ends early.
+  // A block the ring does not take is read with pread
+  block.queued = block.pending && ring_ != nullptr &&
+                 ring_->read(fd_, block.data, block_size_, block.offset, &block - blocks_.data());
+}
+
+
+bool AsyncFileSource::complete(Block &block)
+{
+  while (block.queued)
+  {
+    uint64_t index;
+    int result;
+
+    if (!ring_->wait(index, result))
+      return false;
+
+    if (index < blocks_.size())
+    {
+      blocks_[index].queued = false;
+      blocks_[index].result = result;
+    }
+  }
+
+  block.pending = false;
+
+  // Kernels without IORING_OP_READ reject it, the block is read with pread
+  if (block.result == -EINVAL && !direct_)
+    block.result = 0;
+
+  if (block.result < 0)
+    return false;
+
+  // Also finishes a short read, the blocks behind it are already on their way
+  size_t done = block.result;
+
+  while (done < block.size)
+  {
+    size_t size = block.size - done;
+
+    if (direct_)
+      size = (size + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+
+    ssize_t count = pread(fd_, block.data + done, size, block.offset + done);
+
+    if (count < 0 && errno == EINTR)
+      continue;
+
+    if (count <= 0)
+      return false;
+
+    done += count;
+  }
+
+  return true;
+}
+
+
+long AsyncFileSource::read(uint8_t *dst, size_t size)
+{
+  if (blocks_.empty())
+    return -1;
+
+  while (true)
+  {
+    Block &block = blocks_[current_];
+
+    if (block.pending || position_ == 0)
+    {
+      if (block.size == 0)
+        return 0; // Past the end of the file
+
+      if (block.pending && !complete(block))
+        return -1;
+    }
+
+    if (position_ < block.size)
+    {
+      size_t count = std::min(size, block.size - position_);
+
+      std::memcpy(dst, block.data + position_, count);
+      position_ += count;
+
+      return count;
+    }
+
+    // Used up, the block reads the next one behind the others in flight
+    submit(block);
+    current_ = (current_ + 1) % depth_;
+    position_ = 0;
+  }
+}
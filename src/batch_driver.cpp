@@ -0,0 +1,319 @@
+#include "batch_driver.h"
+#include "ubx_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <glob.h>
+
+namespace fs = std::filesystem;
+
+
+const char *BatchDriver::MANIFEST_NAME = "manifest.txt";
+const char *BatchDriver::SUMMARY_NAME = "summary.txt";
+
+
+namespace
+{
+
+const char *statusName(BatchResult::Status status)
+{
+  switch (status)
+  {
+  case BatchResult::CONVERTED:
+    return "converted";
+
+  case BatchResult::SKIPPED:
+    return "skipped";
+
+  default:
+    return "failed";
+  }
+}
+
+
+// Captures are .ubx files, also compressed ones like .ubx.gz or .ubx.zst
+bool isCapture(const fs::path &path)
+{
+  if (path.extension() == ".ubx")
+    return true;
+
+  return (path.extension() == ".gz" || path.extension() == ".zst") && path.stem().extension() == ".ubx";
+}
+
+
+void formatSummary(std::ostream &out, const std::vector<BatchResult> &results)
+{
+  unsigned int files[3] = {0, 0, 0};
+  uint64_t bytes = 0;
+  uint64_t sfrbx = 0;
+  uint64_t nav_sig = 0;
+  uint64_t pages = 0;
+  uint64_t resync = 0;
+  double seconds = 0;
+
+  out << "Status\tBytes\tSFRBX\tNAV-SIG\tPages\tResync\tSeconds\tHash\tPath\n";
+
+  for (const BatchResult &result : results)
+  {
+    out << statusName(result.status) << "\t" << result.bytes << "\t" << result.sfrbx << "\t" << result.nav_sig
+        << "\t" << result.pages << "\t" << result.resync << "\t" << std::fixed << std::setprecision(3)
+        << result.seconds << "\t" << result.hash << "\t" << result.path << "\n";
+
+    files[result.status]++;
+    bytes += result.bytes;
+    sfrbx += result.sfrbx;
+    nav_sig += result.nav_sig;
+    pages += result.pages;
+    resync += result.resync;
+    seconds += result.seconds;
+  }
+
+  out << "\nFiles: " << results.size()
+      << "\nConverted: " << files[BatchResult::CONVERTED]
+      << "\nSkipped: " << files[BatchResult::SKIPPED]
+      << "\nFailed: " << files[BatchResult::FAILED]
+      << "\nBytes: " << bytes
+      << "\nUBX-RXM-SFRBX: " << sfrbx
+      << "\nUBX-NAV-SIG: " << nav_sig
+      << "\nPages: " << pages
+      << "\nResync: " << resync
+      << "\nSeconds: " << seconds << std::endl;
+}
+
+} // namespace
+
+
+BatchDriver::BatchDriver(const std::string &output_dir, unsigned jobs, GalileoSolver::InputMode mode)
+  : output_dir_(output_dir), jobs_(jobs > 0 ? jobs : 1), mode_(mode) {}
+
+
+bool BatchDriver::addInput(const std::string &input)
+{
+  std::error_code error;
+  size_t count = inputs_.size();
+
+  if (fs::is_directory(input, error))
+  {
+    std::vector<std::string> files;
+
+    for (const fs::directory_entry &entry : fs::recursive_directory_iterator(input, error))
+      if (entry.is_regular_file(error) && isCapture(entry.path()))
+        files.push_back(entry.path().string());
+
+    std::sort(files.begin(), files.end());
+    inputs_.insert(inputs_.end(), files.begin(), files.end());
+  }
+
+  else if (fs::is_regular_file(input, error))
+    inputs_.push_back(input);
+
+  else
+  {
+    glob_t matches;
+
+    if (glob(input.c_str(), 0, nullptr, &matches) == 0)
+    {
+      for (size_t i=0; i<matches.gl_pathc; i++)
+        if (fs::is_regular_file(matches.gl_pathv[i], error))
+          inputs_.push_back(matches.gl_pathv[i]);
+    }
+    globfree(&matches);
+  }
+
+  return inputs_.size() > count;
+}
+
+
+bool BatchDriver::run()
+{
+  std::error_code error;
+  fs::create_directories(output_dir_, error);
+
+  if (!fs::is_directory(output_dir_, error))
+  {
+    std::cout << "Output directory cannot be made: " << output_dir_ << std::endl;
+    return false;
+  }
+
+  loadManifest();
+
+  results_.assign(inputs_.size(), BatchResult());
+
+  for (size_t i=0; i<inputs_.size(); i++)
+    results_[i].path = inputs_[i];
+
+  // Hashed on the pool first and claimed in input order, so of several
+  // copies of a capture always the first one given is converted
+  forEachInput([this](BatchResult &result)
+  {
+    if (!hashFile(result.path, result.hash, result.bytes))
+      result.hash.clear(); // Stays FAILED
+  });
+
+  for (BatchResult &result : results_)
+  {
+    if (result.hash.empty())
+      continue;
+
+    // Skipped when converted by a previous run or given before as a copy,
+    // a failed conversion resets the status
+    result.status = claimed_.insert(result.hash).second ? BatchResult::CONVERTED : BatchResult::SKIPPED;
+  }
+
+  forEachInput([this](BatchResult &result)
+  {
+    if (result.status == BatchResult::CONVERTED)
+      convert(result);
+  });
+
+  // A failed conversion released its hash, the next copy given is converted
+  // instead. Copies follow the input they were skipped for, so one pass
+  // also passes the hash on when a retried copy fails
+  for (BatchResult &result : results_)
+    if (result.status == BatchResult::SKIPPED && claimed_.insert(result.hash).second)
+      convert(result);
+
+  writeSummary();
+
+  return std::none_of(results_.begin(), results_.end(),
+                      [](const BatchResult &result) { return result.status == BatchResult::FAILED; });
+}
+
+
+bool BatchDriver::hashFile(const std::string &path, std::string &hash, uint64_t &bytes)
+{
+  FileSource source;
+
+  if (path == "-" || !source.open(path))
+    return false;
+
+  std::vector<uint8_t> chunk(ChunkBuffer::DEFAULT_CHUNK_SIZE);
+  uint64_t value = 0xcbf29ce484222325ULL; // FNV-1a offset basis
+  long count;
+
+  bytes = 0;
+
+  while ((count = source.read(chunk.data(), chunk.size())) > 0)
+  {
+    for (long i=0; i<count; i++)
+      value = (value ^ chunk[i]) * 0x100000001b3ULL; // FNV-1a prime
+
+    bytes += count;
+  }
+
+  if (count < 0)
+    return false;
+
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << value;
+  hash = hex.str();
+
+  return true;
+}
+
+
+void BatchDriver::loadManifest()
+{
+  std::ifstream manifest(fs::path(output_dir_) / MANIFEST_NAME);
+  std::string line;
+
+  while (std::getline(manifest, line))
+  {
+    std::string hash = line.substr(0, line.find('\t'));
+
+    if (!hash.empty())
+      claimed_.insert(hash);
+  }
+}
+
+
+void BatchDriver::forEachInput(const std::function<void(BatchResult &)> &task)
+{
+  std::atomic<size_t> next(0);
+
+  auto work = [&]()
+  {
+    for (size_t i = next++; i < results_.size(); i = next++)
+      task(results_[i]);
+  };
+
+  std::vector<std::thread> workers;
+
+  for (unsigned i=0; i<std::min<size_t>(jobs_, results_.size()); i++)
+    workers.emplace_back(work);
+
+  for (std::thread &worker : workers)
+    worker.join();
+}
+
+
+void BatchDriver::convert(BatchResult &result)
+{
+  // The hash keeps the outputs of equally named files in different directories apart
+  const std::string base = (fs::path(output_dir_) / fs::path(result.path).filename()).string() + "." + result.hash;
+  const std::string nav_path = base + ".nav.txt";
+  const std::string log_path = base + ".log.txt";
+
+  auto start = std::chrono::steady_clock::now();
+  bool converted = false;
+
+  {
+    // Written under temporary names, an interrupted run leaves no complete looking output
+    std::ofstream nav_data_file(nav_path + ".part");
+    std::ofstream console(log_path + ".part");
+
+    if (nav_data_file && console)
+    {
+      GalileoSolver solver(result.path, console, nav_data_file, mode_);
+      converted = solver.read();
+
+      result.sfrbx = solver.sfrbxCount();
+      result.nav_sig = solver.navSigCount();
+      result.pages = solver.pageCount();
+      result.resync = solver.resyncCount();
+    }
+
+    converted = converted && nav_data_file.flush() && console.flush();
+  }
+
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (converted)
+    converted = std::rename((nav_path + ".part").c_str(), nav_path.c_str()) == 0 &&
+                std::rename((log_path + ".part").c_str(), log_path.c_str()) == 0;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!converted)
+  {
+    std::remove((nav_path + ".part").c_str());
+    std::remove((log_path + ".part").c_str());
+
+    claimed_.erase(result.hash); // A later run tries again
+    result.status = BatchResult::FAILED;
+    return;
+  }
+
+  // Appended right away, so the files done before a crash are not converted again
+  std::ofstream manifest(fs::path(output_dir_) / MANIFEST_NAME, std::ios::app);
+  manifest << result.hash << "\t" << result.path << std::endl;
+
+  result.status = BatchResult::CONVERTED;
+}
+
+
+void BatchDriver::writeSummary() const
+{
+  std::ostringstream text;
+  formatSummary(text, results_);
+
+  std::ofstream summary(fs::path(output_dir_) / SUMMARY_NAME);
+  summary << text.str();
+  std::cout << text.str();
+}
@@ -0,0 +1,41 @@
+#include "batch_driver.h"
+#include <thread>
+
+int main(int argc, char **argv) {
+  std::string output_dir = "../data/batch";
+  unsigned jobs = std::thread::hardware_concurrency();
+  GalileoSolver::InputMode mode = GalileoSolver::STREAM;
+  std::vector<std::string> inputs;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+
+    if (arg == "--out" && i + 1 < argc)
+      output_dir = argv[++i];
+    else if (arg == "--jobs" && i + 1 < argc)
+      jobs = std::stoul(argv[++i]);
+    else if (arg == "--mmap")
+      mode = GalileoSolver::MMAP;
+    else if (arg == "--async")
+      mode = GalileoSolver::ASYNC;
+    else if (arg == "--direct")
+      mode = GalileoSolver::DIRECT;
+    else
+      inputs.push_back(arg);
+  }
+
+  if (inputs.empty())
+  {
+    std::cout << "Usage: galileo_batch [--out DIR] [--jobs N] [--mmap|--async|--direct] FILE|DIR|PATTERN..." << std::endl;
+    return 2;
+  }
+
+  BatchDriver driver(output_dir, jobs, mode);
+
+  for (const std::string &input : inputs)
+    if (!driver.addInput(input))
+      std::cout << "No input files: " << input << std::endl;
+
+  return driver.run() ? 0 : 1;
+}
@@ -0,0 +1,281 @@
+#include "compressed_source.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef GALILEO_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef GALILEO_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+
+const size_t CompressedSource::INPUT_SIZE;
+const size_t CompressedSource::MAGIC_SIZE;
+
+
+/**
+ * @brief Decompressor of one format
+ *
+ */
+struct CompressedSource::Decoder
+{
+  bool pending = false; // In the middle of a gzip member or zstd frame
+
+  virtual ~Decoder() = default;
+
+
+  /**
+   * @brief Decompresses from in into out and moves both behind the bytes
+   *        used and produced
+   *
+   * @return true while the data is valid
+   * @return false when it is corrupt
+   */
+  virtual bool decode(const uint8_t *&in, const uint8_t *in_end, uint8_t *&out, uint8_t *out_end) = 0;
+};
+
+
+namespace
+{
+
+#ifdef GALILEO_HAVE_ZLIB
+struct GzipDecoder : CompressedSource::Decoder
+{
+  z_stream stream{};
+  bool ready = false;
+
+  GzipDecoder() { ready = inflateInit2(&stream, 16 + MAX_WBITS) == Z_OK; } // gzip header only
+  ~GzipDecoder() override { inflateEnd(&stream); }
+
+  bool decode(const uint8_t *&in, const uint8_t *in_end, uint8_t *&out, uint8_t *out_end) override
+  {
+    stream.next_in = const_cast<Bytef *>(in);
+    stream.avail_in = in_end - in;
+    stream.next_out = out;
+    stream.avail_out = out_end - out;
+
+    int result = ready ? inflate(&stream, Z_NO_FLUSH) : Z_STREAM_ERROR;
+
+    in = stream.next_in;
+    out = stream.next_out;
+
+    // Another member may follow
+    if (result == Z_STREAM_END)
+    {
+      pending = false;
+      return inflateReset(&stream) == Z_OK;
+    }
+
+    pending = true;
+
+    return result == Z_OK || result == Z_BUF_ERROR;
+  }
+};
+#endif
+
+
+#ifdef GALILEO_HAVE_ZSTD
+struct ZstdDecoder : CompressedSource::Decoder
+{
+  ZSTD_DStream *stream = ZSTD_createDStream();
+
+  ZstdDecoder() { ZSTD_initDStream(stream); }
+  ~ZstdDecoder() override { ZSTD_freeDStream(stream); }
+
+  bool decode(const uint8_t *&in, const uint8_t *in_end, uint8_t *&out, uint8_t *out_end) override
+  {
+    ZSTD_inBuffer input = {in, static_cast<size_t>(in_end - in), 0};
+    ZSTD_outBuffer output = {out, static_cast<size_t>(out_end - out), 0};
+
+    // Reads across frames, 0 is returned at the end of each
+    size_t result = ZSTD_decompressStream(stream, &output, &input);
+
+    in += input.pos;
+    out += output.pos;
+    pending = result != 0;
+
+    return !ZSTD_isError(result);
+  }
+};
+#endif
+
+} // namespace
+
+
+CompressedSource::CompressedSource() = default;
+
+
+CompressedSource::~CompressedSource() = default;
+
+
+CompressedSource::Format CompressedSource::detect(const uint8_t *data, size_t size)
+{
+  if (size >= 2 && data[0] == 0x1f && data[1] == 0x8b)
+    return GZIP;
+
+  if (size >= 4 && data[0] == 0x28 && data[1] == 0xb5 && data[2] == 0x2f && data[3] == 0xfd)
+    return ZSTD;
+
+  return PLAIN;
+}
+
+
+CompressedSource::Format CompressedSource::detect(const std::string &path)
+{
+  uint8_t magic[MAGIC_SIZE];
+  std::ifstream file(path, std::ios::binary);
+
+  file.read(reinterpret_cast<char *>(magic), sizeof(magic));
+
+  return detect(magic, file.gcount());
+}
+
+
+bool CompressedSource::supported(Format format)
+{
+  switch (format)
+  {
+  case GZIP:
+#ifdef GALILEO_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+
+  case ZSTD:
+#ifdef GALILEO_HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+
+  default:
+    return true;
+  }
+}
+
+
+bool CompressedSource::open(ByteSource *source)
+{
+  source_ = source;
+  decoder_.reset();
+  input_.resize(INPUT_SIZE);
+  input_begin_ = 0;
+  input_end_ = 0;
+  input_done_ = false;
+  corrupt_ = false;
+
+  // The magic bytes are kept and handed on first, pipes cannot be read twice
+  while (input_end_ < MAGIC_SIZE)
+  {
+    long count = source_->read(input_.data() + input_end_, MAGIC_SIZE - input_end_);
+
+    if (count <= 0)
+    {
+      input_done_ = true;
+      break;
+    }
+
+    input_end_ += count;
+  }
+
+  format_ = detect(input_.data(), input_end_);
+
+  if (!supported(format_))
+    return false;
+
+#ifdef GALILEO_HAVE_ZLIB
+  if (format_ == GZIP)
+    decoder_ = std::make_unique<GzipDecoder>();
+#endif
+
+#ifdef GALILEO_HAVE_ZSTD
+  if (format_ == ZSTD)
+    decoder_ = std::make_unique<ZstdDecoder>();
+#endif
+
+  return true;
+}
+
+
+long CompressedSource::read(uint8_t *dst, size_t size)
+{
+  if (decoder_ != nullptr)
+    return decode(dst, size, true);
+
+  if (input_begin_ < input_end_)
+  {
+    size = std::min(size, input_end_ - input_begin_);
+    std::memcpy(dst, input_.data() + input_begin_, size);
+    input_begin_ += size;
+    return size;
+  }
+
+  return input_done_ ? 0 : source_->read(dst, size);
+}
+
+
+long CompressedSource::readAvailable(uint8_t *dst, size_t size)
+{
+  if (decoder_ != nullptr)
+    return decode(dst, size, false);
+
+  if (input_begin_ < input_end_)
+    return read(dst, size);
+
+  return input_done_ ? 0 : source_->readAvailable(dst, size);
+}
+
+
+long CompressedSource::decode(uint8_t *dst, size_t size, bool wait)
+{
+  uint8_t *out = dst;
+
+  while (out == dst && size > 0)
+  {
+    if (input_begin_ == input_end_)
+    {
+      if (input_done_)
+      {
+        corrupt_ = corrupt_ || decoder_->pending; // Ends inside a member or frame
+        return 0;
+      }
+
+      long count = wait ? source_->read(input_.data(), input_.size()) : source_->readAvailable(input_.data(), input_.size());
+
+      if (count < 0)
+        return -1;
+
+      if (count == 0)
+      {
+        if (!wait)
+          return 0; // Nothing has arrived yet
+
+        input_done_ = true;
+      }
+
+      input_begin_ = 0;
+      input_end_ = count;
+      continue;
+    }
+
+    const uint8_t *in = input_.data() + input_begin_;
+
+    if (!decoder_->decode(in, input_.data() + input_end_, out, dst + size) ||
+        (in == input_.data() + input_begin_ && out == dst))
+    {
+      // Damaged data ends the input, what was decompressed before it is kept
+      corrupt_ = true;
+      input_begin_ = input_end_;
+      input_done_ = true;
+      break;
+    }
+
+    input_begin_ = in - input_.data();
+  }
+
+  return out - dst;
+}
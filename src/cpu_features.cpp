@@ -0,0 +1,30 @@
+#include "cpu_features.h"
+
+
+namespace
+{
+
+CpuFeatures detectCpuFeatures()
+{
+  CpuFeatures features;
+
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+
+  features.sse2 = __builtin_cpu_supports("sse2");
+  features.avx2 = __builtin_cpu_supports("avx2");
+  features.bmi2 = __builtin_cpu_supports("bmi2") && !__builtin_cpu_is("amdfam17h");
+  features.pclmul = __builtin_cpu_supports("pclmul");
+#endif
+
+  return features;
+}
+
+} // namespace
+
+
+const CpuFeatures &cpuFeatures()
+{
+  static const CpuFeatures features = detectCpuFeatures();
+  return features;
+}
@@ -0,0 +1,224 @@
+#include "field_kernel.h"
+#include "cpu_features.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define GALILEO_X86 1
+#endif
+
+
+namespace
+{
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+
+/**
+ * @brief Sign extends the fields of signed descriptors
+ *
+ */
+template <const InavField &F>
+ALWAYS_INLINE auto signedField(uint64_t value)
+{
+  if constexpr (F.is_signed)
+    return static_cast<int64_t>(value << (64 - F.width)) >> (64 - F.width);
+  else
+    return value;
+}
+
+
+// Shifts and masks with the positions known at compile time
+struct ScalarFields
+{
+  template <const InavField &F>
+  static ALWAYS_INLINE auto get(const InavPage &page) { return page.field<F>(); }
+};
+
+
+#ifdef GALILEO_X86
+
+// Mask of the bits first .. first + count - 1 of a half, bit 0 being its most significant bit
+constexpr uint64_t halfMask(unsigned first, unsigned count)
+{
+  return (count == 0) ? 0 : ((count == 64) ? ~uint64_t(0) : ((uint64_t(1) << count) - 1) << (64 - first - count));
+}
+
+
+// One pext per half of the page the field lies in
+struct Bmi2Fields
+{
+  template <const InavField &F>
+  __attribute__((target("bmi2")))
+  static inline auto get(const InavPage &page)
+  {
+    constexpr unsigned first = 6 + F.offset; // Behind the word type
+    constexpr unsigned end = first + F.width;
+
+    uint64_t value;
+
+    if constexpr (end <= 64)
+      value = _pext_u64(page.high(), halfMask(first, F.width));
+    else if constexpr (first >= 64)
+      value = _pext_u64(page.low(), halfMask(first - 64, F.width));
+    else
+      value = _pext_u64(page.high(), halfMask(first, 64 - first)) << (end - 64) |
+              _pext_u64(page.low(), halfMask(0, end - 64));
+
+    return signedField<F>(value);
+  }
+};
+
+#endif
+
+
+template <class Fields>
+inline void decodeFields(const InavPage &page, GalileoSolver::WordType1 &word)
+{
+  word.issue_of_data = Fields::template get<InavWord1::issue_of_data>(page);
+  word.reference_time = Fields::template get<InavWord1::reference_time>(page);
+  word.mean_anomaly = Fields::template get<InavWord1::mean_anomaly>(page);
+  word.eccentricity = Fields::template get<InavWord1::eccentricity>(page);
+  word.root_semi_major_axis = Fields::template get<InavWord1::root_semi_major_axis>(page);
+  word.reserved = Fields::template get<InavWord1::reserved>(page);
+}
+
+
+template <class Fields>
+inline void decodeFields(const InavPage &page, GalileoSolver::WordType2 &word)
+{
+  word.issue_of_data = Fields::template get<InavWord2::issue_of_data>(page);
+  word.longitude = Fields::template get<InavWord2::longitude>(page);
+  word.inclination_angle = Fields::template get<InavWord2::inclination_angle>(page);
+  word.perigee = Fields::template get<InavWord2::perigee>(page);
+  word.ia_rate_of_change = Fields::template get<InavWord2::ia_rate_of_change>(page);
+  word.reserved = Fields::template get<InavWord2::reserved>(page);
+}
+
+
+template <class Fields>
+inline void decodeFields(const InavPage &page, GalileoSolver::WordType3 &word)
+{
+  word.issue_of_data = Fields::template get<InavWord3::issue_of_data>(page);
+  word.ra_rate_of_change = Fields::template get<InavWord3::ra_rate_of_change>(page);
+  word.mean_motion_difference = Fields::template get<InavWord3::mean_motion_difference>(page);
+  word.C_uc = Fields::template get<InavWord3::C_uc>(page);
+  word.C_us = Fields::template get<InavWord3::C_us>(page);
+  word.C_rc = Fields::template get<InavWord3::C_rc>(page);
+  word.C_rs = Fields::template get<InavWord3::C_rs>(page);
+  word.sisa = Fields::template get<InavWord3::sisa>(page);
+}
+
+
+template <class Fields>
+inline void decodeFields(const InavPage &page, GalileoSolver::WordType4 &word)
+{
+  word.issue_of_data = Fields::template get<InavWord4::issue_of_data>(page);
+  word.svid = Fields::template get<InavWord4::svid>(page);
+  word.C_ic = Fields::template get<InavWord4::C_ic>(page);
+  word.C_is = Fields::template get<InavWord4::C_is>(page);
+  word.reference = Fields::template get<InavWord4::reference>(page);
+  word.clock_bias_corr = Fields::template get<InavWord4::clock_bias_corr>(page);
+  word.clock_drift_corr = Fields::template get<InavWord4::clock_drift_corr>(page);
+  word.clock_drift_rate_corr = Fields::template get<InavWord4::clock_drift_rate_corr>(page);
+  word.spare = Fields::template get<InavWord4::spare>(page);
+}
+
+
+template <class Fields>
+inline void decodeFields(const InavPage &page, GalileoSolver::WordType5 &word)
+{
+  word.effionl_0 = Fields::template get<InavWord5::effionl_0>(page);
+  word.effionl_1 = Fields::template get<InavWord5::effionl_1>(page);
+  word.effionl_2 = Fields::template get<InavWord5::effionl_2>(page);
+  word.region1 = Fields::template get<InavWord5::region1>(page);
+  word.region2 = Fields::template get<InavWord5::region2>(page);
+  word.region3 = Fields::template get<InavWord5::region3>(page);
+  word.region4 = Fields::template get<InavWord5::region4>(page);
+  word.region5 = Fields::template get<InavWord5::region5>(page);
+  word.bgd_1 = Fields::template get<InavWord5::bgd_1>(page);
+  word.bgd_2 = Fields::template get<InavWord5::bgd_2>(page);
+  word.sig_health_e5b = Fields::template get<InavWord5::sig_health_e5b>(page);
+  word.sig_health_e1 = Fields::template get<InavWord5::sig_health_e1>(page);
+  word.data_validity_e5b = Fields::template get<InavWord5::data_validity_e5b>(page);
+  word.data_validity_e1 = Fields::template get<InavWord5::data_validity_e1>(page);
+  word.week_num = Fields::template get<InavWord5::week_num>(page);
+  word.time_of_week = Fields::template get<InavWord5::time_of_week>(page);
+  word.spare = Fields::template get<InavWord5::spare>(page);
+
+  // RINEX health flags: E5b HS and DVS in bits 8..6, E1-B HS and DVS in bits 2..0
+  word.sig_health_validity = word.sig_health_e5b << 7 | word.data_validity_e5b << 6 |
+                             word.sig_health_e1 << 1 | word.data_validity_e1;
+}
+
+
+template <class Word>
+void decodeScalar(const InavPage &page, Word &word)
+{
+  decodeFields<ScalarFields>(page, word);
+}
+
+
+#ifdef GALILEO_X86
+
+// Flattened, the fields inline into the BMI2 code only
+template <class Word>
+__attribute__((target("bmi2"), flatten))
+void decodeBmi2(const InavPage &page, Word &word)
+{
+  decodeFields<Bmi2Fields>(page, word);
+}
+
+#endif
+
+
+FieldKernel detectFieldKernel()
+{
+  if (cpuFeatures().bmi2)
+    return BMI2_FIELDS;
+
+  return SCALAR_FIELDS;
+}
+
+} // namespace
+
+
+template <class Word>
+void decodeWord(FieldKernel kernel, const InavPage &page, Word &word)
+{
+  if (kernel > supportedFieldKernel())
+    kernel = supportedFieldKernel();
+
+  switch (kernel)
+  {
+#ifdef GALILEO_X86
+  case BMI2_FIELDS:
+    decodeBmi2(page, word);
+    break;
+#endif
+
+  default:
+    decodeScalar(page, word);
+    break;
+  }
+}
+
+
+template void decodeWord(FieldKernel, const InavPage &, GalileoSolver::WordType1 &);
+template void decodeWord(FieldKernel, const InavPage &, GalileoSolver::WordType2 &);
+template void decodeWord(FieldKernel, const InavPage &, GalileoSolver::WordType3 &);
+template void decodeWord(FieldKernel, const InavPage &, GalileoSolver::WordType4 &);
+template void decodeWord(FieldKernel, const InavPage &, GalileoSolver::WordType5 &);
+
+
+FieldKernel supportedFieldKernel()
+{
+  static const FieldKernel kernel = detectFieldKernel();
+  return kernel;
+}
+
+
+FieldKernel activeFieldKernel()
+{
+  // The pext kernel measured slower than the shifts of the scalar one
+  return SCALAR_FIELDS;
+}
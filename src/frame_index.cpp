@@ -0,0 +1,266 @@
+#include "frame_index.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+const uint8_t FrameIndexEntry::NONE;
+const uint32_t FrameIndexEntry::NO_ITOW;
+const uint32_t FrameIndexEntry::NO_GST;
+const uint32_t FrameIndex::MAGIC;
+const uint16_t FrameIndex::VERSION;
+const uint32_t FrameQuery::DEFAULT_LEAD_IN;
+
+
+namespace
+{
+
+bool statCapture(const std::string &capture, uint64_t &size, int64_t &mtime)
+{
+  struct stat info;
+
+  if (stat(capture.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+    return false;
+
+  size = info.st_size;
+  mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+
+  return true;
+}
+
+} // namespace
+
+
+std::string FrameIndex::sidecarPath(const std::string &capture) { return capture + ".idx"; }
+
+
+bool FrameIndex::reset(const std::string &capture)
+{
+  unmap();
+  entries_.clear();
+  begin_ = end_ = nullptr;
+
+  return statCapture(capture, capture_size_, capture_mtime_);
+}
+
+
+void FrameIndex::unmap()
+{
+  if (map_ != nullptr)
+    munmap(map_, map_size_);
+
+  map_ = nullptr;
+  map_size_ = 0;
+}
+
+
+bool FrameIndex::isCurrent(const std::string &capture) const
+{
+  uint64_t size;
+  int64_t mtime;
+
+  return statCapture(capture, size, mtime) && size == capture_size_ && mtime == capture_mtime_;
+}
+
+
+bool FrameIndex::load(const std::string &path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  struct stat info;
+
+  if (fd < 0)
+    return false;
+
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header))
+  {
+    close(fd);
+    return false;
+  }
+
+  void *map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (map == MAP_FAILED)
+    return false;
+
+  Header header;
+  std::memcpy(&header, map, sizeof(header));
+
+  if (header.magic != MAGIC || header.version != VERSION || header.entry_size != sizeof(FrameIndexEntry) ||
+      header.count > (info.st_size - sizeof(Header)) / sizeof(FrameIndexEntry))
+  {
+    munmap(map, info.st_size);
+    return false;
+  }
+
+  unmap();
+  std::vector<FrameIndexEntry>().swap(entries_);
+
+  map_ = map;
+  map_size_ = info.st_size;
+
+  capture_size_ = header.capture_size;
+  capture_mtime_ = header.capture_mtime;
+
+  begin_ = reinterpret_cast<const FrameIndexEntry *>(static_cast<const uint8_t *>(map) + sizeof(Header));
+  end_ = begin_ + header.count;
+
+  return true;
+}
+
+
+bool FrameIndex::write(const std::string &path) const
+{
+  const std::string part = path + ".part";
+
+  Header header = {MAGIC, VERSION, sizeof(FrameIndexEntry), capture_size_, capture_mtime_, size()};
+
+  {
+    std::ofstream file(part, std::ios::binary);
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(begin_), size() * sizeof(FrameIndexEntry));
+
+    if (!file.flush())
+    {
+      std::remove(part.c_str());
+      return false;
+    }
+  }
+
+  return std::rename(part.c_str(), path.c_str()) == 0;
+}
+
+
+void FrameIndex::add(const FrameIndexEntry &entry)
+{
+  entries_.push_back(entry);
+
+  begin_ = entries_.data();
+  end_ = begin_ + entries_.size();
+}
+
+
+void FrameIndex::findWindow(uint32_t first, uint32_t last, const FrameIndexEntry *&begin,
+                            const FrameIndexEntry *&end) const
+{
+  // The entry times never decrease, so both ends are found by binary search
+  begin = std::partition_point(begin_, end_, [first](const FrameIndexEntry &entry) { return entry.gst < first; });
+  end = std::partition_point(begin, end_, [last](const FrameIndexEntry &entry) { return entry.gst <= last; });
+}
+
+
+void FrameQuery::addWordTypes(unsigned first, unsigned last)
+{
+  for (unsigned word_type = first; word_type <= last && word_type < 64; word_type++)
+    word_types_ |= 1ULL << word_type;
+}
+
+
+void FrameQuery::setWindow(uint32_t first, uint32_t last, uint32_t lead_in)
+{
+  windowed_ = true;
+  first_time_ = (first > lead_in) ? first - lead_in : 0;
+  last_time_ = last;
+}
+
+
+bool FrameQuery::matches(const FrameIndexEntry &entry) const
+{
+  if (entry.gnssId != 2 || entry.word_type == FrameIndexEntry::NONE)
+    return false;
+
+  if (satellites_ != 0 && !(satellites_ >> (entry.svId & 63) & 1))
+    return false;
+
+  return word_types_ == 0 || (word_types_ >> entry.word_type & 1);
+}
+
+
+bool FrameQuery::parse(const std::string &spec, FrameQuery &query)
+{
+  const size_t colon = spec.find(':');
+  const std::string satellites = spec.substr(0, colon);
+  const std::string word_types = (colon == std::string::npos) ? "" : spec.substr(colon + 1);
+
+  // Reads a number in [0, max] at pos and moves pos behind it
+  auto number = [](const std::string &text, size_t &pos, unsigned long max, unsigned &value)
+  {
+    const char *begin = text.c_str() + pos;
+    char *end;
+
+    if (pos >= text.size() || text[pos] < '0' || text[pos] > '9')
+      return false;
+
+    unsigned long parsed = std::strtoul(begin, &end, 10);
+    pos += end - begin;
+    value = parsed;
+
+    return parsed <= max;
+  };
+
+  FrameQuery parsed;
+  size_t pos = 0;
+  unsigned first, last;
+
+  while (pos < satellites.size())
+  {
+    if (satellites[pos] != 'E' || !number(satellites, ++pos, 36, first) || first == 0)
+      return false;
+
+    parsed.addSatellite(first);
+
+    if (pos < satellites.size() && satellites[pos++] != ',')
+      return false;
+  }
+
+  pos = 0;
+
+  while (pos < word_types.size())
+  {
+    if (!number(word_types, pos, 63, first))
+      return false;
+
+    last = first;
+
+    if (pos < word_types.size() && word_types[pos] == '-' && (!number(word_types, ++pos, 63, last) || last < first))
+      return false;
+
+    parsed.addWordTypes(first, last);
+
+    if (pos < word_types.size() && word_types[pos++] != ',')
+      return false;
+  }
+
+  query = parsed;
+
+  return true;
+}
+
+
+bool FrameQuery::parseWindow(const std::string &spec, uint32_t &first, uint32_t &last)
+{
+  unsigned first_week, first_tow, last_week, last_tow;
+  char colon1, comma, colon2, extra;
+
+  std::istringstream text(spec);
+
+  if (!(text >> first_week >> colon1 >> first_tow >> comma >> last_week >> colon2 >> last_tow) || text >> extra)
+    return false;
+
+  if (colon1 != ':' || comma != ',' || colon2 != ':' || first_tow >= 604800 || last_tow >= 604800 ||
+      first_week >= 4096 || last_week >= 4096)
+    return false;
+
+  first = first_week * 604800 + first_tow;
+  last = last_week * 604800 + last_tow;
+
+  return first <= last;
+}
@@ -1,1092 +1,1339 @@
 #include "galileo_solver.h"
+#include "field_kernel.h"
+#include "inav_crc.h"
+#include "sync_scanner.h"
+#include "ubx_checksum.h"
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+const char *GalileoSolver::DEFAULT_NAV_DATA_PATH = "../data/output_navdata.txt";
+const uint32_t GalileoSolver::CHECKPOINT_MAGIC;
+const uint16_t GalileoSolver::CHECKPOINT_VERSION;
+const int GalileoSolver::FOLLOW_POLL_MS;
+
+
+GalileoSolver::GalileoSolver(const std::string &path, InputMode mode, size_t chunk_size) 
+  : GalileoSolver(path, std::cout, owned_nav_data_file_, mode, chunk_size) 
+{
+  owned_nav_data_file_.open(DEFAULT_NAV_DATA_PATH);
+}
+
 
+GalileoSolver::GalileoSolver(const std::string &path, std::ostream &console, std::ostream &nav_data_file,
+                             InputMode mode, size_t chunk_size) 
+  : file_(path), input_mode_(mode), buffer_(chunk_size) 
+{
+  context_.console = &console;
+  context_.nav_data_file = &nav_data_file;
 
-GalileoSolver::GalileoSolver(const std::string &path) : file_(path) {}
+  for (NavigationData &data : nav_data)
+    data.setContext(&context_);
+}
 
 
-void GalileoSolver::read() 
-{
-  raw_data_.open(file_, std::ios::binary);
+GalileoSolver::~GalileoSolver() { unmapFile(); }
 
-  if (!raw_data_.is_open()) 
-    std::cout << "File cannot be read" << std::endl;
 
-  while (!raw_data_.eof()) 
+bool GalileoSolver::read() 
+{
+  if (!openInput()) 
   {
-    raw_data_.read(reinterpret_cast<char *>(&byte_), sizeof(byte_));
+    *context_.console << "File cannot be read\n" << std::flush;
+    return false;
+  }
 
-    checkSyncHeaders(byte_);
+  while (fetch(1)) 
+  {
+    cursor_ = findSyncHeaders(cursor_, end_);
 
-    if (sync_lock_1_ && sync_lock_2_) 
+    // A first header byte at the end of the window waits for the next chunk
+    if (end_ - cursor_ < 2)
     {
-      parseInitialData(raw_data_);
-      parsePayloadData(raw_data_);
-      pos_ = 0;
-      bitsize_ = 32;
+      if (cursor_ == end_ || fetch(2))
+        continue;
 
-      sync_lock_1_ = false;
-      sync_lock_2_ = false;
+      break;
     }
-  }
-  log();
-  raw_data_.close();
-}
-
 
-void GalileoSolver::checkSyncHeaders(uint8_t &byte_) 
-{
-  if (!sync_lock_1_) 
-  {
-    if (byte_ == SYNC_HEADER_1_) 
-      sync_lock_1_ = true;
-  } 
-  
-  else 
-  {
-    if (byte_ == SYNC_HEADER_2_)
-      sync_lock_2_ = true;
+    cursor_ += 2;
 
-    else
-      sync_lock_1_ = false;
+    parseFrame();
   }
-}
 
+  if (compressed_source_.corrupt())
+    *context_.console << "Compressed data is corrupt\n" << std::flush;
 
-void GalileoSolver::parseInitialData(std::ifstream &raw_data_) 
-{ 
-  raw_data_.read(reinterpret_cast<char *>(&msg_head), sizeof(msg_head));
-
-  if (msg_head.message_class == 0x02 && msg_head.message_id == 0x13) 
-  {
-    msg_type_ = UBX_RXM_SFRBX;
-    rxm_sfrbx_counter++;
-  } 
+  log();
 
-  else if (msg_head.message_class == 0x01 && msg_head.message_id == 0x43) 
-  {
-    msg_type_ = UBX_NAV_SIG;
-    nav_sig_counter++;
-  } 
+  unmapFile();
+  buffer_.attach(nullptr);
 
-  else
-    msg_type_ = NOT_DEFINED;
+  return true;
 }
 
 
-bool GalileoSolver::checkSum(std::ifstream &raw_data_)
+bool GalileoSolver::readParallel(unsigned threads, size_t range_size)
 {
-  raw_data_.seekg(-4, std::ios::cur);
-
-  char *buffer = new char[msg_head.length + 4];
-  raw_data_.read(buffer, (msg_head.length + 4));
+  // Compressed data has no byte ranges to split, it is decompressed serially
+  if (CompressedSource::detect(file_) != CompressedSource::PLAIN)
+    return read();
 
-  uint8_t ck_a = 0;
-  uint8_t ck_b = 0;
-
-  for (int i=0; i<(msg_head.length+4); i++) 
+  if (!mapFile()) 
   {
-    ck_a = ck_a + buffer[i];
-    ck_b = ck_b + ck_a;
+    *context_.console << "File cannot be read\n" << std::flush;
+    return false;
   }
 
-  raw_data_.read(reinterpret_cast<char *>(&checksum), sizeof(checksum));
-  raw_data_.seekg(-(msg_head.length + 2), std::ios::cur);
+  if (threads == 0)
+    threads = 1;
 
-  delete[] buffer;
+  if (range_size == 0)
+    range_size = DEFAULT_RANGE_SIZE;
 
-  if (ck_a == checksum.ck_a && ck_b == checksum.ck_b) 
-    return true;
+  const size_t file_size = map_end_ - map_begin_;
+  std::vector<DecodedRange> ranges((file_size + range_size - 1) / range_size);
 
-  else 
+  for (size_t i=0; i<ranges.size(); i++)
   {
-    std::cout << "checksum false" << std::endl; 
-    return false;
+    ranges[i].begin = map_begin_ + i * range_size;
+    ranges[i].end = (i + 1 == ranges.size()) ? map_end_ : ranges[i].begin + range_size;
   }
-}
-
-bool GalileoSolver::parsePayloadData(std::ifstream &raw_data_) 
-{
-  if (msg_type_ == UBX_RXM_SFRBX) 
-  {
-    
-    if (!checkSum(raw_data_)) {false_counter++; return false;}
-
-    raw_data_.read(reinterpret_cast<char *>(&payload_sfrbx_head),
-                   sizeof(payload_sfrbx_head));
-
-    gnssCount(payload_sfrbx_head);
 
-    if (payload_sfrbx_head.gnssId != 2)
-      return false;
+  // Workers stay at most this many ranges ahead of the merge, which
+  // bounds the memory held by the decoded pages
+  const size_t window = 2 * threads;
 
+  std::mutex mutex;
+  std::condition_variable ready;
+  size_t next_range = 0;
+  size_t merged = 0;
 
-    uint32_t dword = getDataWord();
-
-    payload_data_word_head.even_odd = getBits(dword, 1);
-    payload_data_word_head.page_type = getBits(dword, 1);
-    payload_data_word_head.word_type = getBits(dword, 6);
+  auto work = [&]()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
 
-    if (payload_data_word_head.page_type == 1) // Skip alert pages
-      return false;
+    while (true)
+    {
+      ready.wait(lock, [&] { return next_range == ranges.size() || next_range < merged + window; });
 
-    svId_ = payload_sfrbx_head.svId;
-    sigId_ = payload_sfrbx_head.reserved0;
+      if (next_range == ranges.size())
+        return;
 
-    counter++;
-    even_ = payload_data_word_head.even_odd;
+      DecodedRange &range = ranges[next_range++];
 
-    classifySvid();
+      lock.unlock();
+      decodeWorkerRange(range);
+      lock.lock();
 
-    if (!determineWordType(payload_data_word_head))
-      return false;
+      range.done = true;
+      ready.notify_all();
+    }
+  };
 
-    if (!parseDataWord(raw_data_, dword))
-      return false;
+  std::vector<std::thread> workers;
 
-    true_counter++;
+  for (unsigned i=0; i<threads; i++)
+    workers.emplace_back(work);
 
-    return true;
-  }
+  cursor_ = map_begin_;
+  end_ = map_end_;
 
-  else if (msg_type_ == UBX_NAV_SIG) 
+  for (DecodedRange &range : ranges)
   {
-    raw_data_.read(reinterpret_cast<char *>(&payload_navsig_head),
-                   sizeof(payload_navsig_head));
-
-    for (int i = 0; i < payload_navsig_head.numSigs; i++) 
     {
-      raw_data_.read(reinterpret_cast<char *>(&payload_navsig),
-                     sizeof(payload_navsig));
-      gnssCount(payload_navsig);
+      std::unique_lock<std::mutex> lock(mutex);
+      ready.wait(lock, [&] { return range.done; });
     }
 
-    return true;
+    mergeRange(range);
 
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++merged;
+    }
+    ready.notify_all();
   }
 
-  return false;
+  for (std::thread &worker : workers)
+    worker.join();
+
+  log();
+
+  unmapFile();
+
+  return true;
 }
 
 
-bool GalileoSolver::determineWordType(MessageDataWordHead &payload_data_word_head)
+bool GalileoSolver::follow(const std::string &checkpoint, const std::atomic<bool> &stop)
 {
-  switch (payload_data_word_head.word_type) 
+  struct stat info;
+
+  if (file_ == "-" || !source_.open(file_) || fstat(source_.fd(), &info) != 0) 
   {
-  case 0:
-    word_type_ = SPARE;
-    ++wordtype0_counter;
-    return true;
+    *context_.console << "File cannot be read\n" << std::flush;
+    return false;
+  }
 
-  case 1:
-    word_type_ = EPHEMERIS_1;
-    ++wordtype1_counter;
-    return true;
+  CheckpointHead head{};
+  head.device = info.st_dev;
+  head.inode = info.st_ino;
 
-  case 2:
-    word_type_ = EPHEMERIS_2;
-    ++wordtype2_counter;
-    return true;
+  if (checkpoint.empty() || !loadCheckpoint(checkpoint, head) || head.offset > static_cast<uint64_t>(info.st_size) ||
+      !source_.seek(head.offset))
+    head.offset = 0;
 
-  case 3:
-    word_type_ = EPHEMERIS_3;
-    ++wordtype3_counter;
-    return true;
+  buffer_.attach(&source_, head.offset);
+  cursor_ = nullptr;
+  end_ = nullptr;
 
-  case 4:
-    word_type_ = EPHEMERIS_4__CLOCK_CORRECTION;
-    ++wordtype4_counter;
-    return true;
+  int notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
 
-  case 5:
-    word_type_ = IONOSPHERIC_CORRECTION__BGD__SIG_HEALTH__DVS__GST;
-    ++wordtype5_counter;
-    return true;
+  if (notify >= 0 && inotify_add_watch(notify, file_.c_str(), IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF) < 0)
+  {
+    close(notify);
+    notify = -1; // Polled without events
+  }
 
-  case 6:
-    word_type_ = GST_UTC_CONVERSION;
-    ++wordtype6_counter;
-    return true;
+  follow_ = true;
+  stalled_ = false;
 
-  case 7:
-    word_type_ = ALMANAC_1;
-    ++wordtype7_counter;
-    return true;
+  bool followed = true;
+  bool truncated = false;
 
-  case 8:
-    word_type_ = ALMANAC_2;
-    ++wordtype8_counter;
-    return true;
+  while (true)
+  {
+    // Taken before decoding, the bytes written before stop was set are decoded
+    const bool stopping = stop;
 
-  case 9:
-    word_type_ = ALMANAC_3;
-    ++wordtype9_counter;
-    return true;
+    decodeAvailable();
 
-  case 10:
-    word_type_ = ALMANAC_4;
-    ++wordtype10_counter;
-    return true;
+    if (!checkpoint.empty())
+    {
+      context_.nav_data_file->flush(); // The checkpoint never gets ahead of the output
 
-  case 16:
-    word_type_ = REDUCED_CED;
-    ++wordtype16_counter;
-    return true;
+      // A stalled frame starts again at its sync headers
+      head.offset = buffer_.offsetOf(cursor_) - (stalled_ ? 2 : 0);
+      saveCheckpoint(checkpoint, head);
+    }
 
-  case 17:
-    word_type_ = FEC2;
-    ++wordtype17_counter;
-    return true;
+    if (stopping || !followed)
+      break;
 
-  case 18:
-    word_type_ = FEC2;
-    ++wordtype17_counter;
-    return true;
+    followed = waitForGrowth(notify);
 
-  case 19:
-    word_type_ = FEC2;
-    ++wordtype17_counter;
-    return true;
+    if (!followed && fstat(source_.fd(), &info) == 0 && static_cast<uint64_t>(info.st_size) < buffer_.offsetOf(end_))
+    {
+      truncated = true;
+      break;
+    }
+  }
 
-  case 20:
-    word_type_ = FEC2;
-    ++wordtype17_counter;
-    return true;
+  if (notify >= 0)
+    close(notify);
 
-  case 63:
-    word_type_ = DUMMY;
-    ++wordtype63_counter;
-    return true;
+  follow_ = false;
+  log();
 
-  default:
-    warn();
-    false_counter++;
-    return false;
-  }
-}
+  buffer_.attach(nullptr);
 
+  if (truncated)
+    *context_.console << "File was truncated\n" << std::flush;
 
-bool GalileoSolver::parseDataWord(std::ifstream &raw_data_, uint32_t dword_1)                              
-{
+  return !truncated;
+}
 
-  if (word_type_ == EPHEMERIS_1) // Word Type 1
-  { 
-    unsigned issue_of_data = getBits(dword_1, 10);
-    unsigned reference_time = getBits(dword_1, 14);
 
+void GalileoSolver::feed(const uint8_t *data, size_t size)
+{
+  if (!fed_)
+  {
+    buffer_.attach(&feed_source_);
+    cursor_ = nullptr;
+    end_ = nullptr;
+
+    // The end of a piece is where the stream goes on, like a followed file
+    fed_ = true;
+    follow_ = true;
+    stalled_ = false;
+    context_.live = true;
+  }
 
-    uint32_t dword_2 = getDataWord();
-    signed mean_anomaly = getBits(dword_2, 32);
+  // decodeAvailable reads the piece to its end, the chunk buffer keeps an incomplete frame
+  feed_source_.assign(data, size);
+  decodeAvailable();
+}
 
 
-    uint32_t dword_3 = getDataWord();
-    unsigned eccentricity = getBits(dword_3, 32);
+void GalileoSolver::finishFeed()
+{
+  if (!fed_)
+    return;
 
+  // A stalled frame and the bytes behind it are decoded as the end of a file
+  follow_ = false;
+  decodeAvailable();
+  log();
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+  buffer_.attach(nullptr);
+  fed_ = false;
+}
 
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+void GalileoSolver::decodeAvailable()
+{
+  while (true)
+  {
+    if (stalled_)
+    {
+      stalled_ = false;
+      parseFrame();
+    }
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+    else
+    {
+      if (!fetch(1))
+        return;
 
+      cursor_ = findSyncHeaders(cursor_, end_);
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    unsigned root_semi_major_axis = getBits(dword_data, 32);
-    unsigned reserved = getBits(dword_data, 2);
+      // A first header byte at the end of the file waits for the file to grow
+      if (end_ - cursor_ < 2)
+      {
+        if (cursor_ == end_ || fetch(2))
+          continue;
 
+        return;
+      }
 
-    word_type_1.issue_of_data = issue_of_data;
-    word_type_1.reference_time = reference_time;
-    word_type_1.mean_anomaly = mean_anomaly;
-    word_type_1.eccentricity = eccentricity;
-    word_type_1.root_semi_major_axis = root_semi_major_axis;
-    word_type_1.reserved = reserved;
+      cursor_ += 2;
+      parseFrame();
+    }
 
+    if (stalled_)
+      return;
+  }
+}
 
-    nav_data[svId_-1].add(word_type_1, svId_, sigId_);
 
-    
-    return true;
-  }
+bool GalileoSolver::waitForGrowth(int notify)
+{
+  bool moved = false;
 
+  if (notify < 0)
+    poll(nullptr, 0, FOLLOW_POLL_MS);
 
-  else if (word_type_ == EPHEMERIS_2) // Word Type 2
+  else
   {
-    unsigned issue_of_data = getBits(dword_1, 10);
-    signed longitude_1 = getBits(dword_1, 14); // 18 left
-
+    pollfd events = {notify, POLLIN, 0};
 
-    uint32_t dword_2 = getDataWord();
-    signed longitude_2 = getBits(dword_2, 18);
-    signed inclination_angle_1 = getBits(dword_2, 14); // 18 left
+    if (poll(&events, 1, FOLLOW_POLL_MS) > 0)
+    {
+      alignas(inotify_event) char buffer[4096];
+      ssize_t size;
 
+      while ((size = ::read(notify, buffer, sizeof(buffer))) > 0)
+        for (ssize_t i = 0; i < size; i += sizeof(inotify_event) + reinterpret_cast<inotify_event *>(buffer + i)->len)
+          moved = moved || (reinterpret_cast<inotify_event *>(buffer + i)->mask & (IN_MOVE_SELF | IN_DELETE_SELF));
+    }
+  }
 
-    uint32_t dword_3 = getDataWord();
-    signed inclination_angle_2 = getBits(dword_3, 18);
-    signed perigee_1 = getBits(dword_3, 14); // 18 left
+  // An unlinked file only gets an attribute event while it is open here
+  struct stat info;
 
+  return !moved && fstat(source_.fd(), &info) == 0 && info.st_nlink > 0 &&
+         static_cast<uint64_t>(info.st_size) >= buffer_.offsetOf(end_);
+}
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
 
+bool GalileoSolver::buildIndex(FrameIndex &index) const
+{
+  // Framed on a separate solver, so the counters of this one stay untouched
+  GalileoSolver indexer(file_, *context_.console, *context_.nav_data_file, MMAP);
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+  // The offsets of an index point into the file as it is stored
+  if (CompressedSource::detect(file_) != CompressedSource::PLAIN)
+  {
+    *context_.console << "Compressed file cannot be indexed\n" << std::flush;
+    return false;
+  }
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
-      
+  if (!indexer.mapFile() || !index.reset(file_)) 
+  {
+    *context_.console << "File cannot be read\n" << std::flush;
+    return false;
+  }
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    signed perigee_2 = getBits(dword_data, 18);
-    signed ia_rate_of_change = getBits(dword_data, 14);
-    unsigned reserved = getBits(dword_data, 2);
+  indexer.index_ = &index;
+  indexer.cursor_ = indexer.map_begin_;
+  indexer.end_ = indexer.map_end_;
+  indexer.decodeRange(indexer.map_end_);
 
-    
-    word_type_2.issue_of_data = issue_of_data;
-    word_type_2.longitude = concatenateBits(longitude_1, longitude_2, 14, 18);
-    word_type_2.inclination_angle = concatenateBits(inclination_angle_1, inclination_angle_2, 14, 18);
-    word_type_2.perigee = concatenateBits(perigee_1, perigee_2, 14, 18);
-    word_type_2.ia_rate_of_change = ia_rate_of_change;
-    word_type_2.reserved = reserved;
+  return true;
+}
 
 
-    nav_data[svId_-1].add(word_type_2, svId_, sigId_);
+bool GalileoSolver::readIndexed(const FrameIndex &index, const FrameQuery &query)
+{
+  if (!mapFile()) 
+  {
+    *context_.console << "File cannot be read\n" << std::flush;
+    return false;
+  }
 
+  const size_t file_size = map_end_ - map_begin_;
 
-    return true;
+  // A capture rewritten in place may keep its size, the index keeps its modification time too
+  if (!index.isCurrent(file_) || index.captureSize() != file_size)
+  {
+    *context_.console << "Index does not match the file\n" << std::flush;
+    unmapFile();
+    return false;
   }
 
+  end_ = map_end_;
 
-  else if (word_type_ == EPHEMERIS_3) // Word Type 3
-  { 
-    unsigned issue_of_data = getBits(dword_1, 10);
-    signed ra_rate_of_change_1 = getBits(dword_1, 14); // 10 left
+  const FrameIndexEntry *begin = index.begin();
+  const FrameIndexEntry *end = index.end();
 
+  if (query.windowed())
+    index.findWindow(query.firstTime(), query.lastTime(), begin, end);
 
-    uint32_t dword_2 = getDataWord();
-    signed ra_rate_of_change_2 = getBits(dword_2, 10);
-    signed mean_motion_difference = getBits(dword_2, 16);
-    signed C_uc_1 = getBits(dword_2, 6); // 10 left
+  for (const FrameIndexEntry *entry = begin; entry != end; entry++)
+  {
+    if (!query.matches(*entry) || entry->offset + 2 > file_size)
+      continue;
 
+    cursor_ = map_begin_ + entry->offset + 2;
 
-    uint32_t dword_3 = getDataWord();
-    signed C_uc_2 = getBits(dword_3, 10);
-    signed C_us = getBits(dword_3, 16);
-    signed C_rc_1 = getBits(dword_3, 6); // 10 left
+    parseFrame();
+  }
+  log();
 
+  unmapFile();
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+  return true;
+}
 
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+void GalileoSolver::indexFrame()
+{
+  FrameIndexEntry entry;
+
+  entry.offset = (cursor_ - 2) - map_begin_;
+  entry.length = msg_head.length;
+  entry.message_class = msg_head.message_class;
+  entry.message_id = msg_head.message_id;
+  entry.gnssId = FrameIndexEntry::NONE;
+  entry.svId = FrameIndexEntry::NONE;
+  entry.sigId = FrameIndexEntry::NONE;
+  entry.word_type = FrameIndexEntry::NONE;
+
+  if (msg_type_ == UBX_RXM_SFRBX && msg_head.length >= sizeof(payload_sfrbx_head))
+  {
+    entry.gnssId = payload_sfrbx_head.gnssId;
+    entry.svId = payload_sfrbx_head.svId;
+    entry.sigId = payload_sfrbx_head.reserved0;
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+    // Word type of nominal I/NAV pages
+    if (entry.gnssId == 2 && msg_head.length >= sizeof(payload_sfrbx_head) + 8 * sizeof(uint32_t) &&
+        page_.pageType() == 0)
+      entry.word_type = page_.wordType();
 
+    // Time of the pages whose tail, even/odd halves and CRC are in order
+    bool complete = page_.complete() && checkInavCrc(page_words_);
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    signed C_rc_2 = getBits(dword_data, 10);
-    signed C_rs = getBits(dword_data, 16);
-    unsigned sisa = getBits(dword_data, 8);
+    if (entry.word_type == SPARE && complete && page_.field<InavWord0::time>() == 2)
+      advanceTime(page_.field<InavWord0::week_num>(), page_.field<InavWord0::time_of_week>(), true);
 
+    else if (entry.word_type == IONOSPHERIC_CORRECTION__BGD__SIG_HEALTH__DVS__GST && complete)
+      advanceTime(page_.field<InavWord5::week_num>(), page_.field<InavWord5::time_of_week>(), true);
 
-    word_type_3.issue_of_data = issue_of_data;
-    word_type_3.ra_rate_of_change = concatenateBits(ra_rate_of_change_1, ra_rate_of_change_2, 14, 10);
-    word_type_3.mean_motion_difference = mean_motion_difference;
-    word_type_3.C_uc = concatenateBits(C_uc_1, C_uc_2, 6, 10);
-    word_type_3.C_us = C_us;
-    word_type_3.C_rc = concatenateBits(C_rc_1, C_rc_2, 6, 10);
-    word_type_3.C_rs = C_rs;
-    word_type_3.sisa = sisa;
+    else if (entry.word_type == GST_UTC_CONVERSION && complete)
+      advanceTime(0, page_.field<InavWord6::time_of_week>(), false);
+  }
 
+  else if (msg_type_ == UBX_NAV_SIG && msg_head.length >= sizeof(iTOW_))
+  {
+    std::memcpy(&iTOW_, cursor_ + sizeof(msg_head), sizeof(iTOW_));
 
-    nav_data[svId_-1].add(word_type_3, svId_, sigId_);
+    // GST and GPS time share the time of week
+    advanceTime(0, iTOW_ / 1000, false);
+  }
 
+  entry.iTOW = iTOW_;
+  entry.gst = gst_;
 
-    return true;
-  }
+  index_->add(entry);
+}
 
 
-  else if (word_type_ == EPHEMERIS_4__CLOCK_CORRECTION) // Word Type 4
-  { 
-    unsigned issue_of_data = getBits(dword_1, 10);
-    unsigned svid = getBits(dword_1, 6);
-    signed C_ic_1 = getBits(dword_1, 8); // 8 left
+void GalileoSolver::advanceTime(uint32_t week, uint32_t time_of_week, bool has_week)
+{
+  if (time_of_week >= GST_WEEK)
+    return;
 
+  uint32_t gst;
 
-    uint32_t dword_2 = getDataWord();
-    signed C_ic_2 = getBits(dword_2, 8);
-    signed C_is = getBits(dword_2, 16);
-    unsigned reference_1 = getBits(dword_2, 8); // 6 left
+  if (has_week)
+    gst = GstClock::fromWeek(week, time_of_week, gst_);
+  else if (gst_ != FrameIndexEntry::NO_GST)
+    gst = GstClock::fromTimeOfWeek(gst_, time_of_week);
+  else
+    return;
 
+  if (gst > gst_)
+    gst_ = gst;
+}
 
-    uint32_t dword_3 = getDataWord();
-    unsigned reference_2 = getBits(dword_3, 6);
-    signed clock_bias_corr_1 = getBits(dword_3, 26); // 5 left
 
+void GalileoSolver::decodeRange(const uint8_t *limit)
+{
+  while (cursor_ < end_)
+  {
+    const uint8_t *sync = findSyncHeaders(cursor_, end_);
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
-    
+    if (sync >= limit)
+      break;
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+    // A first header byte at the end of the mapping
+    if (end_ - sync < 2)
+    {
+      cursor_ = end_;
+      break;
+    }
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+    cursor_ = sync + 2;
 
+    parseFrame();
+  }
+}
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    signed clock_bias_corr_2 = getBits(dword_data, 5);
-    signed clock_drift_corr = getBits(dword_data, 21);
-    signed clock_drift_rate_corr = getBits(dword_data, 6);
-    unsigned spare = getBits(dword_data, 2);
 
+void GalileoSolver::decodeWorkerRange(DecodedRange &range) const
+{
+  range.solver = std::make_unique<GalileoSolver>(file_, *context_.console, *context_.nav_data_file, MMAP);
 
-    word_type_4.issue_of_data = issue_of_data;
-    word_type_4.svid = svid;
-    word_type_4.C_ic = concatenateBits(C_ic_1, C_ic_2, 8, 8);
-    word_type_4.C_is = C_is;
-    word_type_4.reference = concatenateBits(reference_1, reference_2, 8, 6);
-    word_type_4.clock_bias_corr = concatenateBits(clock_bias_corr_1, clock_bias_corr_2, 26, 5);
-    word_type_4.clock_drift_corr = clock_drift_corr;
-    word_type_4.clock_drift_rate_corr = clock_drift_rate_corr;
-    word_type_4.spare = spare;
+  GalileoSolver &worker = *range.solver;
+  worker.end_ = map_end_;
+  worker.pages_ = &range.pages;
 
+  range.lock = worker.findValidFrame(range.begin, range.end);
 
-    nav_data[svId_-1].add(word_type_4, svId_, sigId_);
+  if (range.lock == nullptr)
+    return;
 
+  worker.cursor_ = range.lock;
+  worker.decodeRange(range.end);
+  range.exit = worker.cursor_;
+}
 
-    return true;
-  }
 
+void GalileoSolver::mergeRange(DecodedRange &range)
+{
+  // Frames between the previous range and the first validated frame of this one
+  if (range.lock != nullptr)
+    decodeRange(range.lock);
 
-  else if (word_type_ == IONOSPHERIC_CORRECTION__BGD__SIG_HEALTH__DVS__GST) // Word Type 5
+  // The worker result holds only when the serial sync hunt lands on the same
+  // frame, a frame of the previous range may also run over it
+  if (range.lock != nullptr && findSyncHeaders(cursor_, end_) == range.lock)
   {
-    unsigned effionl_0 = getBits(dword_1, 11);
-    signed effionl_1 = getBits(dword_1, 11);
-    signed effionl_2_1 = getBits(dword_1, 2); // 12 left
+    for (const DecodedPage &page : range.pages)
+      replayPage(page);
 
+    mergeCounters(*range.solver);
+    cursor_ = range.exit;
+  }
 
-    uint32_t dword_2 = getDataWord();
-    signed effionl_2_2 = getBits(dword_2, 12);
-    unsigned region1 = getBits(dword_2, 1);
-    unsigned region2 = getBits(dword_2, 1);
-    unsigned region3 = getBits(dword_2, 1);
-    unsigned region4 = getBits(dword_2, 1);
-    unsigned region5 = getBits(dword_2, 1);
-    signed bgd_1 = getBits(dword_2, 10);
-    signed bgd_2_1 = getBits(dword_2, 5); // 5 left
+  else
+    decodeRange(range.end);
 
+  range.solver.reset();
+  std::vector<DecodedPage>().swap(range.pages);
+}
 
-    uint32_t dword_3 = getDataWord();
-    signed bgd_2_2 = getBits(dword_3, 5);
-    unsigned sig_health_e5b = getBits(dword_3, 2);
-    unsigned sig_health_e1 = getBits(dword_3, 2);
-    unsigned data_validity_e5b = getBits(dword_3, 1);
-    unsigned data_validity_e1 = getBits(dword_3, 1);
-    unsigned week_num = getBits(dword_3, 12);
-    unsigned time_of_week_1 = getBits(dword_3, 9); // 11 left
 
+const uint8_t *GalileoSolver::findValidFrame(const uint8_t *begin, const uint8_t *limit)
+{
+  for (const uint8_t *sync = findSyncHeaders(begin, end_); sync < limit && end_ - sync >= 2; 
+       sync = findSyncHeaders(sync + 1, end_))
+  {
+    cursor_ = sync + 2;
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+    if (!parseInitialData())
+      break;
 
+    if (fetch(sizeof(msg_head) + msg_head.length + sizeof(checksum)) && checkSum())
+      return sync;
+  }
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+  return nullptr;
+}
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
 
+bool GalileoSolver::openInput()
+{
+  live_ = LiveSource::isLive(file_);
+  context_.live = live_;
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    unsigned time_of_week_2 = getBits(dword_data, 11);
-    unsigned spare = getBits(dword_data, 23);
+  // A compressed file is decompressed while it is streamed, also in MMAP mode
+  if (input_mode_ == MMAP && !live_ && CompressedSource::detect(file_) == CompressedSource::PLAIN)
+    return mapFile();
 
+  // Pipes and terminals cannot be read ahead by offset, they are streamed in every mode
+  ByteSource *source;
 
-    unsigned sig_hs_dvs_1 = concatenateBits(sig_health_e5b, data_validity_e5b, 2, 1);
-    unsigned sig_hs_dvs_2 = concatenateBits(sig_hs_dvs_1, (unsigned int)0, 3, 3);
-    unsigned sig_hs_dvs_3 = concatenateBits(sig_hs_dvs_2, sig_health_e1, 6, 2);
-    unsigned sig_hs_dvs = concatenateBits(sig_hs_dvs_3, data_validity_e1, 8, 1);
+  if (live_)
+    source = live_source_.open(file_, baud_rate_) ? &live_source_ : nullptr;
+  else if ((input_mode_ == ASYNC || input_mode_ == DIRECT) && file_ != "-")
+    source = async_source_.open(file_, input_mode_ == DIRECT) ? &async_source_ : nullptr;
+  else
+    source = source_.open(file_) ? &source_ : nullptr;
 
+  if (source == nullptr || !compressed_source_.open(source))
+    return false;
 
-    word_type_5.effionl_0 = effionl_0;
-    word_type_5.effionl_1 = effionl_1;
-    word_type_5.effionl_2 = concatenateBits(effionl_2_1, effionl_2_2, 2, 12);
-    word_type_5.region1 = region1;
-    word_type_5.region2 = region2;
-    word_type_5.region3 = region3;
-    word_type_5.region4 = region4;
-    word_type_5.region5 = region5;
-    word_type_5.bgd_1 = bgd_1;
-    word_type_5.bgd_2 = concatenateBits(bgd_2_1, bgd_2_2, 5, 5);
-    word_type_5.sig_health_e5b = sig_health_e5b;
-    word_type_5.sig_health_e1 = sig_health_e1;
-    word_type_5.data_validity_e5b = data_validity_e5b;
-    word_type_5.data_validity_e1 = data_validity_e1;
-    word_type_5.sig_health_validity = sig_hs_dvs;
-    word_type_5.week_num = week_num;
-    word_type_5.time_of_week = concatenateBits(time_of_week_1, time_of_week_2, 9, 11);
-    word_type_5.spare = spare;
+  buffer_.attach(&compressed_source_);
+  cursor_ = nullptr;
+  end_ = nullptr;
 
+  return true;
+}
 
-    nav_data[svId_-1].add(word_type_5, svId_, sigId_);
 
+bool GalileoSolver::mapFile()
+{
+  int fd = open(file_.c_str(), O_RDONLY);
 
-    return true;
-  }
+  if (fd < 0)
+    return false;
 
+  struct stat st;
 
-  else if (word_type_ == GST_UTC_CONVERSION) // Word Type 6
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
   {
-    signed A0_1 = getBits(dword_1, 24); // 8 left
+    close(fd);
+    return false;
+  }
 
+  void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping keeps its own reference to the file
 
-    uint32_t dword_2 = getDataWord();
-    signed A0_2 = getBits(dword_2, 8);
-    signed A1 = getBits(dword_2, 24);
+  if (map == MAP_FAILED)
+    return false;
 
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
 
-    uint32_t dword_3 = getDataWord();
-    signed ls_count_before = getBits(dword_3, 8);
-    unsigned utc_reference_tow = getBits(dword_3, 8);
-    unsigned utc_reference_week = getBits(dword_3, 8);
-    unsigned WN_lsf = getBits(dword_3, 8);
+  map_begin_ = static_cast<const uint8_t *>(map);
+  map_end_ = map_begin_ + st.st_size;
+  cursor_ = map_begin_;
+  end_ = map_end_;
 
+  return true;
+}
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
 
+void GalileoSolver::unmapFile()
+{
+  if (map_begin_ == nullptr)
+    return;
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+  munmap(const_cast<uint8_t *>(map_begin_), map_end_ - map_begin_);
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+  map_begin_ = nullptr;
+  map_end_ = nullptr;
+  cursor_ = nullptr;
+  end_ = nullptr;
+}
 
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    unsigned day_num = getBits(dword_data, 3);
-    signed ls_count_after = getBits(dword_data, 8);
-    unsigned time_of_week = getBits(dword_data, 20);
-    unsigned spare = getBits(dword_data, 3);
+bool GalileoSolver::readBytes(void *dst, size_t size)
+{
+  if (!fetch(size))
+  {
+    cursor_ = end_;
+    return false;
+  }
 
+  std::memcpy(dst, cursor_, size);
+  cursor_ += size;
+  return true;
+}
 
-    word_type_6.A0 = concatenateBits(A0_1, A0_2, 24, 8);
-    word_type_6.A1 = A1;
-    word_type_6.ls_count_before = ls_count_before;
-    word_type_6.utc_reference_tow = utc_reference_tow;
-    word_type_6.utc_reference_week = utc_reference_week;
-    word_type_6.WN_lsf = WN_lsf;
-    word_type_6.day_num = day_num;
-    word_type_6.ls_count_after = ls_count_after;
-    word_type_6.time_of_week = time_of_week;
-    word_type_6.spare = spare;
 
+void GalileoSolver::checkSyncHeaders(uint8_t &byte_) 
+{
+  if (!sync_lock_1_) 
+  {
+    if (byte_ == SYNC_HEADER_1_) 
+      sync_lock_1_ = true;
+  } 
+  
+  else 
+  {
+    if (byte_ == SYNC_HEADER_2_)
+      sync_lock_2_ = true;
 
-    nav_data[svId_-1].add(word_type_6, svId_, sigId_);
+    else // A repeated first header byte may still start a frame
+      sync_lock_1_ = (byte_ == SYNC_HEADER_1_);
+  }
+}
 
 
-    return true;
+void GalileoSolver::parseFrame()
+{
+  if (!parseInitialData())
+  {
+    stalled_ = follow_;
+    return;
   }
 
+  const size_t frame_size = sizeof(msg_head) + msg_head.length + sizeof(checksum);
 
-  else if (word_type_ == ALMANAC_1) // Word Type 7
+  // Also fetch the sync headers of the next frame when the input has them.
+  // A live input is not waited for, the next frame may be an epoch away
+  bool has_next = fetchAvailable(frame_size + 2);
+
+  if (!has_next && !fetch(frame_size))
   {
-    unsigned issue_of_data = getBits(dword_1, 4);
-    unsigned week_num = getBits(dword_1, 2);
-    unsigned ref_time = getBits(dword_1, 10);
-    unsigned svid_1 = getBits(dword_1, 6);
-    signed delta_root_a_1 = getBits(dword_1, 2); // 11 left
+    // A followed file is still being written
+    if (follow_)
+      stalled_ = true;
+    else
+      ++resync_counter; // Length runs past the end of the input
 
+    return;
+  }
 
-    uint32_t dword_2 = getDataWord();
-    signed delta_root_a_2 = getBits(dword_2, 11);
-    unsigned eccentricity = getBits(dword_2, 11);
-    signed perigee_1 = getBits(dword_2, 10); // 6 left
+  const uint8_t *next = cursor_ + frame_size;
 
+  if (msg_type_ == NOT_DEFINED)
+  {
+    // Without the next frame only the end of a file is a boundary
+    bool at_boundary = has_next ? (next[0] == SYNC_HEADER_1_ && next[1] == SYNC_HEADER_2_) : !live_;
 
-    uint32_t dword_3 = getDataWord();
-    signed perigee_2 = getBits(dword_3, 6);
-    signed diff_ia_na = getBits(dword_3, 11);
-    signed longitude_1 = getBits(dword_3, 15); // 1 left
+    if (!at_boundary && !checkSum())
+    {
+      ++resync_counter;
+      return;
+    }
 
+    if (index_ != nullptr)
+      indexFrame();
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+    ++skipped_counter;
+    cursor_ = next;
+    return;
+  }
 
+  bool valid = (msg_type_ == UBX_RXM_SFRBX) ? loadSfrbx() : checkSum();
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+  if (!valid)
+  {
+    ++resync_counter;
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+    if (msg_type_ == UBX_RXM_SFRBX)
+    {
+      if (pages_ != nullptr)
+      {
+        DecodedPage message;
+        message.kind = DecodedPage::CHECKSUM_FALSE;
+        pages_->push_back(message);
+      }
+      else if (index_ == nullptr)
+        *context_.console << "checksum false\n" << std::flush;
+
+      false_counter++;
+    }
+    return;
+  }
 
+  if (msg_type_ == UBX_RXM_SFRBX)
+    rxm_sfrbx_counter++;
+  else
+    nav_sig_counter++;
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    signed longitude_2 = getBits(dword_data, 1);
-    signed roc_ra = getBits(dword_data, 11);
-    signed mean_anomaly = getBits(dword_data, 16);
-    unsigned reserved = getBits(dword_data, 6);
+  if (index_ != nullptr)
+  {
+    indexFrame();
+    cursor_ = next;
+    return;
+  }
 
+  cursor_ += sizeof(msg_head);
+  parsePayloadData();
+  cursor_ = next;
+}
 
-    word_type_7.issue_of_data = issue_of_data;
-    word_type_7.week_num = week_num;
-    word_type_7.ref_time = ref_time;
-    word_type_7.svid_1 = svid_1;
-    word_type_7.delta_root_a = concatenateBits(delta_root_a_1, delta_root_a_2, 2, 11);
-    word_type_7.eccentricity = eccentricity;
-    word_type_7.perigee = concatenateBits(perigee_1, perigee_2, 10, 6);
-    word_type_7.diff_ia_na = diff_ia_na;
-    word_type_7.longitude = concatenateBits(longitude_1, longitude_2, 15, 1);
-    word_type_7.roc_ra = roc_ra;
-    word_type_7.mean_anomaly = mean_anomaly;
-    word_type_7.reserved = reserved;
 
+bool GalileoSolver::parseInitialData() 
+{ 
+  if (!fetch(sizeof(msg_head)))
+    return false;
 
-    nav_data[svId_-1].add(word_type_7, svId_, sigId_);
+  std::memcpy(&msg_head, cursor_, sizeof(msg_head));
 
+  if (msg_head.message_class == 0x02 && msg_head.message_id == 0x13) 
+    msg_type_ = UBX_RXM_SFRBX;
 
-    return true;
-  }
+  else if (msg_head.message_class == 0x01 && msg_head.message_id == 0x43) 
+    msg_type_ = UBX_NAV_SIG;
 
+  else
+    msg_type_ = NOT_DEFINED;
 
-  else if (word_type_ == ALMANAC_2)  // Word Type 8
-  {
-    unsigned issue_of_data = getBits(dword_1, 4);
-    signed clock_corr_bias = getBits(dword_1, 16);
-    signed clock_corr_linear_1 = getBits(dword_1, 4); // 9 left
+  return true;
+}
 
 
-    uint32_t dword_2 = getDataWord();
-    signed clock_corr_linear_2 = getBits(dword_2, 9);
-    unsigned sig_health_e5b = getBits(dword_2, 2);
-    unsigned sig_health_e1 = getBits(dword_2, 2);
-    unsigned svid_2 = getBits(dword_2, 6);
-    signed delta_root_a = getBits(dword_2, 13);
+bool GalileoSolver::checkSum()
+{
+  const size_t length = sizeof(msg_head) + msg_head.length;
 
+  uint8_t ck_a = 0;
+  uint8_t ck_b = 0;
 
-    uint32_t dword_3 = getDataWord();
-    unsigned eccentricity = getBits(dword_3, 11);
-    signed perigee = getBits(dword_3, 16);
-    signed diff_ia_na_1 = getBits(dword_3, 5); // 6 left
+  updateChecksum(ck_a, ck_b, cursor_, length);
 
+  std::memcpy(&checksum, cursor_ + length, sizeof(checksum));
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t  dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+  return ck_a == checksum.ck_a && ck_b == checksum.ck_b;
+}
 
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+bool GalileoSolver::loadSfrbx()
+{
+  const uint8_t *p = cursor_;
+  const uint8_t *payload_end = cursor_ + sizeof(msg_head) + msg_head.length;
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+  uint8_t ck_a = 0;
+  uint8_t ck_b = 0;
 
+  for (size_t i=0; i<sizeof(msg_head); i++, p++)
+    checksumStep(ck_a, ck_b, *p);
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    signed diff_ia_na_2 = getBits(dword_data, 6);
-    signed longitude = getBits(dword_data, 16);
-    signed roc_ra = getBits(dword_data, 11);
-    unsigned spare = getBits(dword_data, 1);
+  if (payload_end - p >= static_cast<long>(sizeof(payload_sfrbx_head)))
+  {
+    std::memcpy(&payload_sfrbx_head, p, sizeof(payload_sfrbx_head));
 
+    for (size_t i=0; i<sizeof(payload_sfrbx_head); i++, p++)
+      checksumStep(ck_a, ck_b, *p);
+  }
 
-    word_type_8.issue_of_data = issue_of_data;
-    word_type_8.clock_corr_bias = clock_corr_bias;
-    word_type_8.clock_corr_linear = concatenateBits(clock_corr_linear_1, clock_corr_linear_2, 4, 9);
-    word_type_8.sig_health_e5b = sig_health_e5b;
-    word_type_8.sig_health_e1 = sig_health_e1;
-    word_type_8.svid_2 = svid_2;
-    word_type_8.delta_root_a = delta_root_a;
-    word_type_8.eccentricity = eccentricity;
-    word_type_8.perigee = perigee;
-    word_type_8.diff_ia_na = concatenateBits(diff_ia_na_1, diff_ia_na_2, 5, 6);
-    word_type_8.longitude = longitude;
-    word_type_8.roc_ra = roc_ra;
-    word_type_8.spare = spare;
+  for (int i=0; i<8 && payload_end - p >= 4; i++, p += 4)
+  {
+    uint32_t dword;
+    std::memcpy(&dword, p, sizeof(dword));
 
+    // Little endian word, summed in byte order
+    checksumStep(ck_a, ck_b, dword & 0xff);
+    checksumStep(ck_a, ck_b, (dword >> 8) & 0xff);
+    checksumStep(ck_a, ck_b, (dword >> 16) & 0xff);
+    checksumStep(ck_a, ck_b, dword >> 24);
 
-    nav_data[svId_-1].add(word_type_8, svId_, sigId_);
+    page_words_[i] = dword;
+  }
 
+  // Words of other constellations beyond the 8th one
+  updateChecksum(ck_a, ck_b, p, payload_end - p);
 
-    return true;
-  }
+  std::memcpy(&checksum, payload_end, sizeof(checksum));
+  page_ = InavPage(page_words_);
+
+  return ck_a == checksum.ck_a && ck_b == checksum.ck_b;
+}
 
 
-  else if (word_type_ == ALMANAC_3) // Word Type 9
+bool GalileoSolver::parsePayloadData() 
+{
+  if (msg_type_ == UBX_RXM_SFRBX) 
   {
-    unsigned issue_of_data = getBits(dword_1, 4);
-    unsigned week_num = getBits(dword_1, 2);
-    unsigned ref_time = getBits(dword_1, 10);
-    signed mean_anomaly_1 = getBits(dword_1, 8); // 8 left
+    if (msg_head.length < sizeof(payload_sfrbx_head))
+      return false;
 
+    gnssCount(payload_sfrbx_head);
 
-    uint32_t dword_2 = getDataWord();
-    signed mean_anomaly_2 = getBits(dword_2, 8);
-    signed clock_corr_bias = getBits(dword_2, 16);
-    signed clock_corr_linear_1 = getBits(dword_2, 8); // 5 left
+    if (payload_sfrbx_head.gnssId != 2)
+      return false;
 
+    // I/NAV pages are carried in 8 data words
+    if (msg_head.length < sizeof(payload_sfrbx_head) + 8 * sizeof(uint32_t))
+      return false;
 
-    uint32_t dword_3 = getDataWord();
-    signed clock_corr_linear_2 = getBits(dword_3, 5);
-    unsigned sig_health_e5b = getBits(dword_3, 2);
-    unsigned sig_health_e1 = getBits(dword_3, 2);
-    unsigned svid_3 = getBits(dword_3, 6);
-    signed delta_root_a = getBits(dword_3, 13);
-    unsigned eccentricity_1 = getBits(dword_3, 4); // 7 left
 
+    payload_data_word_head.even_odd = page_.evenOdd();
+    payload_data_word_head.page_type = page_.pageType();
+    payload_data_word_head.word_type = page_.wordType();
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+    if (payload_data_word_head.page_type == 1) // Skip alert pages
+      return false;
+
+    // The satellite indexes the per-satellite state, Galileo has 36 of them
+    if (payload_sfrbx_head.svId < 1 || payload_sfrbx_head.svId > 36)
+      return false;
+
+    svId_ = payload_sfrbx_head.svId;
+    sigId_ = payload_sfrbx_head.reserved0;
+
+    counter++;
+    even_ = payload_data_word_head.even_odd;
 
+    classifySvid();
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+    if (!determineWordType(payload_data_word_head))
+      return false;
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+    // Pages that pass the UBX checksum may still have been received with bit errors
+    if (!checkInavCrc(page_words_))
+    {
+      crc_counter++;
+      false_counter++;
+      return false;
+    }
 
+    if (!parseDataWord(page_))
+      return false;
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    unsigned eccentricity_2 = getBits(dword_data, 7);
-    signed perigee = getBits(dword_data, 16);
-    signed diff_ia_na = getBits(dword_data, 11);
+    addWord();
+    true_counter++;
 
+    return true;
+  }
 
-    word_type_9.issue_of_data = issue_of_data;
-    word_type_9.week_num = week_num;
-    word_type_9.ref_time = ref_time;
-    word_type_9.mean_anomaly = concatenateBits(mean_anomaly_1, mean_anomaly_2, 8, 8);
-    word_type_9.clock_corr_bias = clock_corr_bias;
-    word_type_9.clock_corr_linear = concatenateBits(clock_corr_linear_1, clock_corr_linear_2, 8, 5);
-    word_type_9.sig_health_e5b = sig_health_e5b;
-    word_type_9.sig_health_e1 = sig_health_e1;
-    word_type_9.svid_3 = svid_3;
-    word_type_9.delta_root_a = delta_root_a;
-    word_type_9.eccentricity = concatenateBits(eccentricity_1, eccentricity_2, 4, 7);
-    word_type_9.perigee = perigee;
-    word_type_9.diff_ia_na = diff_ia_na;
+  else if (msg_type_ == UBX_NAV_SIG) 
+  {
+    if (msg_head.length < sizeof(payload_navsig_head))
+      return false;
 
+    readBytes(&payload_navsig_head, sizeof(payload_navsig_head));
 
-    nav_data[svId_-1].add(word_type_9, svId_, sigId_);
+    if (msg_head.length < sizeof(payload_navsig_head) + payload_navsig_head.numSigs * sizeof(payload_navsig))
+      return false;
 
+    for (int i = 0; i < payload_navsig_head.numSigs; i++) 
+    {
+      readBytes(&payload_navsig, sizeof(payload_navsig));
+      gnssCount(payload_navsig);
+    }
 
     return true;
+
   }
 
+  return false;
+}
 
-  else if (word_type_ == ALMANAC_4) // Word Type 10
-  {
-    unsigned issue_of_data = getBits(dword_1, 4);
-    signed longitude = getBits(dword_1, 16);
-    signed roc_ra_1 = getBits(dword_1, 4); // 7 left
 
+bool GalileoSolver::determineWordType(MessageDataWordHead &payload_data_word_head)
+{
+  switch (payload_data_word_head.word_type) 
+  {
+  case 0:
+    word_type_ = SPARE;
+    ++wordtype0_counter;
+    return true;
 
-    uint32_t dword_2 = getDataWord();
-    signed roc_ra_2 = getBits(dword_2, 7);
-    signed mean_anomaly = getBits(dword_2, 16);
-    signed clock_corr_bias_1 = getBits(dword_2, 9); // 7 left
+  case 1:
+    word_type_ = EPHEMERIS_1;
+    ++wordtype1_counter;
+    return true;
 
+  case 2:
+    word_type_ = EPHEMERIS_2;
+    ++wordtype2_counter;
+    return true;
 
-    uint32_t dword_3 = getDataWord();
-    signed clock_corr_bias_2 = getBits(dword_3, 7);
-    signed clock_corr_linear = getBits(dword_3, 13);
-    unsigned sig_health_e5b = getBits(dword_3, 2);
-    unsigned sig_health_e1 = getBits(dword_3, 2);
-    signed const_term_offset_1 = getBits(dword_3, 8); // 8 left
+  case 3:
+    word_type_ = EPHEMERIS_3;
+    ++wordtype3_counter;
+    return true;
 
+  case 4:
+    word_type_ = EPHEMERIS_4__CLOCK_CORRECTION;
+    ++wordtype4_counter;
+    return true;
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+  case 5:
+    word_type_ = IONOSPHERIC_CORRECTION__BGD__SIG_HEALTH__DVS__GST;
+    ++wordtype5_counter;
+    return true;
 
+  case 6:
+    word_type_ = GST_UTC_CONVERSION;
+    ++wordtype6_counter;
+    return true;
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+  case 7:
+    word_type_ = ALMANAC_1;
+    ++wordtype7_counter;
+    return true;
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+  case 8:
+    word_type_ = ALMANAC_2;
+    ++wordtype8_counter;
+    return true;
 
+  case 9:
+    word_type_ = ALMANAC_3;
+    ++wordtype9_counter;
+    return true;
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    signed const_term_offset_2 = getBits(dword_data, 8);
-    signed roc_offset = getBits(dword_data, 12);
-    unsigned ref_time = getBits(dword_data, 8);
-    unsigned week_num = getBits(dword_data, 6);
+  case 10:
+    word_type_ = ALMANAC_4;
+    ++wordtype10_counter;
+    return true;
 
+  case 16:
+    word_type_ = REDUCED_CED;
+    ++wordtype16_counter;
+    return true;
 
-    word_type_10.issue_of_data = issue_of_data;
-    word_type_10.longitude = longitude;
-    word_type_10.roc_ra = concatenateBits(roc_ra_1, roc_ra_2, 4, 7);
-    word_type_10.mean_anomaly = mean_anomaly;
-    word_type_10.clock_corr_bias = concatenateBits(clock_corr_bias_1, clock_corr_bias_2, 9, 7);
-    word_type_10.clock_corr_linear = clock_corr_linear;
-    word_type_10.sig_health_e5b = sig_health_e5b;
-    word_type_10.sig_health_e1 = sig_health_e1;
-    word_type_10.const_term_offset = concatenateBits(const_term_offset_1, const_term_offset_2, 8, 8);
-    word_type_10.roc_offset = roc_offset;
-    word_type_10.ref_time = ref_time;
-    word_type_10.week_num = week_num;
+  case 17:
+    word_type_ = FEC2;
+    ++wordtype17_counter;
+    return true;
 
+  case 18:
+    word_type_ = FEC2;
+    ++wordtype17_counter;
+    return true;
 
-    nav_data[svId_-1].add(word_type_10, svId_, sigId_);
+  case 19:
+    word_type_ = FEC2;
+    ++wordtype17_counter;
+    return true;
 
+  case 20:
+    word_type_ = FEC2;
+    ++wordtype17_counter;
+    return true;
 
+  case 63:
+    word_type_ = DUMMY;
+    ++wordtype63_counter;
     return true;
+
+  default:
+    warn();
+    false_counter++;
+    return false;
   }
+}
 
 
-  else if (word_type_ == REDUCED_CED) // Word Type 16
-  {
-    signed delta_rced_smajor = getBits(dword_1, 5);
-    signed eccentricity_rced_x = getBits(dword_1, 13);
-    signed eccentricity_rced_y_1 = getBits(dword_1, 6); // 7 left
+bool GalileoSolver::parseDataWord(const InavPage &page)
+{
+  if (word_type_ == DUMMY)
+    return true;
 
+  word_util.tail = page.tail();
+  word_util.even_odd = page.oddEvenOdd();
+  word_util.page_type = page.oddPageType();
 
-    uint32_t dword_2 = getDataWord();
-    signed eccentricity_rced_y_2 = getBits(dword_2, 7);
-    signed delta_rced_inclination = getBits(dword_2, 17);
-    signed rced_longitude_1 = getBits(dword_2, 8); // 15 left
+  if (!page.complete()) { false_counter++; return false; }
 
+  // Fields at the positions of their descriptors, see inav_fields.h.
+  // The ephemeris words go through the active field kernel
+  switch (word_type_)
+  {
+  case EPHEMERIS_1: // Word Type 1
+    decodeWord(page, word_type_1);
+    return true;
 
-    uint32_t dword_3 = getDataWord();
-    signed rced_longitude_2 = getBits(dword_3, 15);
-    signed lambda_rced_1 = getBits(dword_3, 17); // 6 left
+  case EPHEMERIS_2: // Word Type 2
+    decodeWord(page, word_type_2);
+    return true;
 
+  case EPHEMERIS_3: // Word Type 3
+    decodeWord(page, word_type_3);
+    return true;
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+  case EPHEMERIS_4__CLOCK_CORRECTION: // Word Type 4
+    decodeWord(page, word_type_4);
+    return true;
 
+  case IONOSPHERIC_CORRECTION__BGD__SIG_HEALTH__DVS__GST: // Word Type 5
+    decodeWord(page, word_type_5);
+    return true;
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+  case GST_UTC_CONVERSION: // Word Type 6
+    word_type_6.A0 = page.field<InavWord6::A0>();
+    word_type_6.A1 = page.field<InavWord6::A1>();
+    word_type_6.ls_count_before = page.field<InavWord6::ls_count_before>();
+    word_type_6.utc_reference_tow = page.field<InavWord6::utc_reference_tow>();
+    word_type_6.utc_reference_week = page.field<InavWord6::utc_reference_week>();
+    word_type_6.WN_lsf = page.field<InavWord6::WN_lsf>();
+    word_type_6.day_num = page.field<InavWord6::day_num>();
+    word_type_6.ls_count_after = page.field<InavWord6::ls_count_after>();
+    word_type_6.time_of_week = page.field<InavWord6::time_of_week>();
+    word_type_6.spare = page.field<InavWord6::spare>();
+    return true;
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+  case ALMANAC_1: // Word Type 7
+    word_type_7.issue_of_data = page.field<InavWord7::issue_of_data>();
+    word_type_7.week_num = page.field<InavWord7::week_num>();
+    word_type_7.ref_time = page.field<InavWord7::ref_time>();
+    word_type_7.svid_1 = page.field<InavWord7::svid_1>();
+    word_type_7.delta_root_a = page.field<InavWord7::delta_root_a>();
+    word_type_7.eccentricity = page.field<InavWord7::eccentricity>();
+    word_type_7.perigee = page.field<InavWord7::perigee>();
+    word_type_7.diff_ia_na = page.field<InavWord7::diff_ia_na>();
+    word_type_7.longitude = page.field<InavWord7::longitude>();
+    word_type_7.roc_ra = page.field<InavWord7::roc_ra>();
+    word_type_7.mean_anomaly = page.field<InavWord7::mean_anomaly>();
+    word_type_7.reserved = page.field<InavWord7::reserved>();
+    return true;
 
+  case ALMANAC_2: // Word Type 8
+    word_type_8.issue_of_data = page.field<InavWord8::issue_of_data>();
+    word_type_8.clock_corr_bias = page.field<InavWord8::clock_corr_bias>();
+    word_type_8.clock_corr_linear = page.field<InavWord8::clock_corr_linear>();
+    word_type_8.sig_health_e5b = page.field<InavWord8::sig_health_e5b>();
+    word_type_8.sig_health_e1 = page.field<InavWord8::sig_health_e1>();
+    word_type_8.svid_2 = page.field<InavWord8::svid_2>();
+    word_type_8.delta_root_a = page.field<InavWord8::delta_root_a>();
+    word_type_8.eccentricity = page.field<InavWord8::eccentricity>();
+    word_type_8.perigee = page.field<InavWord8::perigee>();
+    word_type_8.diff_ia_na = page.field<InavWord8::diff_ia_na>();
+    word_type_8.longitude = page.field<InavWord8::longitude>();
+    word_type_8.roc_ra = page.field<InavWord8::roc_ra>();
+    word_type_8.spare = page.field<InavWord8::spare>();
+    return true;
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    signed lambda_rced_2 = getBits(dword_data, 6);
-    signed rced_clock_corr_bias = getBits(dword_data, 22);
-    signed rced_clock_corr_drift = getBits(dword_data, 6);
+  case ALMANAC_3: // Word Type 9
+    word_type_9.issue_of_data = page.field<InavWord9::issue_of_data>();
+    word_type_9.week_num = page.field<InavWord9::week_num>();
+    word_type_9.ref_time = page.field<InavWord9::ref_time>();
+    word_type_9.mean_anomaly = page.field<InavWord9::mean_anomaly>();
+    word_type_9.clock_corr_bias = page.field<InavWord9::clock_corr_bias>();
+    word_type_9.clock_corr_linear = page.field<InavWord9::clock_corr_linear>();
+    word_type_9.sig_health_e5b = page.field<InavWord9::sig_health_e5b>();
+    word_type_9.sig_health_e1 = page.field<InavWord9::sig_health_e1>();
+    word_type_9.svid_3 = page.field<InavWord9::svid_3>();
+    word_type_9.delta_root_a = page.field<InavWord9::delta_root_a>();
+    word_type_9.eccentricity = page.field<InavWord9::eccentricity>();
+    word_type_9.perigee = page.field<InavWord9::perigee>();
+    word_type_9.diff_ia_na = page.field<InavWord9::diff_ia_na>();
+    return true;
 
+  case ALMANAC_4: // Word Type 10
+    word_type_10.issue_of_data = page.field<InavWord10::issue_of_data>();
+    word_type_10.longitude = page.field<InavWord10::longitude>();
+    word_type_10.roc_ra = page.field<InavWord10::roc_ra>();
+    word_type_10.mean_anomaly = page.field<InavWord10::mean_anomaly>();
+    word_type_10.clock_corr_bias = page.field<InavWord10::clock_corr_bias>();
+    word_type_10.clock_corr_linear = page.field<InavWord10::clock_corr_linear>();
+    word_type_10.sig_health_e5b = page.field<InavWord10::sig_health_e5b>();
+    word_type_10.sig_health_e1 = page.field<InavWord10::sig_health_e1>();
+    word_type_10.const_term_offset = page.field<InavWord10::const_term_offset>();
+    word_type_10.roc_offset = page.field<InavWord10::roc_offset>();
+    word_type_10.ref_time = page.field<InavWord10::ref_time>();
+    word_type_10.week_num = page.field<InavWord10::week_num>();
+    return true;
 
-    word_type_16.delta_rced_smajor = delta_rced_smajor;
-    word_type_16.eccentricity_rced_x = eccentricity_rced_x;
-    word_type_16.eccentricity_rced_y = concatenateBits(eccentricity_rced_y_1, eccentricity_rced_y_2, 6, 7);
-    word_type_16.delta_rced_inclination = delta_rced_inclination;
-    word_type_16.rced_longitude = concatenateBits(rced_longitude_1, rced_longitude_2, 8, 15);
-    word_type_16.lambda_rced = concatenateBits(lambda_rced_1, lambda_rced_2, 17, 6);
-    word_type_16.rced_clock_corr_bias = rced_clock_corr_bias;
-    word_type_16.rced_clock_corr_drift = rced_clock_corr_drift;
+  case REDUCED_CED: // Word Type 16
+    word_type_16.delta_rced_smajor = page.field<InavWord16::delta_rced_smajor>();
+    word_type_16.eccentricity_rced_x = page.field<InavWord16::eccentricity_rced_x>();
+    word_type_16.eccentricity_rced_y = page.field<InavWord16::eccentricity_rced_y>();
+    word_type_16.delta_rced_inclination = page.field<InavWord16::delta_rced_inclination>();
+    word_type_16.rced_longitude = page.field<InavWord16::rced_longitude>();
+    word_type_16.lambda_rced = page.field<InavWord16::lambda_rced>();
+    word_type_16.rced_clock_corr_bias = page.field<InavWord16::rced_clock_corr_bias>();
+    word_type_16.rced_clock_corr_drift = page.field<InavWord16::rced_clock_corr_drift>();
+    return true;
 
+  case FEC2: // Word Type 17, 18, 19, 20
+    word_type_17.fec2_1 = page.field<InavWord17::fec2_1>();
+    word_type_17.lsb = page.field<InavWord17::lsb>();
+    word_type_17.fec2_2 = page.field<InavWord17::fec2_2>();
+    word_type_17.fec2_3 = page.field<InavWord17::fec2_3>();
     return true;
-  }
 
+  case SPARE: // Word Type 0
+    word_type_0.time = page.field<InavWord0::time>();
+    word_type_0.spare = page.field<InavWord0::spare>();
+    word_type_0.spare2 = page.field<InavWord0::spare2>();
+    word_type_0.week_num = page.field<InavWord0::week_num>();
+    word_type_0.time_of_week = page.field<InavWord0::time_of_week>();
+    return true;
 
-  else if (word_type_ == FEC2) // Word Type 17, 18, 19, 20
-  {
-    unsigned fec2_1 = getBits(dword_1, 8);
-    unsigned lsb = getBits(dword_1, 2);
-    unsigned long long fec2_2_1 = getBits(dword_1, 14); // 50 left
+  default:
+    return false;
+  }
+}
 
 
-    uint32_t dword_2 = getDataWord();
-    unsigned long long fec2_2_2 = getBits(dword_2, 32); // 18 left
+void GalileoSolver::addWord()
+{
+  DecodedPage page;
+  page.kind = DecodedPage::PAGE;
+  page.word_type = word_type_;
+  page.svId = svId_;
+  page.sigId = sigId_;
 
+  switch (word_type_)
+  {
+  case EPHEMERIS_1:
+    page.word_type_1 = word_type_1;
+    break;
 
-    uint32_t dword_3 = getDataWord();
-    unsigned long long fec2_2_3 = getBits(dword_3, 18);
-    unsigned long long fec2_3_1 = getBits(dword_3, 14); // 34 left
+  case EPHEMERIS_2:
+    page.word_type_2 = word_type_2;
+    break;
 
+  case EPHEMERIS_3:
+    page.word_type_3 = word_type_3;
+    break;
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+  case EPHEMERIS_4__CLOCK_CORRECTION:
+    page.word_type_4 = word_type_4;
+    break;
 
+  case IONOSPHERIC_CORRECTION__BGD__SIG_HEALTH__DVS__GST:
+    page.word_type_5 = word_type_5;
+    break;
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+  case GST_UTC_CONVERSION:
+    page.word_type_6 = word_type_6;
+    break;
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+  case ALMANAC_4:
+    page.word_type_10 = word_type_10;
+    break;
 
+  default: // Kept for the page clock, the orbit store and the recovery of the words 1 to 4
+    break;
+  }
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    unsigned long long fec2_3_2 = getBits(dword_data, 34);
+  page.raw = page_;
 
-    fec2_2_2 = concatenateBits(fec2_2_2, fec2_2_3, 32, 18);
+  if (pages_ != nullptr)
+    pages_->push_back(page);
+  else
+    replayPage(page);
+}
 
-    word_type_17.fec2_1 = fec2_1;
-    word_type_17.lsb = lsb;
-    word_type_17.fec2_2 = concatenateBits(fec2_2_1, fec2_2_2, 14, 50);
-    word_type_17.fec2_3 = concatenateBits(fec2_3_1, fec2_3_2, 14, 34);
 
-    return true;
+void GalileoSolver::replayPage(const DecodedPage &page)
+{
+  if (page.kind == DecodedPage::WARNING)
+  {
+    warn();
+    return;
   }
 
-
-  else if (word_type_ == SPARE) // Word Type 0
+  if (page.kind == DecodedPage::CHECKSUM_FALSE)
   {
-    unsigned time = getBits(dword_1, 2);
-    unsigned long long spare_1 = getBits(dword_1, 22); // 42 left
-
-
-    uint32_t dword_2 = getDataWord();
-    unsigned long long spare_2 = getBits(dword_2, 32); // 10 left
+    *context_.console << "checksum false\n" << std::flush;
+    return;
+  }
 
+  NavigationData &data = nav_data[page.svId-1];
+  const uint32_t gst = context_.clock.stamp(page.raw, page.svId, page.sigId);
 
-    uint32_t dword_3 = getDataWord();
-    unsigned long long spare_3 = getBits(dword_3, 10);
-    unsigned spare2_1 = getBits(dword_3, 22); // 2 left
+  switch (page.word_type)
+  {
+  case EPHEMERIS_1:
+    data.add(page.word_type_1, page.svId, page.sigId);
+    break;
 
+  case EPHEMERIS_2:
+    data.add(page.word_type_2, page.svId, page.sigId);
+    break;
 
-    uint64_t dword_4 = getDataWord();
-    uint64_t dword_5 = getDataWord();
-    uint64_t dword_middle = concatenateBits(dword_4, dword_5, 32, 32);
+  case EPHEMERIS_3:
+    data.add(page.word_type_3, page.svId, page.sigId);
+    break;
 
+  case EPHEMERIS_4__CLOCK_CORRECTION:
+    data.add(page.word_type_4, page.svId, page.sigId);
+    break;
 
-    uint64_t dword_util = dword_middle;
-    maskWordUtilMiddle(dword_util);
-    word_util.tail = getBits(dword_util, 6);
-    word_util.even_odd = getBits(dword_util, 1);
-    word_util.page_type = getBits(dword_util, 1);
+  case IONOSPHERIC_CORRECTION__BGD__SIG_HEALTH__DVS__GST:
+    data.add(page.word_type_5, page.svId, page.sigId);
+    break;
 
-    if (word_util.tail != 0) { false_counter++; return false; }
-    if (even_ == 0) { if (word_util.even_odd != 1) { false_counter++; return false; } }
-    if (even_ == 1) { if (word_util.even_odd != 0) { false_counter++; return false; } }
+  case GST_UTC_CONVERSION:
+    data.add(page.word_type_6, page.svId, page.sigId);
+    break;
 
+  case ALMANAC_1:
+  case ALMANAC_2:
+  case ALMANAC_3:
+    if (const Almanac *almanac = context_.almanacs.add(page.raw, page.svId, page.sigId))
+      data.writeAlmanac(*almanac, page.sigId);
+    break;
 
-    uint64_t dword_data = dword_middle;
-    maskWordDataMiddle(dword_data);
-    unsigned spare2_2 = getBits(dword_data, 2);
-    unsigned week_num = getBits(dword_data, 12);
-    unsigned time_of_week = getBits(dword_data, 20);
+  case ALMANAC_4:
+    data.add(page.word_type_10, page.svId, page.sigId);
 
-    spare_2 = concatenateBits(spare_2, spare_3, 32, 10);
+    if (const Almanac *almanac = context_.almanacs.add(page.raw, page.svId, page.sigId))
+      data.writeAlmanac(*almanac, page.sigId);
+    break;
 
-    word_type_0.time = time;
-    word_type_0.spare = concatenateBits(spare_1, spare_2, 22, 42);
-    word_type_0.spare2 = concatenateBits(spare2_1, spare2_2, 22, 2);
-    word_type_0.week_num = week_num;
-    word_type_0.time_of_week = time_of_week;
+  case REDUCED_CED: // Its reference time is the start of its page
+    if (gst != GstClock::UNKNOWN)
+      context_.orbits.setReduced(page.svId, reducedOrbit(page.raw, gst));
+    break;
 
-    return true;
+  default:
+    break;
   }
 
-  else if (word_type_ == DUMMY) 
-    return true;
-
-  else 
-    return false;
-  
+  if (fec2_[page.svId-1].add(page.raw))
+    recoverWords(page.svId, page.sigId);
 }
 
 
-uint32_t GalileoSolver::getDataWord() 
+void GalileoSolver::recoverWords(uint8_t svId, uint8_t sigId)
 {
-  char *buffer = new char[4];
-  raw_data_.read(buffer, 4);
+  InavPage pages[4];
+  unsigned recovered = fec2_[svId-1].recover(pages);
 
-  uint32_t *dword_ref = reinterpret_cast<uint32_t *>(buffer);
-  uint32_t dword = *dword_ref;
+  if (recovered == 0)
+    return;
 
-  delete[] buffer;
+  NavigationData &data = nav_data[svId-1];
 
-  return dword;
-}
+  if (recovered & 1)
+  {
+    WordType1 word{};
+    decodeWord(pages[0], word);
+    data.add(word, svId, sigId);
+  }
 
+  if (recovered & 2)
+  {
+    WordType2 word{};
+    decodeWord(pages[1], word);
+    data.add(word, svId, sigId);
+  }
 
-void GalileoSolver::maskWordUtilMiddle(uint64_t &dword_util) 
-{
-  dword_util = dword_util & MASK1_;
-  dword_util = (dword_util << 18) | (dword_util << 26);
-}
+  if (recovered & 4)
+  {
+    WordType3 word{};
+    decodeWord(pages[2], word);
+    data.add(word, svId, sigId);
+  }
 
+  if (recovered & 8)
+  {
+    WordType4 word{};
+    decodeWord(pages[3], word);
+    data.add(word, svId, sigId);
+  }
 
-void GalileoSolver::maskWordDataMiddle(uint64_t &dword_data) 
-{
-  bitsize_ = 34;
-  pos_ = 0;
-  uint64_t dword_data1 = dword_data & MASK2_;
-  uint64_t dword_data2 = dword_data & MASK3_;
-  dword_data = (dword_data1) | (dword_data2 << 16);
+  fec2_counter += std::bitset<4>(recovered).count();
 }
 
 
@@ -1237,25 +1484,107 @@ void GalileoSolver::classifySvid()
 }
 
 
+void GalileoSolver::mergeCounters(const GalileoSolver &other)
+{
+  counter += other.counter;
+  true_counter += other.true_counter;
+  false_counter += other.false_counter;
+  skipped_counter += other.skipped_counter;
+  resync_counter += other.resync_counter;
+  crc_counter += other.crc_counter;
+
+  galileo_num_sfrbx_ += other.galileo_num_sfrbx_;
+  gps_num_sfrbx_ += other.gps_num_sfrbx_;
+  sbas_num_sfrbx_ += other.sbas_num_sfrbx_;
+  beidou_num_sfrbx_ += other.beidou_num_sfrbx_;
+  qzss_num_sfrbx_ += other.qzss_num_sfrbx_;
+  glonass_num_sfrbx_ += other.glonass_num_sfrbx_;
+
+  galileo_num_navsig_ += other.galileo_num_navsig_;
+  gps_num_navsig_ += other.gps_num_navsig_;
+  sbas_num_navsig_ += other.sbas_num_navsig_;
+  beidou_num_navsig_ += other.beidou_num_navsig_;
+  qzss_num_navsig_ += other.qzss_num_navsig_;
+  glonass_num_navsig_ += other.glonass_num_navsig_;
+
+  rxm_sfrbx_counter += other.rxm_sfrbx_counter;
+  nav_sig_counter += other.nav_sig_counter;
+
+  svid1_counter += other.svid1_counter;
+  svid2_counter += other.svid2_counter;
+  svid3_counter += other.svid3_counter;
+  svid4_counter += other.svid4_counter;
+  svid5_counter += other.svid5_counter;
+  svid6_counter += other.svid6_counter;
+  svid7_counter += other.svid7_counter;
+  svid8_counter += other.svid8_counter;
+  svid9_counter += other.svid9_counter;
+  svid10_counter += other.svid10_counter;
+  svid11_counter += other.svid11_counter;
+  svid12_counter += other.svid12_counter;
+  svid13_counter += other.svid13_counter;
+  svid14_counter += other.svid14_counter;
+  svid15_counter += other.svid15_counter;
+  svid16_counter += other.svid16_counter;
+  svid17_counter += other.svid17_counter;
+  svid18_counter += other.svid18_counter;
+  svid19_counter += other.svid19_counter;
+  svid20_counter += other.svid20_counter;
+  svid21_counter += other.svid21_counter;
+  svid22_counter += other.svid22_counter;
+  svid23_counter += other.svid23_counter;
+  svid24_counter += other.svid24_counter;
+  svid25_counter += other.svid25_counter;
+  svid26_counter += other.svid26_counter;
+  svid27_counter += other.svid27_counter;
+  svid28_counter += other.svid28_counter;
+  svid29_counter += other.svid29_counter;
+  svid30_counter += other.svid30_counter;
+  svid31_counter += other.svid31_counter;
+  svid32_counter += other.svid32_counter;
+  svid33_counter += other.svid33_counter;
+  svid34_counter += other.svid34_counter;
+  svid35_counter += other.svid35_counter;
+  svid36_counter += other.svid36_counter;
+
+  wordtype0_counter += other.wordtype0_counter;
+  wordtype1_counter += other.wordtype1_counter;
+  wordtype2_counter += other.wordtype2_counter;
+  wordtype3_counter += other.wordtype3_counter;
+  wordtype4_counter += other.wordtype4_counter;
+  wordtype5_counter += other.wordtype5_counter;
+  wordtype6_counter += other.wordtype6_counter;
+  wordtype7_counter += other.wordtype7_counter;
+  wordtype8_counter += other.wordtype8_counter;
+  wordtype9_counter += other.wordtype9_counter;
+  wordtype10_counter += other.wordtype10_counter;
+  wordtype16_counter += other.wordtype16_counter;
+  wordtype17_counter += other.wordtype17_counter;
+  wordtype63_counter += other.wordtype63_counter;
+}
+
+
 void GalileoSolver::log() const 
 {
-  std::cout << "UBX-RXM-SFRBX: " << rxm_sfrbx_counter << std::endl;
-  std::cout << "\nGalileo: " << galileo_num_sfrbx_
+  std::ostringstream console; // Handed to the console in one piece
+
+  console << "UBX-RXM-SFRBX: " << rxm_sfrbx_counter << std::endl;
+  console << "\nGalileo: " << galileo_num_sfrbx_
             << "\nGPS: " << gps_num_sfrbx_
             << "\nGLONASS: " << glonass_num_sfrbx_
             << "\nBeidou: " << beidou_num_sfrbx_
             << "\nQZSS: " << qzss_num_sfrbx_ << "\nSBAS: " << sbas_num_sfrbx_
             << std::endl;
 
-  std::cout << "\nUBX-NAV-SIG: " << nav_sig_counter << std::endl;
-  std::cout << "\nGalileo: " << galileo_num_navsig_
+  console << "\nUBX-NAV-SIG: " << nav_sig_counter << std::endl;
+  console << "\nGalileo: " << galileo_num_navsig_
             << "\nGPS: " << gps_num_navsig_
             << "\nGLONASS: " << glonass_num_navsig_
             << "\nBeidou: " << beidou_num_navsig_
             << "\nQZSS: " << qzss_num_navsig_ << "\nSBAS: " << sbas_num_navsig_
             << std::endl;
 
-  std::cout << "\nSVID 1: " << svid1_counter
+  console << "\nSVID 1: " << svid1_counter
             << "\nSVID 2: " << svid2_counter
             << "\nSVID 3: " << svid3_counter
             << "\nSVID 4: " << svid4_counter
@@ -1294,7 +1623,7 @@ void GalileoSolver::log() const
             << std::endl;
 
   
-  std::cout << "\nWord Type 0: " << wordtype0_counter
+  console << "\nWord Type 0: " << wordtype0_counter
             << "\nWord Type 1: " << wordtype1_counter
             << "\nWord Type 2: " << wordtype2_counter
             << "\nWord Type 3: " << wordtype3_counter
@@ -1311,30 +1640,143 @@ void GalileoSolver::log() const
             << std::endl;
 
 
-  std::cout << "\nCounter: " << counter << std::endl;
-  std::cout << "True: " << true_counter << std::endl;
-  std::cout << "False: " << false_counter << std::endl;
+  console << "\nCounter: " << counter << std::endl;
+  console << "True: " << true_counter << std::endl;
+  console << "False: " << false_counter << std::endl;
+  console << "CRC failed: " << crc_counter << std::endl;
+  console << "FEC2 recovered: " << fec2_counter << std::endl;
+
+  console << "\nSkipped frames: " << skipped_counter << std::endl;
+  console << "Resync: " << resync_counter << std::endl;
+
+  *context_.console << console.str() << std::flush;
+}
+
+
+void GalileoSolver::warn() const 
+{ 
+  if (pages_ != nullptr)
+  {
+    DecodedPage message;
+    message.kind = DecodedPage::WARNING;
+    pages_->push_back(message);
+  }
+  else
+    *context_.console << "WARNING!!!\n" << std::flush; 
+}
+
+
+bool GalileoSolver::saveCheckpoint(const std::string &path, CheckpointHead head) const
+{
+  const std::string part = path + ".part";
+
+  head.magic = CHECKPOINT_MAGIC;
+  head.version = CHECKPOINT_VERSION;
+  head.nav_data_size = sizeof(NavigationData);
+  head.flags[0] = context_.flag1_;
+  head.flags[1] = context_.flag2_;
+  head.flags[2] = context_.flag3_;
+  head.flags[3] = context_.flag4_;
+
+  {
+    std::ofstream file(part, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&head), sizeof(head));
+
+    for (const NavigationData &data : nav_data)
+      data.save(file);
+
+    context_.clock.save(file);
+
+    for (const Fec2Recovery &recovery : fec2_)
+      recovery.save(file);
+
+    if (!file.flush())
+    {
+      std::remove(part.c_str());
+      return false;
+    }
+  }
+
+  return std::rename(part.c_str(), path.c_str()) == 0;
 }
 
 
-void GalileoSolver::warn() const { std::cout << "WARNING!!!" << std::endl; }
+bool GalileoSolver::loadCheckpoint(const std::string &path, CheckpointHead &head)
+{
+  std::ifstream file(path, std::ios::binary);
+  CheckpointHead saved;
+
+  if (!file.read(reinterpret_cast<char *>(&saved), sizeof(saved)))
+    return false;
+
+  if (saved.magic != CHECKPOINT_MAGIC || saved.version != CHECKPOINT_VERSION ||
+      saved.nav_data_size != sizeof(NavigationData) || saved.device != head.device || saved.inode != head.inode)
+    return false;
+
+  // Read aside first, a short checkpoint leaves the batches untouched
+  std::vector<NavigationData> batches(36);
+
+  for (NavigationData &data : batches)
+    if (!data.load(file))
+      return false;
+
+  // Without the page clocks, the pages up to the next time word would have no time
+  GstClock clock;
+
+  if (!clock.load(file))
+    return false;
+
+  // The words collected before the stop still rebuild the lost ones
+  Fec2Recovery fec2[36];
+
+  for (Fec2Recovery &recovery : fec2)
+    if (!recovery.load(file))
+      return false;
+
+  for (int i=0; i<36; i++)
+  {
+    batches[i].setContext(&context_);
+    nav_data[i] = batches[i];
+    fec2_[i] = fec2[i];
+  }
+
+  context_.flag1_ = saved.flags[0];
+  context_.flag2_ = saved.flags[1];
+  context_.flag3_ = saved.flags[2];
+  context_.flag4_ = saved.flags[3];
+  context_.clock = clock;
 
+  head.offset = saved.offset;
 
-std::ofstream nav_data_file_("../data/output_navdata.txt");
+  return true;
+}
+
+
+void NavigationContext::flush()
+{
+  if (console_text.tellp() > 0)
+  {
+    *console << console_text.str() << std::flush;
+    console_text.str("");
+  }
 
+  if (nav_data_text.tellp() > 0)
+  {
+    *nav_data_file << nav_data_text.str();
+    nav_data_text.str("");
 
-bool NavigationData::flag1_ = false;
-bool NavigationData::flag2_ = false;
-bool NavigationData::flag3_ = false;
-bool NavigationData::flag4_ = false;
+    if (live)
+      nav_data_file->flush();
+  }
+}
 
 
 void NavigationData::checkFull() 
 {
-  if (flag1_ && flag2_ && flag3_ && !flag4_) 
+  if (context_->flag1_ && context_->flag2_ && context_->flag3_ && !context_->flag4_) 
   {
     writeHeader();
-    flag4_ = true;
+    context_->flag4_ = true;
   }
 
   if (clock_bias_ != INIT && clock_drift_ != INIT && clock_drift_rate_ != INIT && issue_of_data_ != INIT &&
@@ -1345,11 +1787,43 @@ void NavigationData::checkFull()
       sisa_ != INIT && bgd1_ != INIT && bgd2_ != INIT) 
   {
     if (prev_toe_ != ref_time_) { write(); prev_toe_ = ref_time_; }
+    context_->orbits.setEphemeris(svId_, orbit());
     reset();
   }
 }
 
 
+KeplerOrbit NavigationData::orbit() const
+{
+  // The week of the ephemeris in the rollover period of the receiver time
+  const double week_start = GstClock::fromWeek(week_num_, 0, context_->clock.now());
+
+  KeplerOrbit orbit;
+  orbit.root_semi_major_axis = semi_major_root_;
+  orbit.delta_n = delta_n_;
+  orbit.mean_anomaly = mean_anomaly_;
+  orbit.eccentricity = eccentricity_;
+  orbit.perigee = omega_;
+  orbit.inclination = inclination_angle_;
+  orbit.inclination_rate = roc_inclination_angle_;
+  orbit.longitude = omega0_;
+  orbit.longitude_rate = omega_dot_;
+  orbit.cuc = cuc_;
+  orbit.cus = cus_;
+  orbit.crc = crc_;
+  orbit.crs = crs_;
+  orbit.cic = cic_;
+  orbit.cis = cis_;
+  orbit.toe = week_start + ref_time_;
+  orbit.toc = week_start + epoch_;
+  orbit.af0 = clock_bias_;
+  orbit.af1 = clock_drift_;
+  orbit.af2 = clock_drift_rate_;
+
+  return orbit;
+}
+
+
 void NavigationData::reset() 
 {
   svId_ = 0;
@@ -1382,163 +1856,185 @@ void NavigationData::reset()
 }
 
 
-void NavigationData::resetAlmanacE5()
+NavigationData::Staging &NavigationData::stage(unsigned issue_of_data)
 {
-  alm_e5_issue_of_data_ = INIT;
-  alm_e5_week_num_ = 0;
-  alm_e5_ref_time_ = 0;
-  alm_e5_svid_ = 0;
-  alm_e5_delta_root_a_ = INIT;
-  alm_e5_eccentricity_ = INIT;
-  alm_e5_perigee_ = INIT;
-  alm_e5_diff_ia_na_ = INIT;
-  alm_e5_longitude_ = INIT;
-  alm_e5_roc_ra_ = INIT;
-  alm_e5_mean_anomaly_ = INIT;
-  alm_e5_clock_corr_bias_ = INIT;
-  alm_e5_clock_corr_linear_ = INIT;
-  alm_e5_sig_health_e5b_ = 0;
-  alm_e5_sig_health_e1_ = 0;
+  for (Staging &slot : staging_)
+    if (slot.words != 0 && slot.issue_of_data == issue_of_data)
+      return slot;
+
+  // Free slots count as the oldest
+  Staging *slot = &staging_[0];
+
+  for (Staging &candidate : staging_)
+    if ((candidate.words == 0 ? 0 : candidate.age) < (slot->words == 0 ? 0 : slot->age))
+      slot = &candidate;
+
+  *slot = Staging();
+  slot->issue_of_data = issue_of_data;
+  slot->age = ++staged_;
+
+  return *slot;
 }
 
 
-void NavigationData::resetAlmanacE1()
+void NavigationData::arrive(Staging &slot, unsigned word_type)
 {
-  alm_e1_issue_of_data_ = INIT;
-  alm_e1_week_num_ = 0;
-  alm_e1_ref_time_ = 0;
-  alm_e1_svid_ = 0;
-  alm_e1_delta_root_a_ = INIT;
-  alm_e1_eccentricity_ = INIT;
-  alm_e1_perigee_ = INIT;
-  alm_e1_diff_ia_na_ = INIT;
-  alm_e1_longitude_ = INIT;
-  alm_e1_roc_ra_ = INIT;
-  alm_e1_mean_anomaly_ = INIT;
-  alm_e1_clock_corr_bias_ = INIT;
-  alm_e1_clock_corr_linear_ = INIT;
-  alm_e1_sig_health_e5b_ = 0;
-  alm_e1_sig_health_e1_ = 0;
+  slot.words |= 1u << (word_type - 1);
+
+  if (slot.words != ALL_WORDS)
+    return;
+
+  svId_ = slot.svId;
+  issue_of_data_ = slot.issue_of_data;
+  ref_time_ = slot.ref_time;
+  mean_anomaly_ = slot.mean_anomaly;
+  eccentricity_ = slot.eccentricity;
+  semi_major_root_ = slot.semi_major_root;
+  omega0_ = slot.omega0;
+  inclination_angle_ = slot.inclination_angle;
+  omega_ = slot.omega;
+  roc_inclination_angle_ = slot.roc_inclination_angle;
+  omega_dot_ = slot.omega_dot;
+  delta_n_ = slot.delta_n;
+  cuc_ = slot.cuc;
+  cus_ = slot.cus;
+  crc_ = slot.crc;
+  crs_ = slot.crs;
+  sisa_ = slot.sisa;
+  cic_ = slot.cic;
+  cis_ = slot.cis;
+  epoch_ = slot.epoch;
+  clock_bias_ = slot.clock_bias;
+  clock_drift_ = slot.clock_drift;
+  clock_drift_rate_ = slot.clock_drift_rate;
+
+  slot = Staging();
 }
 
 
 void NavigationData::write() 
 {
-  std::cout.precision(12);
+  std::ostream &console = context_->console_text;
+  std::ostream &nav_data_file = context_->nav_data_text;
+
+  console.precision(12);
 
-  std::cout << "\nE" << svId_ << std::fixed << "\t" << epoch_ << " " << (int)floor((epoch_ % 86400) / 3600) << " " << ((epoch_ % 3600) % 3600) / 60 
+  console << "\nE" << svId_ << std::fixed << "\t" << epoch_ << " " << (int)floor((epoch_ % 86400) / 3600) << " " << ((epoch_ % 3600) % 3600) / 60 
             << std::scientific << "\t" << clock_bias_  << "\t" << clock_drift_ << "\t" << clock_drift_rate_ << "\n";
 
-  std::cout << "  \t" << issue_of_data_ << "\t" << crs_ 
+  console << "  \t" << issue_of_data_ << "\t" << crs_ 
                  << "\t" << delta_n_ << "\t" << mean_anomaly_ << "\n";
 
-  std::cout << "  \t" << cuc_ << "\t" << eccentricity_ 
+  console << "  \t" << cuc_ << "\t" << eccentricity_ 
                  << "\t" << cus_ << "\t" << semi_major_root_ << "\n";
 
-  std::cout << "  \t" << ref_time_ << "\t" << cic_ 
+  console << "  \t" << ref_time_ << "\t" << cic_ 
                  << "\t" << omega0_ << "\t" << cis_ << "\n";
 
-  std::cout << "  \t" << inclination_angle_ << "\t" << crc_ 
+  console << "  \t" << inclination_angle_ << "\t" << crc_ 
                  << "\t" << omega_ << "\t" << omega_dot_ << "\n";
             
-  std::cout << "  \t" << roc_inclination_angle_ << "\t" << "\t"
+  console << "  \t" << roc_inclination_angle_ << "\t" << "\t"
                  << "  \t" << week_num_ << "\t" << double(0) << "\n";
 
-  std::cout << "  \t" << sisa_ << "\t" << sig_health_validity_
+  console << "  \t" << sisa_ << "\t" << sig_health_validity_
                  << "\t" << bgd1_ << "\t" << bgd2_ << "\n";  
 
   //usleep(500000);
 
-  nav_data_file_ << "\nE" << svId_ << std::fixed << "\t" << epoch_ << " " << (int)floor((epoch_ % 86400) / 3600) << " " << ((epoch_ % 3600) % 3600) / 60 << "\t" 
+  nav_data_file << "\nE" << svId_ << std::fixed << "\t" << epoch_ << " " << (int)floor((epoch_ % 86400) / 3600) << " " << ((epoch_ % 3600) % 3600) / 60 << "\t" 
                  << std::scientific << std::setprecision(12) << clock_bias_ << "\t" << clock_drift_ << "\t" << clock_drift_rate_ << "\n";
 
-  nav_data_file_ << "  \t" << issue_of_data_ << "\t" << crs_ 
+  nav_data_file << "  \t" << issue_of_data_ << "\t" << crs_ 
                  << "\t" << delta_n_ << "\t" << mean_anomaly_ << "\n";
 
-  nav_data_file_ << "  \t" << cuc_ << "\t" << eccentricity_ 
+  nav_data_file << "  \t" << cuc_ << "\t" << eccentricity_ 
                  << "\t" << cus_ << "\t" << semi_major_root_ << "\n";
 
-  nav_data_file_ << "  \t" << ref_time_ << "\t" << cic_ 
+  nav_data_file << "  \t" << ref_time_ << "\t" << cic_ 
                  << "\t" << omega0_ << "\t" << cis_ << "\n";
 
-  nav_data_file_ << "  \t" << inclination_angle_ << "\t" << crc_ 
+  nav_data_file << "  \t" << inclination_angle_ << "\t" << crc_ 
                  << "\t" << omega_ << "\t" << omega_dot_ << "\n";
             
-  nav_data_file_ << "  \t" << roc_inclination_angle_ << "\t" << "\t"
+  nav_data_file << "  \t" << roc_inclination_angle_ << "\t" << "\t"
                  << "  \t" << week_num_ << "\t" << double(0) << "\n";
 
-  nav_data_file_ << "  \t" << sisa_ << "\t" << sig_health_validity_
+  nav_data_file << "  \t" << sisa_ << "\t" << sig_health_validity_
                  << "\t" << bgd1_ << "\t" << bgd2_ << "\n";
 
+  context_->flush();
 }
 
 
 void NavigationData::writeHeader() 
 {
-  nav_data_file_ << "\n\n";
-  nav_data_file_ << "\t\tHEADER\n";
-  nav_data_file_ << "GAL\t" << gal_ai0_ << "\t" << gal_ai1_ << "\t" << gal_ai2_ << "\tIONOSPHERIC CORR\n";
-  nav_data_file_ << "GAUT\t" << gaut_a0_ << "\t" << gaut_a1_ << "\t" << gaut_tow_ << "\t" << gaut_week_ << "\tTIME SYSTEM CORR\n";
-  nav_data_file_ << "GPGA\t" << gpga_a0g_ << "\t" << gpga_a1g_ << "\t" << gpga_tow_ << "\t" << gpga_week_ << "\tTIME SYSTEM CORR\n\n";
+  std::ostream &console = context_->console_text;
+  std::ostream &nav_data_file = context_->nav_data_text;
+
+  nav_data_file << "\n\n";
+  nav_data_file << "\t\tHEADER\n";
+  nav_data_file << "GAL\t" << gal_ai0_ << "\t" << gal_ai1_ << "\t" << gal_ai2_ << "\tIONOSPHERIC CORR\n";
+  nav_data_file << "GAUT\t" << gaut_a0_ << "\t" << gaut_a1_ << "\t" << gaut_tow_ << "\t" << gaut_week_ << "\tTIME SYSTEM CORR\n";
+  nav_data_file << "GPGA\t" << gpga_a0g_ << "\t" << gpga_a1g_ << "\t" << gpga_tow_ << "\t" << gpga_week_ << "\tTIME SYSTEM CORR\n\n";
+
+  console.precision(12);
 
-  std::cout.precision(12);
+  console << "\n\n";
+  console << "\t\tHEADER\n";
+  console << "GAL\t" << std::scientific << gal_ai0_ << "\t" << gal_ai1_ << "\t" << gal_ai2_ << "\tIONOSPHERIC CORR\n";
+  console << "GAUT\t" << gaut_a0_ << "\t" << gaut_a1_ << "\t" << std::fixed << gaut_tow_ << "\t" << gaut_week_ << "\tTIME SYSTEM CORR\n";
+  console << "GPGA\t" << std::scientific << gpga_a0g_ << "\t" << gpga_a1g_ << "\t" << std::fixed << gpga_tow_ << "\t" << gpga_week_ << "\tTIME SYSTEM CORR\n\n";
 
-  std::cout << "\n\n";
-  std::cout << "\t\tHEADER\n";
-  std::cout << "GAL\t" << std::scientific << gal_ai0_ << "\t" << gal_ai1_ << "\t" << gal_ai2_ << "\tIONOSPHERIC CORR\n";
-  std::cout << "GAUT\t" << gaut_a0_ << "\t" << gaut_a1_ << "\t" << std::fixed << gaut_tow_ << "\t" << gaut_week_ << "\tTIME SYSTEM CORR\n";
-  std::cout << "GPGA\t" << std::scientific << gpga_a0g_ << "\t" << gpga_a1g_ << "\t" << std::fixed << gpga_tow_ << "\t" << gpga_week_ << "\tTIME SYSTEM CORR\n\n";
+  context_->flush();
 
   //std::cin.get();
 }
 
 
-void NavigationData::writeAlmanac(uint8_t sigId)
+void NavigationData::writeAlmanac(const Almanac &almanac, uint8_t sigId)
 {
-  if (sigId == 5)
-  {
-    std::cout << "Signal: " << (unsigned int)sigId << std::endl;
-
-    std::cout << "SV ID: " << alm_e5_svid_ << std::endl;
-    std::cout << "Issue of data: " << alm_e5_issue_of_data_ << std::endl;
-    std::cout << "Week Num: " << alm_e5_week_num_ << std::endl;
-    std::cout << "TOW: " << alm_e5_ref_time_ << std::endl;
-    std::cout << "Delta root a: " << alm_e5_delta_root_a_ << std::endl;
-    std::cout << "Eccentricity: " << alm_e5_eccentricity_ << std::endl;
-    std::cout << "Perigee: " << alm_e5_perigee_ << std::endl;
-    std::cout << "Diff IA NA: " << alm_e5_diff_ia_na_ << std::endl;
-    std::cout << "Longitude: " << alm_e5_longitude_ << std::endl;
-    std::cout << "Roc Ra: " << alm_e5_roc_ra_ << std::endl;
-    std::cout << "Mean Anomaly: " << alm_e5_mean_anomaly_ << std::endl;
-    std::cout << "Clock Corr Bias: " << alm_e5_clock_corr_bias_ << std::endl;
-    std::cout << "Clock COrr Linear: " << alm_e5_clock_corr_linear_ << std::endl;
-    std::cout << "Sig health e5b: " << alm_e5_sig_health_e5b_ << std::endl;
-    std::cout << "Sig health e1: " << alm_e5_sig_health_e1_ << std::endl;
-    std::cout << "\n\n\n";
-  }
+  std::ostream &console = context_->console_text;
+
+  console << "Signal: " << (unsigned int)sigId << std::endl;
+
+  console << "SV ID: " << almanac.svid << std::endl;
+  console << "Issue of data: " << (double)almanac.issue_of_data << std::endl;
+  console << "Week Num: " << almanac.week_num << std::endl;
+  console << "TOW: " << almanac.ref_time << std::endl;
+  console << "Delta root a: " << almanac.delta_root_a << std::endl;
+  console << "Eccentricity: " << almanac.eccentricity << std::endl;
+  console << "Perigee: " << almanac.perigee << std::endl;
+  console << "Diff IA NA: " << almanac.diff_ia_na << std::endl;
+  console << "Longitude: " << almanac.longitude << std::endl;
+  console << "Roc Ra: " << almanac.roc_ra << std::endl;
+  console << "Mean Anomaly: " << almanac.mean_anomaly << std::endl;
+  console << "Clock Corr Bias: " << almanac.clock_corr_bias << std::endl;
+  console << "Clock COrr Linear: " << almanac.clock_corr_linear << std::endl;
+  console << "Sig health e5b: " << almanac.sig_health_e5b << std::endl;
+  console << "Sig health e1: " << almanac.sig_health_e1 << std::endl;
+  console << "\n\n\n";
+
+  context_->flush();
+}
 
-  else if (sigId == 1)
-  {
-    std::cout << "Signal: " << (unsigned int)sigId << std::endl;
-
-    std::cout << "SV ID: " << alm_e1_svid_ << std::endl;
-    std::cout << "Issue of data: " << alm_e1_issue_of_data_ << std::endl;
-    std::cout << "Week Num: " << alm_e1_week_num_ << std::endl;
-    std::cout << "TOW: " << alm_e1_ref_time_ << std::endl;
-    std::cout << "Delta root a: " << alm_e1_delta_root_a_ << std::endl;
-    std::cout << "Eccentricity: " << alm_e1_eccentricity_ << std::endl;
-    std::cout << "Perigee: " << alm_e1_perigee_ << std::endl;
-    std::cout << "Diff IA NA: " << alm_e1_diff_ia_na_ << std::endl;
-    std::cout << "Longitude: " << alm_e1_longitude_ << std::endl;
-    std::cout << "Roc Ra: " << alm_e1_roc_ra_ << std::endl;
-    std::cout << "Mean Anomaly: " << alm_e1_mean_anomaly_ << std::endl;
-    std::cout << "Clock Corr Bias: " << alm_e1_clock_corr_bias_ << std::endl;
-    std::cout << "Clock COrr Linear: " << alm_e1_clock_corr_linear_ << std::endl;
-    std::cout << "Sig health e5b: " << alm_e1_sig_health_e5b_ << std::endl;
-    std::cout << "Sig health e1: " << alm_e1_sig_health_e1_ << std::endl;
-    std::cout << "\n\n\n";
-  }
 
-  // std::cin.get();
-  
+void NavigationData::save(std::ostream &out) const
+{
+  static_assert(std::is_trivially_copyable<NavigationData>::value, "NavigationData is saved byte by byte");
+
+  out.write(reinterpret_cast<const char *>(this), sizeof(*this));
+}
+
+
+bool NavigationData::load(std::istream &in)
+{
+  NavigationContext *context = context_;
+
+  if (!in.read(reinterpret_cast<char *>(this), sizeof(*this)))
+    return false;
+
+  context_ = context;
+
+  return true;
 }
\ No newline at end of file
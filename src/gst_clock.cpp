@@ -0,0 +1,166 @@
+#include "gst_clock.h"
+#include <cmath>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+
+namespace
+{
+
+const double DAY = 86400;
+
+} // namespace
+
+
+uint32_t GstClock::fromWeek(uint32_t week_num, uint32_t time_of_week, uint32_t reference)
+{
+  const int64_t week = (reference != UNKNOWN) ? nearestWeek(week_num, 12, reference / GST_WEEK) : week_num;
+
+  return static_cast<uint32_t>(week * GST_WEEK + time_of_week);
+}
+
+
+uint32_t GstClock::fromTimeOfWeek(uint32_t reference, uint32_t time_of_week)
+{
+  uint32_t week = reference / GST_WEEK;
+
+  // The time of week wrapped into the next week
+  if (time_of_week + GST_WEEK / 2 < reference % GST_WEEK)
+    week++;
+
+  return week * GST_WEEK + time_of_week;
+}
+
+
+uint32_t GstClock::stamp(const InavPage &page, unsigned svId, unsigned sigId)
+{
+  if (svId < 1 || svId > 36)
+    return UNKNOWN;
+
+  uint32_t &gst = pages_[svId - 1][sigId >= 5];
+
+  // Pages lost in between leave the clock behind until the next time word
+  if (gst != UNKNOWN)
+    gst += 2;
+
+  // The time of week of the time words is the start of their page
+  switch (page.wordType())
+  {
+  case 0:
+    if (page.field<InavWord0::time>() == 2 && page.field<InavWord0::time_of_week>() < GST_WEEK)
+      gst = fromWeek(page.field<InavWord0::week_num>(), page.field<InavWord0::time_of_week>(), latest_);
+    break;
+
+  case 5:
+    if (page.field<InavWord5::time_of_week>() < GST_WEEK)
+      gst = fromWeek(page.field<InavWord5::week_num>(), page.field<InavWord5::time_of_week>(), latest_);
+    break;
+
+  case 6:
+    if (gst != UNKNOWN && page.field<InavWord6::time_of_week>() < GST_WEEK)
+      gst = fromTimeOfWeek(gst, page.field<InavWord6::time_of_week>());
+
+    utc_.a0 = scaleField<InavWord6::A0>(page.field<InavWord6::A0>());
+    utc_.a1 = scaleField<InavWord6::A1>(page.field<InavWord6::A1>());
+    utc_.ls_count_before = static_cast<int>(page.field<InavWord6::ls_count_before>());
+    utc_.ref_time = scaleField<InavWord6::utc_reference_tow>(page.field<InavWord6::utc_reference_tow>());
+    utc_.ref_week = page.field<InavWord6::utc_reference_week>();
+    utc_.leap_week = page.field<InavWord6::WN_lsf>();
+    utc_.leap_day = page.field<InavWord6::day_num>();
+    utc_.ls_count_after = static_cast<int>(page.field<InavWord6::ls_count_after>());
+    has_utc_ = true;
+    break;
+
+  case 10:
+    ggto_.a0g = scaleField<InavWord10::const_term_offset>(page.field<InavWord10::const_term_offset>());
+    ggto_.a1g = scaleField<InavWord10::roc_offset>(page.field<InavWord10::roc_offset>());
+    ggto_.ref_time = scaleField<InavWord10::ref_time>(page.field<InavWord10::ref_time>());
+    ggto_.ref_week = page.field<InavWord10::week_num>();
+    has_ggto_ = true;
+    break;
+
+  default:
+    break;
+  }
+
+  if (gst > latest_)
+    latest_ = gst;
+
+  return gst;
+}
+
+
+double GstClock::utcOffset(double gst) const
+{
+  if (!has_utc_)
+    return leapSeconds(gst);
+
+  const int64_t week = static_cast<int64_t>(std::floor(gst / GST_WEEK));
+  const double reference = nearestWeek(utc_.ref_week, 8, week) * double(GST_WEEK) + utc_.ref_time;
+
+  // The leap second is at the end of the day DN in UTC
+  const double leap = nearestWeek(utc_.leap_week, 8, week) * double(GST_WEEK) + utc_.leap_day * DAY + utc_.ls_count_before;
+  const int count = (gst >= leap) ? utc_.ls_count_after : utc_.ls_count_before;
+
+  return count + utc_.a0 + utc_.a1 * (gst - reference);
+}
+
+
+double GstClock::gpsOffset(double gst) const
+{
+  if (!has_ggto_)
+    return 0;
+
+  const int64_t week = static_cast<int64_t>(std::floor(gst / GST_WEEK));
+  const double reference = nearestWeek(ggto_.ref_week, 6, week) * double(GST_WEEK) + ggto_.ref_time;
+
+  return ggto_.a0g + ggto_.a1g * (gst - reference);
+}
+
+
+double GstClock::toUtc(double gst) const
+{
+  return gst - utcOffset(gst);
+}
+
+
+double GstClock::fromUtc(double utc) const
+{
+  // The offset changes by far less than a second over the offset itself, but the leap second can be in between
+  return utc + utcOffset(utc + utcOffset(utc));
+}
+
+
+double GstClock::toGps(double gst) const
+{
+  return gst + double(GST_GPS_WEEK_OFFSET) * GST_WEEK - gpsOffset(gst);
+}
+
+
+double GstClock::fromGps(double gps) const
+{
+  const double gst = gps - double(GST_GPS_WEEK_OFFSET) * GST_WEEK;
+
+  return gst + gpsOffset(gst);
+}
+
+
+void GstClock::clear()
+{
+  *this = GstClock();
+}
+
+
+void GstClock::save(std::ostream &out) const
+{
+  static_assert(std::is_trivially_copyable<GstClock>::value, "GstClock is saved byte by byte");
+
+  out.write(reinterpret_cast<const char *>(this), sizeof(*this));
+}
+
+
+bool GstClock::load(std::istream &in)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(this), sizeof(*this)));
+}
@@ -0,0 +1,207 @@
+#include "inav_crc.h"
+#include "cpu_features.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define GALILEO_X86 1
+#endif
+
+
+namespace
+{
+
+const uint32_t CRC24Q_POLY = 0x1864cfb; // With the x^24 term
+
+
+/**
+ * @brief Tables of the slicing-by-8 kernel. table[k][b] is the register
+ *        after the byte b was shifted in, followed by k zero bytes
+ *
+ */
+struct CrcTables
+{
+  uint32_t table[8][256];
+
+  constexpr CrcTables() : table()
+  {
+    for (uint32_t b = 0; b < 256; b++)
+    {
+      uint32_t crc = b << 16;
+
+      for (int i = 0; i < 8; i++)
+        crc = (crc & 0x800000) ? (crc << 1) ^ CRC24Q_POLY : crc << 1;
+
+      table[0][b] = crc & 0xffffff;
+    }
+
+    for (int k = 1; k < 8; k++)
+      for (uint32_t b = 0; b < 256; b++)
+        table[k][b] = ((table[k - 1][b] << 8) & 0xffffff) ^ table[0][table[k - 1][b] >> 16];
+  }
+};
+
+constexpr CrcTables CRC_TABLES;
+
+
+/*
+ * The 196 bits of the CRC as a 256 bit number in four 64 bit parts,
+ * most significant first. The leading zero bits leave the CRC as it is.
+ *   even half: words 0, 1, 2 and bits 31..14 of word 3
+ *   odd half: words 4, 5 and bits 31..14 of word 6
+ */
+inline void messageParts(const uint32_t *words, uint64_t (&parts)[4])
+{
+  const uint64_t even_low = uint64_t(words[2]) << 18 | words[3] >> 14; // Last 50 bits of the even half
+
+  parts[0] = words[0] >> 28;
+  parts[1] = uint64_t(words[0]) << 36 | uint64_t(words[1]) << 4 | words[2] >> 28;
+  parts[2] = even_low << 18 | words[4] >> 14;
+  parts[3] = uint64_t(words[4]) << 50 | uint64_t(words[5]) << 18 | words[6] >> 14;
+}
+
+
+uint32_t crcTable(const uint64_t (&parts)[4])
+{
+  const auto &t = CRC_TABLES.table;
+  uint32_t crc = 0;
+
+  for (uint64_t part : parts)
+  {
+    uint64_t x = part ^ uint64_t(crc) << 40;
+
+    crc = t[7][x >> 56] ^ t[6][(x >> 48) & 0xff] ^ t[5][(x >> 40) & 0xff] ^ t[4][(x >> 32) & 0xff] ^
+          t[3][(x >> 24) & 0xff] ^ t[2][(x >> 16) & 0xff] ^ t[1][(x >> 8) & 0xff] ^ t[0][x & 0xff];
+  }
+
+  return crc;
+}
+
+
+#ifdef GALILEO_X86
+
+/*
+ * Carry-less multiply kernel. A 64 bit remainder is carried over the
+ * parts, each step multiplies it by x^64 with two products:
+ *   A x^64 = A_hi x^96 + A_lo x^64 = A_hi (x^96 mod P) + A_lo (x^64 mod P)
+ * which stay below 56 bits. The last remainder is multiplied by x^24 the
+ * same way and reduced with Barrett's method.
+ */
+
+// x^n mod P
+constexpr uint64_t powerMod(unsigned n)
+{
+  uint64_t value = 1;
+
+  for (unsigned i = 0; i < n; i++)
+  {
+    value <<= 1;
+    if (value & 0x1000000)
+      value ^= CRC24Q_POLY;
+  }
+
+  return value;
+}
+
+
+// Quotient of x^56 / P, 33 bits
+constexpr uint64_t barrettConstant()
+{
+  uint64_t remainder = uint64_t(1) << 56;
+  uint64_t quotient = 0;
+
+  for (int bit = 56; bit >= 24; bit--)
+    if (remainder & (uint64_t(1) << bit))
+    {
+      remainder ^= uint64_t(CRC24Q_POLY) << (bit - 24);
+      quotient |= uint64_t(1) << (bit - 24);
+    }
+
+  return quotient;
+}
+
+
+__attribute__((target("pclmul")))
+inline uint64_t clmul(uint64_t a, uint64_t b)
+{
+  return _mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_cvtsi64_si128(a), _mm_cvtsi64_si128(b), 0));
+}
+
+
+__attribute__((target("pclmul")))
+uint32_t crcClmul(const uint64_t (&parts)[4])
+{
+  constexpr uint64_t x96 = powerMod(96);
+  constexpr uint64_t x64 = powerMod(64);
+  constexpr uint64_t x56 = powerMod(56);
+  constexpr uint64_t mu = barrettConstant();
+
+  uint64_t remainder = parts[0];
+
+  for (int i = 1; i < 4; i++)
+    remainder = clmul(remainder >> 32, x96) ^ clmul(remainder & 0xffffffff, x64) ^ parts[i];
+
+  // Times x^24, below 56 bits
+  uint64_t value = clmul(remainder >> 32, x56) ^ (remainder & 0xffffffff) << 24;
+
+  uint64_t quotient = clmul(value >> 24, mu) >> 32;
+
+  return (value ^ clmul(quotient, CRC24Q_POLY)) & 0xffffff;
+}
+
+#endif
+
+
+CrcKernel detectCrcKernel()
+{
+  if (cpuFeatures().pclmul)
+    return CLMUL_CRC;
+
+  return TABLE_CRC;
+}
+
+} // namespace
+
+
+uint32_t crc24q(const uint8_t *data, size_t size)
+{
+  uint32_t crc = 0;
+
+  for (size_t i = 0; i < size; i++)
+    crc = ((crc << 8) & 0xffffff) ^ CRC_TABLES.table[0][(crc >> 16) ^ data[i]];
+
+  return crc;
+}
+
+
+uint32_t inavCrc(const uint32_t *words)
+{
+  return inavCrc(activeCrcKernel(), words);
+}
+
+
+uint32_t inavCrc(CrcKernel kernel, const uint32_t *words)
+{
+  if (kernel > activeCrcKernel())
+    kernel = activeCrcKernel();
+
+  uint64_t parts[4];
+  messageParts(words, parts);
+
+  switch (kernel)
+  {
+#ifdef GALILEO_X86
+  case CLMUL_CRC:
+    return crcClmul(parts);
+#endif
+
+  default:
+    return crcTable(parts);
+  }
+}
+
+
+CrcKernel activeCrcKernel()
+{
+  static const CrcKernel kernel = detectCrcKernel();
+  return kernel;
+}
@@ -0,0 +1,338 @@
+#include "inav_fec2.h"
+#include <bitset>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+
+namespace
+{
+
+/**
+ * @brief Exponent and logarithm tables of GF(2^8) with the primitive
+ *        polynomial x^8 + x^4 + x^3 + x^2 + 1. The exponents are repeated,
+ *        so a sum of two logarithms needs no reduction
+ *
+ */
+struct GaloisTables
+{
+  uint8_t exp[510];
+  uint8_t log[256];
+
+  constexpr GaloisTables() : exp(), log()
+  {
+    unsigned value = 1;
+
+    for (unsigned i = 0; i < 255; i++)
+    {
+      exp[i] = exp[i + 255] = value;
+      log[value] = i;
+
+      value <<= 1;
+      if (value & 0x100)
+        value ^= 0x11d;
+    }
+  }
+};
+
+constexpr GaloisTables GF;
+
+
+constexpr uint8_t mul(uint8_t a, uint8_t b)
+{
+  return (a == 0 || b == 0) ? 0 : GF.exp[GF.log[a] + GF.log[b]];
+}
+
+
+constexpr uint8_t div(uint8_t a, uint8_t b)
+{
+  return (a == 0) ? 0 : GF.exp[GF.log[a] + 255 - GF.log[b]];
+}
+
+
+/**
+ * @brief Generator polynomial (x + a)(x + a^2)..(x + a^60), coefficient
+ *        k of x^k. The leading coefficient 1 is not stored
+ *
+ */
+struct Generator
+{
+  uint8_t coef[FEC2_PARITY_SIZE];
+
+  constexpr Generator() : coef()
+  {
+    uint8_t poly[FEC2_PARITY_SIZE + 1] = {1};
+
+    for (unsigned root = 1; root <= FEC2_PARITY_SIZE; root++)
+    {
+      // Times (x + a^root)
+      for (unsigned k = root; k > 0; k--)
+        poly[k] = poly[k - 1] ^ mul(poly[k], GF.exp[root]);
+
+      poly[0] = mul(poly[0], GF.exp[root]);
+    }
+
+    for (unsigned k = 0; k < FEC2_PARITY_SIZE; k++)
+      coef[k] = poly[k];
+  }
+};
+
+constexpr Generator GENERATOR;
+
+
+/*
+ * Byte i of the code word is the coefficient of x^(117 - i), the first
+ * information byte is the highest one. The syndromes S_j are the code
+ * word polynomial at a^j, j = 1..60.
+ */
+void syndromes(const uint8_t *code, uint8_t (&syndrome)[FEC2_PARITY_SIZE])
+{
+  for (unsigned j = 0; j < FEC2_PARITY_SIZE; j++)
+  {
+    const uint8_t root = GF.exp[j + 1];
+    uint8_t value = 0;
+
+    for (unsigned i = 0; i < FEC2_CODE_SIZE; i++)
+      value = mul(value, root) ^ code[i];
+
+    syndrome[j] = value;
+  }
+}
+
+
+// 8 bits of a page from the given page bit on
+uint8_t pageByte(const InavPage &page, unsigned first)
+{
+  return page.bits(first, 8);
+}
+
+
+// Bytes as a big endian number
+uint64_t loadBytes(const uint8_t *bytes, unsigned count)
+{
+  uint64_t value = 0;
+
+  for (unsigned i = 0; i < count; i++)
+    value = value << 8 | bytes[i];
+
+  return value;
+}
+
+} // namespace
+
+
+void fec2Encode(const uint8_t *info, uint8_t *parity)
+{
+  // Remainder of info(x) x^60 by the generator, parity[0] the highest coefficient
+  std::memset(parity, 0, FEC2_PARITY_SIZE);
+
+  for (unsigned i = 0; i < FEC2_INFO_SIZE; i++)
+  {
+    const uint8_t feedback = info[i] ^ parity[0];
+
+    for (unsigned j = 0; j + 1 < FEC2_PARITY_SIZE; j++)
+      parity[j] = parity[j + 1] ^ mul(feedback, GENERATOR.coef[FEC2_PARITY_SIZE - 1 - j]);
+
+    parity[FEC2_PARITY_SIZE - 1] = mul(feedback, GENERATOR.coef[0]);
+  }
+}
+
+
+bool fec2Decode(uint8_t *code, const bool *erased)
+{
+  uint8_t received[FEC2_CODE_SIZE];
+  uint8_t locator[FEC2_PARITY_SIZE + 1] = {1}; // Erasure locator, the product of (1 + X_i x)
+  unsigned count = 0;
+
+  for (unsigned i = 0; i < FEC2_CODE_SIZE; i++)
+  {
+    received[i] = erased[i] ? 0 : code[i];
+
+    if (!erased[i])
+      continue;
+
+    if (++count > FEC2_PARITY_SIZE)
+      return false;
+
+    const uint8_t x = GF.exp[FEC2_CODE_SIZE - 1 - i];
+
+    for (unsigned k = count; k > 0; k--)
+      locator[k] ^= mul(locator[k - 1], x);
+  }
+
+  uint8_t syndrome[FEC2_PARITY_SIZE];
+  syndromes(received, syndrome);
+
+  // Evaluator S(x) locator(x) mod x^60
+  uint8_t evaluator[FEC2_PARITY_SIZE] = {};
+
+  for (unsigned j = 0; j < FEC2_PARITY_SIZE; j++)
+    for (unsigned k = 0; k <= count && k <= j; k++)
+      evaluator[j] ^= mul(syndrome[j - k], locator[k]);
+
+  // Forney: the value at X_i is evaluator(1 / X_i) / locator'(1 / X_i)
+  for (unsigned i = 0; i < FEC2_CODE_SIZE; i++)
+  {
+    if (!erased[i])
+      continue;
+
+    const uint8_t x_inv = GF.exp[255 - (FEC2_CODE_SIZE - 1 - i)];
+
+    uint8_t numerator = 0;
+    for (unsigned j = FEC2_PARITY_SIZE; j > 0; j--)
+      numerator = mul(numerator, x_inv) ^ evaluator[j - 1];
+
+    // The odd terms of the locator only, the characteristic is 2
+    uint8_t denominator = 0;
+    uint8_t power = 1;
+    for (unsigned k = 1; k <= count; k += 2)
+    {
+      denominator ^= mul(locator[k], power);
+      power = mul(power, mul(x_inv, x_inv));
+    }
+
+    if (denominator == 0)
+      return false;
+
+    received[i] = div(numerator, denominator);
+  }
+
+  // Known bytes beyond the ones needed are checked against each other
+  syndromes(received, syndrome);
+
+  for (uint8_t value : syndrome)
+    if (value != 0)
+      return false;
+
+  std::memcpy(code, received, FEC2_CODE_SIZE);
+  return true;
+}
+
+
+bool Fec2Recovery::add(const InavPage &page)
+{
+  const unsigned word_type = page.wordType();
+
+  if (word_type >= 1 && word_type <= 4)
+  {
+    const int iod = page.bits(6, 10);
+
+    if ((iod_ != -1 && iod != iod_) || (iod_lsb_ != -1 && (iod & 3) != iod_lsb_))
+      clear();
+
+    iod_ = iod;
+    words_ |= 1u << (word_type - 1);
+
+    // Word type 1 from its word type on, the others behind their IODnav
+    if (word_type == 1)
+      for (unsigned i = 0; i < 16; i++)
+        code_[i] = pageByte(page, 8 * i);
+    else
+      for (unsigned i = 0; i < 14; i++)
+        code_[16 + 14 * (word_type - 2) + i] = pageByte(page, 16 + 8 * i);
+
+    return true;
+  }
+
+  if (word_type >= 17 && word_type <= 20)
+  {
+    const int iod_lsb = page.bits(14, 2);
+
+    if ((iod_lsb_ != -1 && iod_lsb != iod_lsb_) || (iod_ != -1 && iod_lsb != (iod_ & 3)))
+      clear();
+
+    iod_lsb_ = iod_lsb;
+    words_ |= 1u << (word_type - 13);
+
+    // One parity byte in front of the IODnav bits, 14 behind them
+    uint8_t *parity = code_ + FEC2_INFO_SIZE + 15 * (word_type - 17);
+    parity[0] = pageByte(page, 6);
+
+    for (unsigned i = 0; i < 14; i++)
+      parity[1 + i] = pageByte(page, 16 + 8 * i);
+
+    return true;
+  }
+
+  return false;
+}
+
+
+unsigned Fec2Recovery::recover(InavPage (&pages)[4])
+{
+  const unsigned missing = ~words_ & 0xf;
+
+  // 4 words fill the code without a byte to spare, and the IODnav bits of
+  // the words 17 to 20 tell only 1 in 4 others apart. The known bytes of a
+  // fifth word have to agree with the rebuilt code word
+  if (missing == 0 || std::bitset<8>(words_).count() < 5)
+    return 0;
+
+  // The word type and IODnav of word 1 are known from the other words 2 to 4
+  const bool head_known = iod_ != -1;
+
+  if (head_known)
+  {
+    code_[0] = 1 << 2 | iod_ >> 8;
+    code_[1] = iod_ & 0xff;
+  }
+
+  // Erased bytes of the words not added
+  bool erased[FEC2_CODE_SIZE] = {};
+
+  for (unsigned word = 0; word < 8; word++)
+  {
+    if (words_ & (1u << word))
+      continue;
+
+    unsigned first = (word == 0) ? (head_known ? 2 : 0) : (word < 4) ? 16 + 14 * (word - 1) : FEC2_INFO_SIZE + 15 * (word - 4);
+    unsigned size = (word == 0) ? 16 - first : (word < 4) ? 14 : 15;
+
+    for (unsigned i = first; i < first + size; i++)
+      erased[i] = true;
+  }
+
+  if (!fec2Decode(code_, erased))
+    return 0;
+
+  // The IODnav of the words 2 to 4 is the one of word 1
+  iod_ = (code_[0] & 0x3) << 8 | code_[1];
+
+  pages[0] = InavPage(loadBytes(code_, 8), loadBytes(code_ + 8, 8));
+
+  for (unsigned word_type = 2; word_type <= 4; word_type++)
+  {
+    const uint8_t *bytes = code_ + 16 + 14 * (word_type - 2);
+    const uint64_t head = word_type << 10 | iod_;
+
+    pages[word_type - 1] = InavPage(head << 48 | loadBytes(bytes, 6), loadBytes(bytes + 6, 8));
+  }
+
+  words_ |= missing;
+
+  return missing;
+}
+
+
+void Fec2Recovery::clear()
+{
+  std::memset(code_, 0, sizeof(code_));
+  words_ = 0;
+  iod_ = -1;
+  iod_lsb_ = -1;
+}
+
+
+void Fec2Recovery::save(std::ostream &out) const
+{
+  static_assert(std::is_trivially_copyable<Fec2Recovery>::value, "Fec2Recovery is saved byte by byte");
+
+  out.write(reinterpret_cast<const char *>(this), sizeof(*this));
+}
+
+
+bool Fec2Recovery::load(std::istream &in)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(this), sizeof(*this)));
+}
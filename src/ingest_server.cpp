@@ -0,0 +1,252 @@
+#include "ingest_server.h"
+#include <cerrno>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+
+const int IngestServer::POLL_MS;
+const size_t IngestServer::READ_SIZE;
+const size_t IngestServer::CHUNK_SIZE;
+
+
+IngestServer::IngestServer(const std::string &output_dir, std::ostream &console)
+  : output_dir_(output_dir), console_(console)
+{
+}
+
+
+IngestServer::~IngestServer()
+{
+  if (listen_fd_ >= 0)
+    close(listen_fd_);
+}
+
+
+std::string IngestServer::outputBase(const std::string &output_dir, const std::string &address, uint16_t port)
+{
+  return (fs::path(output_dir) / (address + "_" + std::to_string(port))).string();
+}
+
+
+bool IngestServer::listen(uint16_t port, const std::string &address)
+{
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+
+  if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1)
+  {
+    report("Invalid address: " + address);
+    return false;
+  }
+
+  listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+  const int reuse = 1;
+  socklen_t length = sizeof(addr);
+
+  if (listen_fd_ < 0 || setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+      bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || ::listen(listen_fd_, SOMAXCONN) != 0 ||
+      getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &length) != 0)
+  {
+    report("Port cannot be opened: " + std::to_string(port));
+
+    if (listen_fd_ >= 0)
+      close(listen_fd_);
+
+    listen_fd_ = -1;
+    return false;
+  }
+
+  port_ = ntohs(addr.sin_port);
+
+  return true;
+}
+
+
+bool IngestServer::run(unsigned loops, const std::atomic<bool> &stop)
+{
+  std::error_code error;
+
+  if (listen_fd_ < 0 || (fs::create_directories(output_dir_, error), !fs::is_directory(output_dir_)))
+  {
+    report("Output directory cannot be made: " + output_dir_);
+    return false;
+  }
+
+  if (loops == 0)
+    loops = 1;
+
+  std::vector<int> epoll_fds;
+
+  for (unsigned i = 0; i < loops; i++)
+  {
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+    // Every loop waits on the listening socket, a new connection wakes only one of them
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    event.data.fd = listen_fd_;
+
+    if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd_, &event) != 0)
+    {
+      if (epoll_fd >= 0)
+        close(epoll_fd);
+
+      break;
+    }
+
+    epoll_fds.push_back(epoll_fd);
+  }
+
+  if (epoll_fds.size() != loops)
+  {
+    for (int epoll_fd : epoll_fds)
+      close(epoll_fd);
+
+    report("Event loops cannot be made");
+    return false;
+  }
+
+  std::vector<std::thread> threads;
+
+  for (unsigned i = 1; i < loops; i++)
+    threads.emplace_back(&IngestServer::loop, this, epoll_fds[i], std::cref(stop));
+
+  loop(epoll_fds[0], stop);
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  for (int epoll_fd : epoll_fds)
+    close(epoll_fd);
+
+  return true;
+}
+
+
+void IngestServer::loop(int epoll_fd, const std::atomic<bool> &stop)
+{
+  const int max_events = 64;
+
+  Connections connections; // Only this loop touches its connections
+  std::vector<uint8_t> buffer(READ_SIZE);
+  epoll_event events[max_events];
+
+  while (!stop)
+  {
+    int count = epoll_wait(epoll_fd, events, max_events, POLL_MS);
+
+    if (count < 0 && errno != EINTR)
+      break;
+
+    for (int i = 0; i < count; i++)
+    {
+      if (events[i].data.fd == listen_fd_)
+      {
+        accept(epoll_fd, connections);
+        continue;
+      }
+
+      auto found = connections.find(events[i].data.fd);
+
+      if (found != connections.end() && !receive(*found->second, buffer))
+      {
+        finish(*found->second);
+        connections.erase(found);
+      }
+    }
+  }
+
+  for (auto &connection : connections)
+    finish(*connection.second);
+}
+
+
+void IngestServer::accept(int epoll_fd, Connections &connections)
+{
+  while (true)
+  {
+    sockaddr_in addr{};
+    socklen_t length = sizeof(addr);
+
+    int fd = accept4(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    if (fd < 0)
+      return; // Taken by another loop or none left
+
+    char address[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr.sin_addr, address, sizeof(address));
+
+    const std::string base = outputBase(output_dir_, address, ntohs(addr.sin_port));
+
+    auto connection = std::make_unique<Connection>();
+    connection->fd = fd;
+    connection->name = std::string(address) + ":" + std::to_string(ntohs(addr.sin_port));
+    connection->nav_data_file.open(base + ".nav.txt");
+    connection->console.open(base + ".log.txt");
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+
+    if (!connection->nav_data_file || !connection->console || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+      report("Output cannot be written: " + base);
+      close(fd);
+      continue;
+    }
+
+    connection->solver = std::make_unique<GalileoSolver>(connection->name, connection->console,
+                                                         connection->nav_data_file, GalileoSolver::STREAM, CHUNK_SIZE);
+
+    ++accept_count_;
+    ++open_count_;
+    report("Receiver " + connection->name + " connected");
+
+    connections[fd] = std::move(connection);
+  }
+}
+
+
+bool IngestServer::receive(Connection &connection, std::vector<uint8_t> &buffer)
+{
+  // One read per event, so a busy receiver does not hold up the others of the loop
+  ssize_t count = ::read(connection.fd, buffer.data(), buffer.size());
+
+  if (count > 0)
+  {
+    connection.solver->feed(buffer.data(), count);
+    return true;
+  }
+
+  return count < 0 && (errno == EAGAIN || errno == EINTR);
+}
+
+
+void IngestServer::finish(Connection &connection)
+{
+  connection.solver->finishFeed();
+  connection.nav_data_file.flush();
+  connection.console.flush();
+
+  close(connection.fd);
+
+  report("Receiver " + connection.name + " disconnected");
+  --open_count_;
+}
+
+
+void IngestServer::report(const std::string &message)
+{
+  std::lock_guard<std::mutex> lock(console_mutex_);
+  console_ << message << std::endl;
+}
@@ -1,10 +1,127 @@
 #include "galileo_solver.h"
+#include <atomic>
+#include <csignal>
 #include <memory>
 
-int main() {
+namespace
+{
+
+std::atomic<bool> stop_following(false);
+
+void stopFollowing(int) { stop_following = true; }
+
+} // namespace
+
+int main(int argc, char **argv) {
   std::string file = "../data/COM3_210730_115228.ubx";
-  std::unique_ptr<GalileoSolver> data = std::make_unique<GalileoSolver>(file);
-  data->read();
+  GalileoSolver::InputMode mode = GalileoSolver::STREAM;
+  unsigned threads = 0; // Serial read when not given
+  bool build_index = false;
+  std::string select; // Decode only these pages through the frame index, e.g. "E11:1-5"
+  std::string window; // Decode only this GST window through the frame index, e.g. "1148:302400,1148:309600"
+  bool follow = false;
+  std::string checkpoint; // Checkpoint of the follow mode, next to the file when not given
+  unsigned baud_rate = 0; // Baud rate of a serial port, kept as it is when not given
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+
+    if (arg == "--mmap")
+      mode = GalileoSolver::MMAP;
+    else if (arg == "--async")
+      mode = GalileoSolver::ASYNC;
+    else if (arg == "--direct")
+      mode = GalileoSolver::DIRECT;
+    else if (arg == "--threads" && i + 1 < argc)
+      threads = std::stoul(argv[++i]);
+    else if (arg == "--index")
+      build_index = true;
+    else if (arg == "--select" && i + 1 < argc)
+      select = argv[++i];
+    else if (arg == "--window" && i + 1 < argc)
+      window = argv[++i];
+    else if (arg == "--follow")
+      follow = true;
+    else if (arg == "--checkpoint" && i + 1 < argc)
+      checkpoint = argv[++i];
+    else if (arg == "--baud" && i + 1 < argc)
+      baud_rate = std::stoul(argv[++i]);
+    else
+      file = arg;
+  }
+
+  FrameQuery query;
+
+  if (!select.empty() && !FrameQuery::parse(select, query))
+  {
+    std::cout << "Invalid selection: " << select << std::endl;
+    return 1;
+  }
+
+  if (!window.empty())
+  {
+    uint32_t first, last;
+
+    if (!FrameQuery::parseWindow(window, first, last))
+    {
+      std::cout << "Invalid window: " << window << std::endl;
+      return 1;
+    }
+
+    query.setWindow(first, last);
+  }
+
+  const bool indexed = !select.empty() || !window.empty();
+
+  if (follow)
+  {
+    if (checkpoint.empty())
+      checkpoint = file + ".ckpt";
+
+    std::signal(SIGINT, stopFollowing);
+    std::signal(SIGTERM, stopFollowing);
+
+    // A resumed run continues the output of the previous one
+    const bool resumed = std::ifstream(checkpoint).good();
+    std::ofstream nav_data_file(GalileoSolver::DEFAULT_NAV_DATA_PATH, resumed ? std::ios::app : std::ios::trunc);
+    GalileoSolver solver(file, std::cout, nav_data_file);
+
+    return solver.follow(checkpoint, stop_following) ? 0 : 1;
+  }
+
+  std::unique_ptr<GalileoSolver> data = std::make_unique<GalileoSolver>(file, mode);
+
+  if (build_index || indexed)
+  {
+    FrameIndex index;
+    const std::string index_path = FrameIndex::sidecarPath(file);
+
+    // The sidecar is built again when the capture changed since
+    if (!index.load(index_path) || !index.isCurrent(file))
+    {
+      if (!data->buildIndex(index) || !index.write(index_path))
+      {
+        std::cout << "Index cannot be written: " << index_path << std::endl;
+        return 1;
+      }
+    }
+
+    if (indexed)
+      data->readIndexed(index, query);
+
+    return 0;
+  }
+
+  if (threads > 0)
+    data->readParallel(threads);
+  else
+  {
+    data->setBaudRate(baud_rate);
+
+    if (!data->read())
+      return 1;
+  }
 
   return 0;
-}
\ No newline at end of file
+}
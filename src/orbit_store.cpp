@@ -0,0 +1,160 @@
+#include "orbit_store.h"
+#include <cmath>
+
+
+namespace
+{
+
+const double MU = 3.986004418e14; // Earth gravitational constant [m^3/s^2]
+const double EARTH_ROTATION = 7.2921151467e-5; // [rad/s]
+const double RELATIVISTIC_F = -4.442807309e-10; // [s/sqrt(m)]
+const double WEEK = 604800;
+
+const double NOMINAL_SEMI_MAJOR_AXIS = 29600000; // Of the reduced data [m]
+const double NOMINAL_INCLINATION = 56.0 / 180 * M_PI; // Of the reduced data
+
+
+// Time from the reference time, across the week boundary
+double timeFrom(double gst, double reference)
+{
+  double t = gst - reference;
+
+  if (t > WEEK / 2)
+    t -= WEEK;
+  else if (t < -WEEK / 2)
+    t += WEEK;
+
+  return t;
+}
+
+} // namespace
+
+
+SatelliteState keplerState(const KeplerOrbit &orbit, double gst)
+{
+  const double a = orbit.root_semi_major_axis * orbit.root_semi_major_axis;
+  const double e = orbit.eccentricity;
+  const double tk = timeFrom(gst, orbit.toe);
+
+  const double n = std::sqrt(MU / (a * a * a)) + orbit.delta_n;
+  const double m = orbit.mean_anomaly + n * tk;
+
+  // Kepler's equation, converges in a few steps for the small eccentricities of the constellation
+  double ea = m;
+  for (int i = 0; i < 10; i++)
+  {
+    double step = (ea - e * std::sin(ea) - m) / (1 - e * std::cos(ea));
+    ea -= step;
+
+    if (std::fabs(step) < 1e-13)
+      break;
+  }
+
+  const double v = std::atan2(std::sqrt(1 - e * e) * std::sin(ea), std::cos(ea) - e);
+  const double phi = v + orbit.perigee;
+  const double sin2 = std::sin(2 * phi);
+  const double cos2 = std::cos(2 * phi);
+
+  const double u = phi + orbit.cus * sin2 + orbit.cuc * cos2;
+  const double r = a * (1 - e * std::cos(ea)) + orbit.crs * sin2 + orbit.crc * cos2;
+  const double i = orbit.inclination + orbit.cis * sin2 + orbit.cic * cos2 + orbit.inclination_rate * tk;
+
+  const double x = r * std::cos(u);
+  const double y = r * std::sin(u);
+
+  // The node at the time of week of the reference time, Earth-fixed
+  const double toe_of_week = std::fmod(orbit.toe, WEEK);
+  const double omega = orbit.longitude + (orbit.longitude_rate - EARTH_ROTATION) * tk - EARTH_ROTATION * toe_of_week;
+
+  SatelliteState state;
+  state.position[0] = x * std::cos(omega) - y * std::cos(i) * std::sin(omega);
+  state.position[1] = x * std::sin(omega) + y * std::cos(i) * std::cos(omega);
+  state.position[2] = y * std::sin(i);
+
+  const double dt = timeFrom(gst, orbit.toc);
+  state.clock_offset = orbit.af0 + orbit.af1 * dt + orbit.af2 * dt * dt +
+                       RELATIVISTIC_F * e * orbit.root_semi_major_axis * std::sin(ea);
+
+  return state;
+}
+
+
+KeplerOrbit reducedOrbit(const InavPage &page, double t0r)
+{
+  const double ex = scaleField<InavWord16::eccentricity_rced_x>(page.field<InavWord16::eccentricity_rced_x>());
+  const double ey = scaleField<InavWord16::eccentricity_rced_y>(page.field<InavWord16::eccentricity_rced_y>());
+  const double lambda = scaleField<InavWord16::lambda_rced>(page.field<InavWord16::lambda_rced>());
+
+  KeplerOrbit orbit;
+  orbit.root_semi_major_axis = std::sqrt(NOMINAL_SEMI_MAJOR_AXIS +
+                                         scaleField<InavWord16::delta_rced_smajor>(page.field<InavWord16::delta_rced_smajor>()));
+  orbit.eccentricity = std::sqrt(ex * ex + ey * ey);
+  orbit.perigee = std::atan2(ey, ex);
+  orbit.mean_anomaly = lambda - orbit.perigee; // The mean argument of latitude is sent
+  orbit.inclination = NOMINAL_INCLINATION +
+                      scaleField<InavWord16::delta_rced_inclination>(page.field<InavWord16::delta_rced_inclination>());
+  orbit.longitude = scaleField<InavWord16::rced_longitude>(page.field<InavWord16::rced_longitude>());
+  orbit.toe = t0r;
+  orbit.toc = t0r;
+  orbit.af0 = scaleField<InavWord16::rced_clock_corr_bias>(page.field<InavWord16::rced_clock_corr_bias>());
+  orbit.af1 = scaleField<InavWord16::rced_clock_corr_drift>(page.field<InavWord16::rced_clock_corr_drift>());
+
+  return orbit;
+}
+
+
+void OrbitStore::setEphemeris(unsigned svId, const KeplerOrbit &orbit)
+{
+  if (svId < 1 || svId > 36)
+    return;
+
+  entries_[svId - 1].full = orbit;
+  entries_[svId - 1].has_full = true;
+}
+
+
+void OrbitStore::setReduced(unsigned svId, const KeplerOrbit &orbit)
+{
+  if (svId < 1 || svId > 36)
+    return;
+
+  entries_[svId - 1].reduced = orbit;
+  entries_[svId - 1].has_reduced = true;
+}
+
+
+OrbitStore::Source OrbitStore::source(unsigned svId, double gst) const
+{
+  if (svId < 1 || svId > 36)
+    return NONE;
+
+  const Entry &entry = entries_[svId - 1];
+
+  if (entry.has_full && std::fabs(gst - entry.full.toe) <= FULL_VALIDITY)
+    return FULL;
+
+  if (entry.has_reduced && std::fabs(gst - entry.reduced.toe) <= REDUCED_VALIDITY)
+    return REDUCED;
+
+  return NONE;
+}
+
+
+OrbitStore::Source OrbitStore::state(unsigned svId, double gst, SatelliteState &state) const
+{
+  Source from = source(svId, gst);
+
+  if (from == FULL)
+    state = keplerState(entries_[svId - 1].full, gst);
+  else if (from == REDUCED)
+    state = keplerState(entries_[svId - 1].reduced, gst);
+
+  return from;
+}
+
+
+void OrbitStore::clear()
+{
+  for (Entry &entry : entries_)
+    entry = Entry();
+}
@@ -0,0 +1,50 @@
+#include "ingest_server.h"
+#include <csignal>
+
+namespace
+{
+
+std::atomic<bool> stop_serving(false);
+
+void stopServing(int) { stop_serving = true; }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string output_dir = "../data/server";
+  std::string address = "0.0.0.0";
+  uint16_t port = 4100;
+  unsigned loops = 2;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+
+    if (arg == "--out" && i + 1 < argc)
+      output_dir = argv[++i];
+    else if (arg == "--address" && i + 1 < argc)
+      address = argv[++i];
+    else if (arg == "--port" && i + 1 < argc)
+      port = std::stoul(argv[++i]);
+    else if (arg == "--loops" && i + 1 < argc)
+      loops = std::stoul(argv[++i]);
+    else
+    {
+      std::cout << "Usage: galileo_server [--out DIR] [--address ADDRESS] [--port N] [--loops N]" << std::endl;
+      return 2;
+    }
+  }
+
+  std::signal(SIGINT, stopServing);
+  std::signal(SIGTERM, stopServing);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  IngestServer server(output_dir);
+
+  if (!server.listen(port, address))
+    return 1;
+
+  std::cout << "Listening on " << address << ":" << server.port() << std::endl;
+
+  return server.run(loops, stop_serving) ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+#include "sync_scanner.h"
+#include "cpu_features.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GALILEO_X86 1
+#endif
+
+
+namespace
+{
+
+const uint8_t SYNC_HEADER_1 = 0xb5;
+const uint8_t SYNC_HEADER_2 = 0x62;
+
+
+const uint8_t *scanScalar(const uint8_t *p, const uint8_t *end)
+{
+  for (; p < end; ++p)
+  {
+    if (*p == SYNC_HEADER_1 && (p + 1 == end || p[1] == SYNC_HEADER_2))
+      return p;
+  }
+  return end;
+}
+
+
+#ifdef GALILEO_X86
+
+__attribute__((target("sse2")))
+const uint8_t *scanSse2(const uint8_t *p, const uint8_t *end)
+{
+  const __m128i header_1 = _mm_set1_epi8(static_cast<char>(SYNC_HEADER_1));
+  const __m128i header_2 = _mm_set1_epi8(static_cast<char>(SYNC_HEADER_2));
+
+  // Compares 16 positions at once, the second load is shifted by one byte
+  for (; end - p >= 17; p += 16)
+  {
+    __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 1));
+
+    __m128i match = _mm_and_si128(_mm_cmpeq_epi8(first, header_1), _mm_cmpeq_epi8(second, header_2));
+    unsigned mask = _mm_movemask_epi8(match);
+
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+  }
+  return scanScalar(p, end);
+}
+
+
+__attribute__((target("avx2")))
+const uint8_t *scanAvx2(const uint8_t *p, const uint8_t *end)
+{
+  const __m256i header_1 = _mm256_set1_epi8(static_cast<char>(SYNC_HEADER_1));
+  const __m256i header_2 = _mm256_set1_epi8(static_cast<char>(SYNC_HEADER_2));
+
+  for (; end - p >= 33; p += 32)
+  {
+    __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 1));
+
+    __m256i match = _mm256_and_si256(_mm256_cmpeq_epi8(first, header_1), _mm256_cmpeq_epi8(second, header_2));
+    unsigned mask = _mm256_movemask_epi8(match);
+
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+  }
+  return scanSse2(p, end);
+}
+
+#endif
+
+
+SyncScanner detectSyncScanner()
+{
+  if (cpuFeatures().avx2)
+    return AVX2_SCANNER;
+
+  if (cpuFeatures().sse2)
+    return SSE2_SCANNER;
+
+  return SCALAR_SCANNER;
+}
+
+} // namespace
+
+
+const uint8_t *findSyncHeaders(const uint8_t *begin, const uint8_t *end)
+{
+  return findSyncHeaders(activeSyncScanner(), begin, end);
+}
+
+
+const uint8_t *findSyncHeaders(SyncScanner scanner, const uint8_t *begin, const uint8_t *end)
+{
+  if (scanner > activeSyncScanner())
+    scanner = activeSyncScanner();
+
+  switch (scanner)
+  {
+#ifdef GALILEO_X86
+  case AVX2_SCANNER:
+    return scanAvx2(begin, end);
+
+  case SSE2_SCANNER:
+    return scanSse2(begin, end);
+#endif
+
+  default:
+    return scanScalar(begin, end);
+  }
+}
+
+
+SyncScanner activeSyncScanner()
+{
+  static const SyncScanner scanner = detectSyncScanner();
+  return scanner;
+}
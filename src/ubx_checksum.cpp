@@ -0,0 +1,166 @@
+#include "ubx_checksum.h"
+#include "cpu_features.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GALILEO_X86 1
+#endif
+
+
+namespace
+{
+
+// Shorter inputs, like the SFRBX frames, are cheaper to sum byte by byte
+const size_t VECTOR_THRESHOLD = 64;
+
+
+void checksumScalar(uint8_t &ck_a, uint8_t &ck_b, const uint8_t *data, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    checksumStep(ck_a, ck_b, data[i]);
+}
+
+
+#ifdef GALILEO_X86
+
+/*
+ * Block form of the checksum. For a block x_0 .. x_n-1
+ *   CK_A += sum(x_i)
+ *   CK_B += n * CK_A + sum((n - i) * x_i)
+ * The sums are kept in 32 bit lanes, wrapping is harmless since only
+ * the value modulo 256 is needed.
+ */
+
+__attribute__((target("sse2")))
+uint32_t horizontalSum(__m128i v)
+{
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(v);
+}
+
+
+__attribute__((target("sse2")))
+void checksumSse2(uint8_t &ck_a, uint8_t &ck_b, const uint8_t *data, size_t size)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weights_lo = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+  const __m128i weights_hi = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+
+  __m128i sum = zero; // sum(x_i)
+  __m128i prefix = zero; // sum of sum(x_i) before each block
+  __m128i weighted = zero; // sum((n - i) * x_i) in each block
+
+  size_t blocks = size / 16;
+
+  for (size_t i = 0; i < blocks; i++)
+  {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16 * i));
+
+    prefix = _mm_add_epi32(prefix, sum);
+    sum = _mm_add_epi32(sum, _mm_sad_epu8(block, zero));
+    weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpacklo_epi8(block, zero), weights_lo));
+    weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpackhi_epi8(block, zero), weights_hi));
+  }
+
+  uint32_t bytes = blocks * 16;
+  uint32_t a = ck_a + horizontalSum(sum);
+  uint32_t b = ck_b + bytes * ck_a + 16 * horizontalSum(prefix) + horizontalSum(weighted);
+
+  ck_a = a;
+  ck_b = b;
+  checksumScalar(ck_a, ck_b, data + bytes, size - bytes);
+}
+
+
+__attribute__((target("avx2")))
+void checksumAvx2(uint8_t &ck_a, uint8_t &ck_b, const uint8_t *data, size_t size)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i ones = _mm256_set1_epi16(1);
+  const __m256i weights = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                           16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+
+  __m256i sum = zero;
+  __m256i prefix = zero;
+  __m256i weighted = zero;
+
+  size_t blocks = size / 32;
+
+  for (size_t i = 0; i < blocks; i++)
+  {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 32 * i));
+
+    prefix = _mm256_add_epi32(prefix, sum);
+    sum = _mm256_add_epi32(sum, _mm256_sad_epu8(block, zero));
+    weighted = _mm256_add_epi32(weighted, _mm256_madd_epi16(_mm256_maddubs_epi16(block, weights), ones));
+  }
+
+  __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  __m128i prefix128 = _mm_add_epi32(_mm256_castsi256_si128(prefix), _mm256_extracti128_si256(prefix, 1));
+  __m128i weighted128 = _mm_add_epi32(_mm256_castsi256_si128(weighted), _mm256_extracti128_si256(weighted, 1));
+
+  uint32_t bytes = blocks * 32;
+  uint32_t a = ck_a + horizontalSum(sum128);
+  uint32_t b = ck_b + bytes * ck_a + 32 * horizontalSum(prefix128) + horizontalSum(weighted128);
+
+  ck_a = a;
+  ck_b = b;
+  checksumSse2(ck_a, ck_b, data + bytes, size - bytes);
+}
+
+#endif
+
+
+ChecksumKernel detectChecksumKernel()
+{
+  if (cpuFeatures().avx2)
+    return AVX2_CHECKSUM;
+
+  if (cpuFeatures().sse2)
+    return SSE2_CHECKSUM;
+
+  return SCALAR_CHECKSUM;
+}
+
+} // namespace
+
+
+void updateChecksum(uint8_t &ck_a, uint8_t &ck_b, const uint8_t *data, size_t size)
+{
+  if (size < VECTOR_THRESHOLD)
+    checksumScalar(ck_a, ck_b, data, size);
+  else
+    updateChecksum(activeChecksumKernel(), ck_a, ck_b, data, size);
+}
+
+
+void updateChecksum(ChecksumKernel kernel, uint8_t &ck_a, uint8_t &ck_b, const uint8_t *data, size_t size)
+{
+  if (kernel > activeChecksumKernel())
+    kernel = activeChecksumKernel();
+
+  switch (kernel)
+  {
+#ifdef GALILEO_X86
+  case AVX2_CHECKSUM:
+    checksumAvx2(ck_a, ck_b, data, size);
+    break;
+
+  case SSE2_CHECKSUM:
+    checksumSse2(ck_a, ck_b, data, size);
+    break;
+#endif
+
+  default:
+    checksumScalar(ck_a, ck_b, data, size);
+    break;
+  }
+}
+
+
+ChecksumKernel activeChecksumKernel()
+{
+  static const ChecksumKernel kernel = detectChecksumKernel();
+  return kernel;
+}
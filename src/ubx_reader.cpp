@@ -0,0 +1,269 @@
+#include "ubx_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+
+FileSource::~FileSource()
+{
+  if (owned_)
+    close(fd_);
+}
+
+
+bool FileSource::open(const std::string &path)
+{
+  if (path == "-")
+  {
+    fd_ = STDIN_FILENO;
+    owned_ = false;
+    return true;
+  }
+
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  owned_ = fd_ >= 0;
+
+  if (owned_)
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  return owned_;
+}
+
+
+bool FileSource::seek(uint64_t offset)
+{
+  return lseek(fd_, offset, SEEK_SET) == static_cast<off_t>(offset);
+}
+
+
+long FileSource::read(uint8_t *dst, size_t size)
+{
+  ssize_t count;
+
+  do
+    count = ::read(fd_, dst, size);
+  while (count < 0 && errno == EINTR);
+
+  return count;
+}
+
+
+namespace
+{
+
+bool baudRateSpeed(unsigned baud_rate, speed_t &speed)
+{
+  switch (baud_rate)
+  {
+  case 9600:
+    speed = B9600;
+    return true;
+
+  case 19200:
+    speed = B19200;
+    return true;
+
+  case 38400:
+    speed = B38400;
+    return true;
+
+  case 57600:
+    speed = B57600;
+    return true;
+
+  case 115200:
+    speed = B115200;
+    return true;
+
+  case 230400:
+    speed = B230400;
+    return true;
+
+  case 460800:
+    speed = B460800;
+    return true;
+
+  case 921600:
+    speed = B921600;
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+
+LiveSource::~LiveSource()
+{
+  if (owned_)
+    close(fd_);
+}
+
+
+bool LiveSource::isLive(const std::string &path)
+{
+  struct stat info;
+
+  if (path == "-")
+    return fstat(STDIN_FILENO, &info) == 0 && !S_ISREG(info.st_mode);
+
+  return stat(path.c_str(), &info) == 0 && (S_ISCHR(info.st_mode) || S_ISFIFO(info.st_mode) || S_ISSOCK(info.st_mode));
+}
+
+
+bool LiveSource::open(const std::string &path, unsigned baud_rate)
+{
+  if (path == "-")
+  {
+    // The flags of a shared standard input are left alone, reads wait in poll instead
+    fd_ = STDIN_FILENO;
+    owned_ = false;
+    return true;
+  }
+
+  // Non-blocking, so opening a serial port does not wait for carrier detect
+  fd_ = ::open(path.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+  owned_ = fd_ >= 0;
+
+  if (!owned_)
+    return false;
+
+  termios tty;
+
+  if (isatty(fd_) && tcgetattr(fd_, &tty) == 0)
+  {
+    speed_t speed;
+
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+
+    if (baud_rate != 0 && (!baudRateSpeed(baud_rate, speed) || cfsetispeed(&tty, speed) != 0 || cfsetospeed(&tty, speed) != 0))
+      return false;
+
+    tcsetattr(fd_, TCSANOW, &tty);
+  }
+
+  return true;
+}
+
+
+long LiveSource::read(uint8_t *dst, size_t size)
+{
+  return readReady(dst, size, -1);
+}
+
+
+long LiveSource::readAvailable(uint8_t *dst, size_t size)
+{
+  return readReady(dst, size, 0);
+}
+
+
+long LiveSource::readReady(uint8_t *dst, size_t size, int timeout_ms)
+{
+  while (true)
+  {
+    pollfd events = {fd_, POLLIN, 0};
+    int ready = poll(&events, 1, timeout_ms);
+
+    if (ready < 0 && errno != EINTR)
+      return -1;
+
+    if (ready <= 0)
+    {
+      if (timeout_ms == 0)
+        return 0; // Nothing has arrived yet
+
+      continue;
+    }
+
+    ssize_t count = ::read(fd_, dst, size);
+
+    if (count >= 0)
+      return count; // 0 when the writer of a FIFO or pipe is gone
+
+    // A hung up terminal fails with EIO, that is the end of the input too
+    if (errno == EIO)
+      return 0;
+
+    if (errno != EAGAIN && errno != EINTR)
+      return -1;
+
+    if (timeout_ms == 0)
+      return 0;
+  }
+}
+
+
+void BufferSource::assign(const uint8_t *data, size_t size)
+{
+  data_ = data;
+  size_ = size;
+}
+
+
+long BufferSource::read(uint8_t *dst, size_t size)
+{
+  size = std::min(size, size_);
+
+  if (size == 0)
+    return 0;
+
+  std::memcpy(dst, data_, size);
+  data_ += size;
+  size_ -= size;
+
+  return size;
+}
+
+
+ChunkBuffer::ChunkBuffer(size_t chunk_size) : chunk_size_(chunk_size) {}
+
+
+void ChunkBuffer::attach(ByteSource *source, uint64_t offset) 
+{ 
+  source_ = source; 
+  offset_ = offset;
+}
+
+
+bool ChunkBuffer::refill(const uint8_t *&cursor, const uint8_t *&end, size_t size, bool wait)
+{
+  if (source_ == nullptr)
+    return false;
+
+  size_t pending = (cursor == nullptr) ? 0 : end - cursor;
+
+  if (cursor != nullptr)
+    offset_ += cursor - buffer_.data();
+
+  if (pending > 0 && cursor != buffer_.data())
+    std::memmove(buffer_.data(), cursor, pending);
+
+  // One chunk always fits behind the largest frame the parser may hold
+  if (buffer_.size() < std::max(size, pending) + chunk_size_)
+    buffer_.resize(std::max(size, pending) + chunk_size_);
+
+  while (pending < size)
+  {
+    long count = wait ? source_->read(buffer_.data() + pending, buffer_.size() - pending)
+                      : source_->readAvailable(buffer_.data() + pending, buffer_.size() - pending);
+
+    if (count <= 0)
+      break;
+
+    pending += count;
+  }
+
+  cursor = buffer_.data();
+  end = cursor + pending;
+
+  return pending >= size;
+}
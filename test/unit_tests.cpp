@@ -1,11 +1,196 @@
 #include "galileo_solver.h"
+#include "almanac_store.h"
+#include "batch_driver.h"
+#include "field_kernel.h"
+#include "frame_index.h"
+#include "gst_clock.h"
+#include "inav_crc.h"
+#include "inav_fec2.h"
+#include "orbit_store.h"
+#include "ingest_server.h"
+#include "sync_scanner.h"
+#include "ubx_checksum.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <vector>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 #include "gtest/gtest.h"
 
+#ifdef GALILEO_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef GALILEO_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+
+// Wraps the payload into a UBX frame with sync headers and a valid checksum
+std::vector<uint8_t> makeFrame(uint8_t msg_class, uint8_t msg_id, const std::vector<uint8_t> &payload)
+{
+  std::vector<uint8_t> frame = {0xb5, 0x62, msg_class, msg_id,
+                                static_cast<uint8_t>(payload.size() & 0xff),
+                                static_cast<uint8_t>(payload.size() >> 8)};
+  frame.insert(frame.end(), payload.begin(), payload.end());
+
+  uint8_t ck_a = 0;
+  uint8_t ck_b = 0;
+  for (size_t i = 2; i < frame.size(); i++)
+  {
+    ck_a = ck_a + frame[i];
+    ck_b = ck_b + ck_a;
+  }
+  frame.push_back(ck_a);
+  frame.push_back(ck_b);
+
+  return frame;
+}
+
+
+// Galileo I/NAV page in an SFRBX frame. The 122 data bits after the word
+// type are filled from the seed and then the fields, given as first data
+// bit, bit count and value. The odd half has the right flags, a valid CRC
+// and a zero tail
+std::vector<uint8_t> makePage(uint8_t svId, uint8_t sigId, unsigned word_type, uint32_t seed,
+                              const std::vector<std::array<uint32_t, 3>> &fields = {})
+{
+  uint32_t data[4];
+  for (uint32_t &word : data)
+  {
+    seed = seed * 1664525 + 1013904223;
+    word = seed;
+  }
+
+  for (const auto &field : fields)
+    for (uint32_t i = 0; i < field[1]; i++)
+    {
+      uint32_t bit = field[0] + i;
+      uint32_t mask = 1u << (31 - bit % 32);
+      data[bit / 32] = ((field[2] >> (field[1] - 1 - i)) & 1) ? data[bit / 32] | mask : data[bit / 32] & ~mask;
+    }
+
+  // 128 bits of word type and data, most significant bit first
+  auto bits = [&](int first, int count) {
+    uint64_t value = 0;
+    for (int i = first; i < first + count; i++)
+    {
+      uint32_t bit = (i < 6) ? (word_type >> (5 - i)) & 1 : (data[(i - 6) / 32] >> (31 - (i - 6) % 32)) & 1;
+      value = (value << 1) | bit;
+    }
+    return static_cast<uint32_t>(value);
+  };
+
+  uint32_t dwords[8] = {bits(0, 30), bits(30, 32), bits(62, 32), bits(94, 18) << 14,
+                        0x80000000 | (bits(112, 16) << 14), 0, 0, 0};
+
+  uint32_t crc = inavCrc(dwords);
+  dwords[6] |= crc >> 10;
+  dwords[7] |= (crc & 0x3ff) << 22;
+
+  std::vector<uint8_t> sfrbx = {0x02, svId, sigId, 0x00, 0x08, 0x00, 0x02, 0x00};
+  for (uint32_t dword : dwords)
+    for (int i = 0; i < 4; i++)
+      sfrbx.push_back((dword >> (8 * i)) & 0xff);
+
+  return makeFrame(0x02, 0x13, sfrbx);
+}
+
+
+// The IODnav field of the words 1 to 4, all of one batch, no fields for the other words
+std::vector<std::array<uint32_t, 3>> ephemerisIod(unsigned word_type)
+{
+  if (word_type >= 1 && word_type <= 4)
+    return {{0, 10, 0x2c5}};
+
+  return {};
+}
+
+
+// Pages for the header and one ephemeris batch of a few satellites
+std::vector<uint8_t> makeEphemerisCapture()
+{
+  std::vector<uint8_t> capture;
+  uint32_t seed = 1;
+
+  for (uint8_t svId : {11, 12, 19, 26})
+    for (unsigned word_type : {10, 6, 1, 2, 3, 4, 5})
+    {
+      std::vector<uint8_t> page = makePage(svId, 1, word_type, seed++, ephemerisIod(word_type));
+      capture.insert(capture.end(), page.begin(), page.end());
+    }
+
+  return capture;
+}
+
+
+// A short capture with NAV-SIG, Galileo SFRBX, a corrupted frame and noise in between
+std::vector<uint8_t> makeCapture()
+{
+  std::vector<uint8_t> capture = {0x00, 0xb5, 0x13, 0x62};
+
+  std::vector<uint8_t> navsig = {0x10, 0x27, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00};
+  for (uint8_t gnss : {2, 0})
+  {
+    std::vector<uint8_t> sig = {gnss, 0x0b, 0x01, 0x00, 0x00, 0x00, 0x28, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    navsig.insert(navsig.end(), sig.begin(), sig.end());
+  }
+
+  std::vector<uint8_t> sfrbx = {0x02, 0x0b, 0x01, 0x00, 0x08, 0x00, 0x02, 0x00};
+  const uint32_t dwords[8] = {0x3f000000, 0, 0, 0, 0x80000000, 0, 0, 0}; // Word type 63 - Dummy
+  for (uint32_t dword : dwords)
+    for (int i = 0; i < 4; i++)
+      sfrbx.push_back((dword >> (8 * i)) & 0xff);
+
+  for (const auto &frame : {makeFrame(0x01, 0x43, navsig), makeFrame(0x02, 0x13, sfrbx), makeFrame(0x02, 0x15, {0xb5, 0x62, 0x01})})
+  {
+    capture.insert(capture.end(), frame.begin(), frame.end());
+    capture.push_back(0x42);
+  }
+
+  std::vector<uint8_t> corrupted = makeFrame(0x02, 0x13, sfrbx);
+  corrupted[20] ^= 0x01;
+  capture.insert(capture.end(), corrupted.begin(), corrupted.end());
+
+  return capture;
+}
+
+
+std::string writeCapture(const std::vector<uint8_t> &capture, const std::string &name = "galileo_capture.ubx")
+{
+  std::string path = testing::TempDir() + name;
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(capture.data()), capture.size());
+  return path;
+}
+
+
+std::string readOutput(const std::string &path, GalileoSolver::InputMode mode,
+                       size_t chunk_size = ChunkBuffer::DEFAULT_CHUNK_SIZE)
+{
+  std::ostringstream console, nav_data_file;
+  GalileoSolver solver(path, console, nav_data_file, mode, chunk_size);
+  solver.read();
+  return console.str();
+}
+
 struct GalileoSolverTest : public ::testing::Test
 {
+  std::ostringstream console, nav_data_file;
   GalileoSolver *test;
-  void SetUp() override {test = new GalileoSolver("");}
+  void SetUp() override {test = new GalileoSolver("", console, nav_data_file);}
   void TearDown() override {delete test;}
 };
 
@@ -63,22 +248,30 @@ TEST_F(GalileoSolverTest, DetermineWordTypeFalse)
   }
 }
 
-TEST_F(GalileoSolverTest, GetBits)
+TEST(InavPageTest, ReadsBitsWithoutCursor)
 {
-  std::vector<uint32_t> datawords = {0xc601029a, 0x31f71e26, 0xc0d5d048};
-  std::vector<std::vector<uint32_t>> parsed_datawords = {{0xc, 0x6, 0x1, 0x29a},
-                                                         {0x3, 0x1, 0xf7, 0x1e26},
+  const uint32_t words[8] = {0xc601029a, 0x31f71e26, 0xc0d5d048, 0, 0, 0, 0, 0};
+  const InavPage page(words);
+
+  EXPECT_EQ(page.evenOdd(), 1u);
+  EXPECT_EQ(page.pageType(), 1u);
+  EXPECT_EQ(page.wordType(), 0x6u);
+
+  // Words 1 and 2 follow the 30 bits of word 0, the same bits are read twice
+  std::vector<std::vector<uint32_t>> parsed_datawords = {{0x3, 0x1, 0xf7, 0x1e26},
                                                          {0xc, 0x0, 0xd5, 0xd048}};
 
-  uint8_t index = 0;
-  for (uint32_t dataword : datawords)
-  {
-    EXPECT_EQ(test->getBits(dataword, 4), parsed_datawords[index][0]);
-    EXPECT_EQ(test->getBits(dataword, 4), parsed_datawords[index][1]);
-    EXPECT_EQ(test->getBits(dataword, 8), parsed_datawords[index][2]);
-    EXPECT_EQ(test->getBits(dataword, 16), parsed_datawords[index][3]);
-    ++index;
-  }
+  for (int repeat = 0; repeat < 2; repeat++)
+    for (unsigned index = 0; index < parsed_datawords.size(); index++)
+    {
+      unsigned first = 30 + 32 * index;
+      EXPECT_EQ(page.bits(first, 4), parsed_datawords[index][0]);
+      EXPECT_EQ(page.bits(first + 4, 4), parsed_datawords[index][1]);
+      EXPECT_EQ(page.bits(first + 8, 8), parsed_datawords[index][2]);
+      EXPECT_EQ(page.bits(first + 16, 16), parsed_datawords[index][3]);
+    }
+
+  EXPECT_EQ(page.bits(30, 64), 0x31f71e26c0d5d048ull);
 }
 
 TEST_F(GalileoSolverTest, ConcatenateBits)
@@ -94,16 +287,1531 @@ TEST_F(GalileoSolverTest, ConcatenateBits)
   }
 }
 
-TEST_F(GalileoSolverTest, MaskWordMiddle)
+TEST(InavPageTest, JoinsEvenAndOddHalves)
+{
+  // Data bits of the even half end in word 3 above the tail, the odd half continues in word 4
+  const uint32_t words[8] = {0, 0, 0, 0xffffc000 | 0x3f00, 0xc0000000 | 0x3fffc000, 0, 0, 0};
+  const InavPage page(words);
+
+  EXPECT_EQ(page.bits(94, 34), 0x3ffffffffull);
+  EXPECT_EQ(page.bits(60, 34), 0u);
+  EXPECT_EQ(page.tail(), 0x3fu);
+  EXPECT_EQ(page.oddEvenOdd(), 1u);
+  EXPECT_EQ(page.oddPageType(), 1u);
+  EXPECT_FALSE(page.complete());
+}
+
+TEST(InavFieldTest, DescriptorsExtractPlacedFields)
+{
+  // Fields within one data word, across two and three words and in the odd half
+  std::vector<uint8_t> frame = makePage(11, 1, 17, 7, {{10, 32, 0x89abcdef}, {42, 32, 0x01234567},
+                                                       {74, 16, 0xfedc}, {106, 16, 0xaba9}});
+  uint32_t words[8];
+  std::memcpy(words, frame.data() + 6 + 8, sizeof(words));
+  const InavPage page(words);
+
+  EXPECT_TRUE(page.complete());
+  EXPECT_EQ(page.wordType(), 17u);
+  EXPECT_EQ(page.field<InavWord17::fec2_2>(), 0x89abcdef01234567ull);
+  EXPECT_EQ(page.field<InavWord2::longitude>(), static_cast<int32_t>(0x89abcdef));
+  EXPECT_EQ(page.field<InavWord2::perigee>() >> 16, static_cast<int16_t>(0xfedc));
+  EXPECT_EQ(page.field<InavWord2::ia_rate_of_change>(), (0xaba9 >> 2) - (1 << 14)); // Sign extended
+  EXPECT_EQ(page.field<InavWord2::reserved>(), 0xaba9 & 3u);
+
+  EXPECT_EQ(scaleField<InavWord1::reference_time>(10u), 600.0);
+  EXPECT_EQ(scaleField<InavWord2::ia_rate_of_change>(-1), -std::ldexp(M_PI, -43));
+}
+
+// Decodes the word of random pages with both kernels into zeroed structs
+template <class Word>
+void expectKernelsMatch(unsigned word_type)
+{
+  for (uint32_t seed = 0; seed < 64; seed++)
+  {
+    std::vector<uint8_t> frame = makePage(11, 1, word_type, seed * 7919);
+    uint32_t words[8];
+    std::memcpy(words, frame.data() + 6 + 8, sizeof(words));
+    const InavPage page(words);
+
+    Word expected, word;
+    std::memset(&expected, 0, sizeof(expected));
+    std::memset(&word, 0, sizeof(word));
+
+    decodeWord(SCALAR_FIELDS, page, expected);
+    decodeWord(BMI2_FIELDS, page, word);
+
+    EXPECT_EQ(std::memcmp(&word, &expected, sizeof(word)), 0) << "word type " << word_type << ", seed " << seed;
+  }
+}
+
+TEST(FieldKernelTest, Bmi2MatchesScalar)
+{
+  expectKernelsMatch<GalileoSolver::WordType1>(1);
+  expectKernelsMatch<GalileoSolver::WordType2>(2);
+  expectKernelsMatch<GalileoSolver::WordType3>(3);
+  expectKernelsMatch<GalileoSolver::WordType4>(4);
+  expectKernelsMatch<GalileoSolver::WordType5>(5);
+
+  // BMI2 is only used when asked for
+  EXPECT_EQ(activeFieldKernel(), SCALAR_FIELDS);
+}
+
+TEST(InavCrcTest, KernelsMatchBitwiseCrc)
+{
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  EXPECT_EQ(crc24q(check, sizeof(check)), 0xcde703u);
+
+  uint32_t seed = 5;
+
+  for (int page = 0; page < 200; page++)
+  {
+    uint32_t words[8];
+    for (uint32_t &word : words)
+    {
+      seed = seed * 1664525 + 1013904223;
+      word = seed;
+    }
+
+    // Four zero bits, the 114 bits of the even half and the 82 bits of the odd half
+    uint8_t message[25] = {};
+    unsigned bit = 4;
+    auto append = [&](uint32_t value, unsigned count) {
+      for (unsigned i = 0; i < count; i++, bit++)
+        message[bit / 8] |= ((value >> (count - 1 - i)) & 1) << (7 - bit % 8);
+    };
+    append(words[0], 32); append(words[1], 32); append(words[2], 32); append(words[3] >> 14, 18);
+    append(words[4], 32); append(words[5], 32); append(words[6] >> 14, 18);
+
+    const uint32_t expected = crc24q(message, sizeof(message));
+
+    EXPECT_EQ(inavCrc(TABLE_CRC, words), expected);
+    EXPECT_EQ(inavCrc(CLMUL_CRC, words), expected);
+  }
+}
+
+TEST(InavCrcTest, RejectsCorruptPages)
+{
+  std::vector<uint8_t> capture = makePage(11, 1, 6, 1);
+  std::vector<uint8_t> corrupt = makePage(12, 1, 6, 2);
+
+  // A flipped data bit with the UBX checksum recomputed over it
+  std::vector<uint8_t> payload(corrupt.begin() + 6, corrupt.end() - 2);
+  payload[8 + 9] ^= 0x10;
+  corrupt = makeFrame(0x02, 0x13, payload);
+  capture.insert(capture.end(), corrupt.begin(), corrupt.end());
+
+  std::string path = writeCapture(capture);
+  std::ostringstream console;
+  std::ostream nav_data_file(nullptr);
+  GalileoSolver solver(path, console, nav_data_file);
+
+  EXPECT_TRUE(solver.read());
+  EXPECT_EQ(solver.pageCount(), 1u);
+  EXPECT_EQ(solver.crcFailCount(), 1u);
+  EXPECT_EQ(solver.resyncCount(), 0u);
+
+  std::remove(path.c_str());
+}
+
+// Words 17 to 20 of the words 1 to 4, all of one IODnav
+std::array<InavPage, 4> makeFec2Pages(const std::array<InavPage, 4> &words)
+{
+  uint8_t info[FEC2_INFO_SIZE], parity[FEC2_PARITY_SIZE];
+
+  for (unsigned i = 0; i < 16; i++)
+    info[i] = words[0].bits(8 * i, 8);
+
+  for (unsigned word = 1; word < 4; word++)
+    for (unsigned i = 0; i < 14; i++)
+      info[16 + 14 * (word - 1) + i] = words[word].bits(16 + 8 * i, 8);
+
+  fec2Encode(info, parity);
+
+  std::array<InavPage, 4> pages;
+  const uint64_t iod_lsb = words[0].bits(6, 10) & 3;
+
+  for (unsigned word = 0; word < 4; word++)
+  {
+    const uint8_t *bytes = parity + 15 * word;
+    uint64_t high = uint64_t(17 + word) << 58 | uint64_t(bytes[0]) << 50 | iod_lsb << 48;
+    uint64_t low = 0;
+
+    for (int i = 1; i < 7; i++)
+      high |= uint64_t(bytes[i]) << (48 - 8 * i);
+
+    for (int i = 7; i < 15; i++)
+      low |= uint64_t(bytes[i]) << (112 - 8 * i);
+
+    pages[word] = InavPage(high, low);
+  }
+
+  return pages;
+}
+
+
+TEST(Fec2Test, EncodesKnownAnswer)
+{
+  // Parity of RS(255, 195) with the generator roots a^1..a^60, by long division
+  const uint8_t expected[FEC2_PARITY_SIZE] = {
+    0xa1, 0x21, 0xed, 0x88, 0x10, 0x24, 0xb1, 0x12, 0xd3, 0x53, 0x1c, 0xa6, 0x6d, 0x01, 0x2b,
+    0x41, 0x22, 0x3b, 0x88, 0xb6, 0x09, 0x0c, 0xd6, 0x33, 0xe1, 0xfb, 0x5e, 0x18, 0xd2, 0x22,
+    0xc1, 0xfa, 0xb0, 0xc7, 0x0d, 0x78, 0x9d, 0x6a, 0xa0, 0x37, 0x18, 0x0e, 0x67, 0xfe, 0x8a,
+    0xbb, 0x37, 0x6e, 0x22, 0xf0, 0xb9, 0x89, 0x53, 0x61, 0x09, 0xd3, 0xa8, 0xa8, 0x1a, 0xd9};
+
+  uint8_t code[FEC2_CODE_SIZE];
+  for (unsigned i = 0; i < FEC2_INFO_SIZE; i++)
+    code[i] = uint8_t(37 * i + 11);
+
+  fec2Encode(code, code + FEC2_INFO_SIZE);
+
+  for (unsigned i = 0; i < FEC2_PARITY_SIZE; i++)
+    EXPECT_EQ(code[FEC2_INFO_SIZE + i], expected[i]) << "parity byte " << i;
+
+  // The first 60 bytes erased come back
+  bool erased[FEC2_CODE_SIZE] = {};
+  uint8_t damaged[FEC2_CODE_SIZE];
+  for (unsigned i = 0; i < FEC2_CODE_SIZE; i++)
+  {
+    erased[i] = i < FEC2_PARITY_SIZE;
+    damaged[i] = erased[i] ? 0 : code[i];
+  }
+
+  EXPECT_TRUE(fec2Decode(damaged, erased));
+  EXPECT_EQ(std::memcmp(damaged, code, FEC2_CODE_SIZE), 0);
+}
+
+
+TEST(Fec2Test, RebuildsFromAnyFiveWords)
+{
+  std::array<InavPage, 4> words;
+  uint64_t seed = 1;
+  const uint64_t iod = 0x2c5;
+
+  for (unsigned word = 0; word < 4; word++)
+  {
+    uint64_t high = 0, low = 0;
+    for (uint64_t *half : {&high, &low})
+      *half = seed = seed * 6364136223846793005 + 1442695040888963407;
+
+    high = uint64_t(word + 1) << 58 | iod << 48 | (high & 0xffffffffffff);
+    words[word] = InavPage(high, low);
+  }
+
+  std::array<InavPage, 4> fec2 = makeFec2Pages(words);
+
+  // Every choice of 5 of the 8 words rebuilds the missing words 1 to 4,
+  // 4 of them rebuild nothing
+  for (unsigned known = 0; known < 256; known++)
+  {
+    const size_t count = std::bitset<8>(known).count();
+
+    if (count != 4 && count != 5)
+      continue;
+
+    Fec2Recovery recovery;
+    for (unsigned word = 0; word < 8; word++)
+    {
+      if (known & (1u << word))
+      {
+        EXPECT_TRUE(recovery.add(word < 4 ? words[word] : fec2[word - 4]));
+      }
+    }
+
+    InavPage pages[4];
+    EXPECT_EQ(recovery.recover(pages), (count == 5) ? ~known & 0xf : 0u);
+
+    if (count == 4)
+      continue;
+
+    for (unsigned word = 0; word < 4; word++)
+    {
+      if (~known & (1u << word))
+      {
+        EXPECT_EQ(pages[word].high(), words[word].high());
+        EXPECT_EQ(pages[word].low(), words[word].low());
+      }
+    }
+
+    EXPECT_EQ(recovery.recover(pages), 0u);
+  }
+
+  // Too few words, and a corrupt word among more than enough of them
+  Fec2Recovery recovery;
+  InavPage pages[4];
+  for (const InavPage &page : {words[0], words[1], fec2[0]})
+    recovery.add(page);
+  EXPECT_EQ(recovery.recover(pages), 0u);
+
+  recovery.add(InavPage(fec2[1].high() ^ 1, fec2[1].low()));
+  recovery.add(fec2[2]);
+  EXPECT_EQ(recovery.recover(pages), 0u);
+
+  recovery.add(fec2[3]);
+  EXPECT_EQ(recovery.recover(pages), 0u);
+
+  // FEC2 words of another IODnav start over
+  recovery.clear();
+  for (const InavPage &page : {words[0], words[1], words[2]})
+    recovery.add(page);
+  recovery.add(InavPage(fec2[0].high() ^ uint64_t(1) << 48, fec2[0].low()));
+  EXPECT_EQ(recovery.recover(pages), 0u);
+}
+
+
+TEST(Fec2Test, LostWordJoinsNavigationData)
+{
+  std::vector<uint8_t> complete, recovered;
+  std::array<InavPage, 4> words;
+  uint32_t seed = 1;
+
+  for (unsigned word_type : {10, 6, 1, 2, 3, 4, 5})
+  {
+    std::vector<uint8_t> page = makePage(11, 1, word_type, seed++, {{0, 10, 0x2c5}});
+    complete.insert(complete.end(), page.begin(), page.end());
+
+    if (word_type >= 1 && word_type <= 4)
+    {
+      uint32_t dwords[8];
+      std::memcpy(dwords, page.data() + 6 + 8, sizeof(dwords));
+      words[word_type - 1] = InavPage(dwords);
+    }
+
+    if (word_type != 2)
+      recovered.insert(recovered.end(), page.begin(), page.end());
+  }
+
+  // Words 17 and 18 after the batch complete it without word 2
+  std::array<InavPage, 4> fec2 = makeFec2Pages(words);
+
+  for (unsigned word = 0; word < 2; word++)
+  {
+    std::vector<std::array<uint32_t, 3>> fields = {{120, 2, uint32_t(fec2[word].bits(126, 2))}};
+    for (unsigned i = 0; i < 15; i++)
+      fields.push_back({8 * i, 8, uint32_t(fec2[word].bits(6 + 8 * i, 8))});
+
+    std::vector<uint8_t> page = makePage(11, 1, 17 + word, seed++, fields);
+    recovered.insert(recovered.end(), page.begin(), page.end());
+  }
+
+  std::string path = writeCapture(complete);
+  std::ostringstream console, nav_data_file;
+  GalileoSolver(path, console, nav_data_file).read();
+
+  std::string recovered_path = writeCapture(recovered, "galileo_fec2.ubx");
+  std::ostringstream recovered_console, recovered_nav_data;
+  GalileoSolver solver(recovered_path, recovered_console, recovered_nav_data);
+  solver.read();
+
+  EXPECT_EQ(solver.fec2RecoveredCount(), 1u);
+  EXPECT_NE(nav_data_file.str().find("\nE11\t"), std::string::npos);
+  EXPECT_EQ(recovered_nav_data.str(), nav_data_file.str());
+
+  std::remove(path.c_str());
+  std::remove(recovered_path.c_str());
+}
+
+TEST(OrbitTest, KeplerStateKeepsOrbitRadius)
+{
+  KeplerOrbit orbit;
+  orbit.root_semi_major_axis = std::sqrt(29600000.0);
+  orbit.eccentricity = 0.01;
+  orbit.inclination = 56.0 / 180 * M_PI;
+  orbit.toe = orbit.toc = 1300 * 604800.0;
+  orbit.af0 = 1e-4;
+
+  auto radius = [&](double t) {
+    SatelliteState state = keplerState(orbit, orbit.toe + t);
+    return std::hypot(state.position[0], state.position[1], state.position[2]);
+  };
+
+  // Perigee at the reference time, apogee half a period later
+  const double a = 29600000.0;
+  const double half_period = M_PI * std::sqrt(a * a * a / 3.986004418e14);
+
+  EXPECT_NEAR(radius(0), a * 0.99, 1e-3);
+  EXPECT_NEAR(radius(half_period), a * 1.01, 1e-3);
+  EXPECT_GT(radius(1000), a * 0.99);
+  EXPECT_LT(radius(1000), a * 1.01);
+
+  SatelliteState state = keplerState(orbit, orbit.toe + half_period / 2);
+  EXPECT_LE(std::fabs(state.position[2]), a * 1.01 * std::sin(orbit.inclination));
+
+  EXPECT_NEAR(keplerState(orbit, orbit.toe).clock_offset, 1e-4, 1e-12); // No relativistic term at perigee
+}
+
+
+TEST(OrbitTest, ReducedDataUntilFullEphemeris)
+{
+  const uint32_t week = 1300, time_of_week = 345600;
+  const double gst = week * 604800.0 + time_of_week;
+
+  // Word 5 sets the page clock, word 16 on the next page has a nominal circular orbit
+  std::vector<uint8_t> capture = makePage(11, 1, 5, 1, {{67, 12, week}, {79, 20, time_of_week}});
+  std::vector<uint8_t> reduced = makePage(11, 1, 16, 2, {{0, 31, 0}, {31, 17, 0}});
+  capture.insert(capture.end(), reduced.begin(), reduced.end());
+
+  std::string path = writeCapture(capture);
+  std::ostringstream console, nav_data_file;
+  GalileoSolver solver(path, console, nav_data_file);
+  EXPECT_TRUE(solver.read());
+
+  SatelliteState state;
+  EXPECT_EQ(solver.orbits().state(11, gst + 2, state), OrbitStore::REDUCED);
+  EXPECT_NEAR(std::hypot(state.position[0], state.position[1], state.position[2]), 29600000.0, 1e-3);
+  EXPECT_EQ(solver.orbits().source(11, gst + 2 + 3600), OrbitStore::NONE);
+  EXPECT_EQ(solver.orbits().source(12, gst + 2), OrbitStore::NONE);
+
+  // Words 1 to 5 of one IODnav, toe 10 minutes later
+  uint32_t seed = 3;
+  for (unsigned word_type : {1, 2, 3, 4, 5})
+  {
+    std::vector<std::array<uint32_t, 3>> fields = {{0, 10, 0x2c5}};
+    if (word_type == 1)
+      fields.push_back({10, 14, (time_of_week + 600) / 60});
+    if (word_type == 3)
+      fields.push_back({114, 8, 40});
+    if (word_type == 5)
+      fields = {{67, 12, week}, {79, 20, time_of_week + 12}};
+
+    std::vector<uint8_t> page = makePage(11, 1, word_type, seed++, fields);
+    capture.insert(capture.end(), page.begin(), page.end());
+  }
+
+  writeCapture(capture);
+  GalileoSolver full_solver(path, console, nav_data_file);
+  EXPECT_TRUE(full_solver.read());
+
+  EXPECT_EQ(full_solver.orbits().source(11, gst + 2), OrbitStore::FULL);
+  EXPECT_EQ(full_solver.orbits().source(11, gst + 3 * 3600), OrbitStore::FULL);
+
+  std::remove(path.c_str());
+}
+
+
+TEST(OrbitTest, IgnoresSatellitesOutOfRange)
+{
+  KeplerOrbit orbit;
+  orbit.toe = orbit.toc = 1300 * 604800.0;
+
+  OrbitStore store;
+  for (unsigned svId : {0u, 37u, 255u})
+  {
+    store.setEphemeris(svId, orbit);
+    store.setReduced(svId, orbit);
+  }
+
+  for (unsigned svId = 1; svId <= 36; svId++)
+    EXPECT_EQ(store.source(svId, orbit.toe), OrbitStore::NONE);
+}
+
+
+// Word with the given fields, as first data bit, bit count and value, and the other bits zero
+InavPage makeWord(unsigned word_type, const std::vector<std::array<uint32_t, 3>> &fields)
+{
+  uint64_t high = uint64_t(word_type) << 58, low = 0;
+
+  for (const auto &field : fields)
+    for (uint32_t i = 0; i < field[1]; i++)
+      if ((field[2] >> (field[1] - 1 - i)) & 1)
+      {
+        uint32_t bit = 6 + field[0] + i;
+        (bit < 64 ? high : low) |= 1ull << (63 - bit % 64);
+      }
+
+  return InavPage(high, low);
+}
+
+
+TEST(AlmanacTest, StoresThreeSatellitesPerSet)
+{
+  AlmanacStore store;
+  const uint32_t iod = 5;
+
+  EXPECT_EQ(store.add(makeWord(7, {{0, 4, iod}, {4, 2, 3}, {6, 10, 100}, {16, 6, 11}}), 19, 1), nullptr);
+
+  const Almanac *first = store.add(makeWord(8, {{0, 4, iod}, {4, 16, 0x100}, {37, 6, 12}}), 19, 1);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first->svid, 11u);
+  EXPECT_EQ(first->week_num, 3u);
+  EXPECT_EQ(first->ref_time, 60000u);
+  EXPECT_DOUBLE_EQ(first->clock_corr_bias, 0x100 / 524288.0);
+
+  const Almanac *second = store.add(makeWord(9, {{0, 4, iod}, {4, 2, 3}, {6, 10, 100}, {65, 6, 13}}), 19, 1);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(second->svid, 12u);
+  EXPECT_EQ(second->ref_time, 60000u);
+
+  const Almanac *third = store.add(makeWord(10, {{0, 4, iod}, {78, 2, 2}}), 19, 1);
+  ASSERT_NE(third, nullptr);
+  EXPECT_EQ(third->svid, 13u);
+  EXPECT_EQ(third->sig_health_e1, 2u);
+
+  EXPECT_EQ(store.count(), 3u);
+  EXPECT_NE(store.find(12, iod), nullptr);
+  EXPECT_EQ(store.find(12, iod + 1), nullptr);
+  EXPECT_EQ(store.find(14), nullptr);
+
+  store.clear();
+  EXPECT_EQ(store.count(), 0u);
+}
+
+
+TEST(AlmanacTest, RejectsHalvesOfDifferentSets)
+{
+  AlmanacStore store;
+
+  // A lost word 8, the word 9 does not complete the SVID1 of word 7
+  store.add(makeWord(7, {{0, 4, 5}, {16, 6, 11}}), 19, 1);
+  EXPECT_EQ(store.add(makeWord(9, {{0, 4, 5}, {65, 6, 13}}), 19, 1), nullptr);
+
+  // An IODa change between the words
+  store.add(makeWord(7, {{0, 4, 5}, {16, 6, 11}}), 19, 1);
+  EXPECT_EQ(store.add(makeWord(8, {{0, 4, 6}, {37, 6, 12}}), 19, 1), nullptr);
+
+  // The other signal and transmitter keep their own partial almanacs
+  store.add(makeWord(7, {{0, 4, 5}, {16, 6, 11}}), 19, 1);
+  EXPECT_EQ(store.add(makeWord(8, {{0, 4, 5}, {37, 6, 0}}), 19, 5), nullptr);
+  EXPECT_EQ(store.add(makeWord(8, {{0, 4, 5}, {37, 6, 0}}), 20, 1), nullptr);
+
+  // The word 8 completes SVID1, its dummy SVID2 is not stored
+  EXPECT_NE(store.add(makeWord(8, {{0, 4, 5}, {37, 6, 0}}), 19, 1), nullptr);
+  EXPECT_EQ(store.add(makeWord(9, {{0, 4, 5}, {65, 6, 13}}), 19, 1), nullptr);
+  EXPECT_EQ(store.count(), 1u);
+
+  // Pages of other signals are ignored
+  EXPECT_EQ(store.add(makeWord(7, {{0, 4, 5}, {16, 6, 14}}), 19, 3), nullptr);
+  EXPECT_EQ(store.add(makeWord(8, {{0, 4, 5}, {37, 6, 15}}), 19, 3), nullptr);
+}
+
+
+TEST(AlmanacTest, RecordReachesConsoleWithoutEphemeris)
+{
+  // An almanac set as the last data of the capture, with no ephemeris after it
+  std::vector<uint8_t> capture;
+  uint32_t seed = 1;
+
+  for (const auto &word : std::vector<std::pair<unsigned, std::vector<std::array<uint32_t, 3>>>>{
+         {7, {{0, 4, 5}, {4, 2, 3}, {6, 10, 100}, {16, 6, 11}}},
+         {8, {{0, 4, 5}, {37, 6, 12}}},
+         {9, {{0, 4, 5}, {4, 2, 3}, {6, 10, 100}, {65, 6, 13}}},
+         {10, {{0, 4, 5}}}})
+  {
+    std::vector<uint8_t> page = makePage(19, 1, word.first, seed++, word.second);
+    capture.insert(capture.end(), page.begin(), page.end());
+  }
+
+  std::string path = writeCapture(capture);
+  std::ostringstream console, nav_data_file;
+  GalileoSolver solver(path, console, nav_data_file);
+  EXPECT_TRUE(solver.read());
+
+  for (const char *svid : {"SV ID: 11\n", "SV ID: 12\n", "SV ID: 13\n"})
+    EXPECT_NE(console.str().find(svid), std::string::npos) << svid;
+
+  std::remove(path.c_str());
+}
+
+
+TEST(AlmanacTest, OrbitInWeekOfReferenceTime)
+{
+  Almanac almanac;
+  almanac.week_num = 1301 % 4;
+  almanac.ref_time = 600;
+
+  // Just before the end of week 1300, the reference time is early in the next week
+  KeplerOrbit orbit = almanacOrbit(almanac, 1300 * 604800.0 + 604000);
+  EXPECT_DOUBLE_EQ(orbit.toe, 1301 * 604800.0 + 600);
+
+  SatelliteState state = keplerState(orbit, orbit.toe);
+  EXPECT_NEAR(std::hypot(state.position[0], state.position[1], state.position[2]), 29600000.0, 1e-3);
+}
+
+
+TEST(GstClockTest, StampsPagesAcrossWeeks)
+{
+  const uint32_t WEEK = 604800;
+  GstClock clock;
+
+  // Word 6 has no week and waits for a time word
+  EXPECT_EQ(clock.stamp(makeWord(6, {{99, 20, 100}}), 11, 1), GstClock::UNKNOWN);
+  EXPECT_EQ(clock.stamp(makeWord(5, {{67, 12, 1300}, {79, 20, WEEK - 4}}), 11, 1), 1300 * WEEK + WEEK - 4);
+  EXPECT_EQ(clock.stamp(makeWord(1, {}), 11, 1), 1300 * WEEK + WEEK - 2);
+
+  // A lost page, word 6 sets the time of week in the next week
+  EXPECT_EQ(clock.stamp(makeWord(6, {{99, 20, 4}}), 11, 1), 1301 * WEEK + 4);
+  EXPECT_EQ(clock.pageTime(11, 1), 1301 * WEEK + 4);
+  EXPECT_EQ(clock.pageTime(11, 5), GstClock::UNKNOWN);
+  EXPECT_EQ(clock.now(), 1301 * WEEK + 4);
+  EXPECT_EQ(GstClock::fromTimeOfWeek(1300 * WEEK + WEEK - 10, 10), 1301 * WEEK + 10);
+
+  // The 12 bit week number rolls over
+  GstClock rollover;
+  EXPECT_EQ(rollover.stamp(makeWord(0, {{0, 2, 2}, {90, 12, 4095}, {102, 20, WEEK - 2}}), 12, 5), 4095 * WEEK + WEEK - 2);
+  EXPECT_EQ(rollover.stamp(makeWord(5, {{67, 12, 0}, {79, 20, 0}}), 12, 5), 4096 * WEEK);
+  EXPECT_EQ(GstClock::fromWeek(4095, 0, GstClock::UNKNOWN), 4095 * WEEK);
+  EXPECT_EQ(GstClock::fromWeek(4095, 0, 3 * WEEK), 4095 * WEEK);
+
+  EXPECT_EQ(nearestWeek(2, 2, 1301), 1302);
+  EXPECT_EQ(nearestWeek(3, 2, 1300), 1299);
+
+  // Satellites out of range have no page clock
+  GstClock unknown;
+  for (unsigned svId : {0u, 37u, 255u})
+  {
+    EXPECT_EQ(unknown.stamp(makeWord(5, {{67, 12, 1300}, {79, 20, 100}}), svId, 1), GstClock::UNKNOWN);
+    EXPECT_EQ(unknown.pageTime(svId, 1), GstClock::UNKNOWN);
+  }
+  EXPECT_EQ(unknown.now(), GstClock::UNKNOWN);
+}
+
+
+TEST(GstClockTest, ConvertsToUtcAndGps)
+{
+  const double WEEK = 604800;
+  const double gst = 1300 * WEEK + 1000;
+  GstClock clock;
+
+  // The leap second table and GST as GPS time until the parameters arrive
+  EXPECT_EQ(leapSeconds(gst), 18);
+  EXPECT_EQ(leapSeconds(1000), 13);
+  EXPECT_DOUBLE_EQ(clock.toUtc(gst), gst - 18);
+  EXPECT_DOUBLE_EQ(clock.fromUtc(gst - 18), gst);
+  EXPECT_DOUBLE_EQ(clock.toGps(gst), gst + 1024 * WEEK);
+
+  // A0 of 2^-10 s, a leap second at the end of the Saturday of the week
+  clock.stamp(makeWord(6, {{0, 32, 1 << 20}, {56, 8, 18}, {72, 8, 1300 % 256}, {80, 8, 1300 % 256},
+                           {88, 3, 7}, {91, 8, 19}}), 11, 1);
+  EXPECT_TRUE(clock.hasUtc());
+  EXPECT_DOUBLE_EQ(clock.toUtc(gst), gst - 18 - std::ldexp(1, -10));
+  EXPECT_DOUBLE_EQ(clock.toUtc(1301 * WEEK + 17), 1301 * WEEK + 17 - 18 - std::ldexp(1, -10));
+  EXPECT_DOUBLE_EQ(clock.toUtc(1301 * WEEK + 100), 1301 * WEEK + 100 - 19 - std::ldexp(1, -10));
+  EXPECT_NEAR(clock.fromUtc(clock.toUtc(gst)), gst, 1e-9);
+  EXPECT_NEAR(clock.fromUtc(clock.toUtc(1301 * WEEK + 100)), 1301 * WEEK + 100, 1e-9);
+
+  // A0G of 2^-25 s
+  clock.stamp(makeWord(10, {{80, 16, 1 << 10}, {116, 6, 1300 % 64}}), 11, 1);
+  EXPECT_TRUE(clock.hasGgto());
+  EXPECT_DOUBLE_EQ(clock.toGps(gst), gst + 1024 * WEEK - std::ldexp(1, -25));
+  EXPECT_NEAR(clock.fromGps(clock.toGps(gst)), gst, 1e-9);
+}
+
+
+TEST(StagingTest, InterleavedIodsCompleteSeparately)
+{
+  std::vector<uint8_t> capture;
+  uint32_t seed = 1;
+
+  auto add = [&](unsigned word_type, uint32_t iod) {
+    std::vector<uint8_t> page = makePage(11, 1, word_type, seed++, {{0, 10, iod}});
+    capture.insert(capture.end(), page.begin(), page.end());
+  };
+
+  // The words 3 and 4 of the IODnav 100 arrive after an upload of the IODnav 101
+  for (unsigned word_type : {10, 6, 5})
+    add(word_type, 0);
+  add(1, 100);
+  add(2, 100);
+  for (unsigned word_type : {1, 2, 3, 4})
+    add(word_type, 101);
+  add(3, 100);
+  add(4, 100);
+  add(5, 0);
+
+  std::string path = writeCapture(capture);
+  std::ostringstream console, nav_data_file;
+  GalileoSolver solver(path, console, nav_data_file);
+  EXPECT_TRUE(solver.read());
+
+  // Each IODnav is written once and whole, the upload as soon as its words are in
+  const std::string nav_data = nav_data_file.str();
+  const size_t upload = nav_data.find("\t1.010000000000e+02\t");
+  const size_t previous = nav_data.find("\t1.000000000000e+02\t");
+
+  ASSERT_NE(upload, std::string::npos);
+  ASSERT_NE(previous, std::string::npos);
+  EXPECT_LT(upload, previous);
+  EXPECT_EQ(nav_data.find("\nE11\t", nav_data.find("\nE11\t", nav_data.find("\nE11\t") + 1) + 1), std::string::npos);
+
+  std::remove(path.c_str());
+}
+
+
+TEST(InputModeTest, MappedMatchesStream)
+{
+  std::string path = writeCapture(makeCapture());
+
+  std::string stream_output = readOutput(path, GalileoSolver::STREAM);
+  std::string mapped_output = readOutput(path, GalileoSolver::MMAP);
+
+  EXPECT_NE(stream_output.find("UBX-RXM-SFRBX: 1"), std::string::npos);
+  EXPECT_NE(stream_output.find("checksum false"), std::string::npos);
+  EXPECT_EQ(stream_output, mapped_output);
+
+  std::remove(path.c_str());
+}
+
+TEST(InputModeTest, FramesSplitAcrossChunks)
+{
+  std::string path = writeCapture(makeCapture());
+  std::string mapped_output = readOutput(path, GalileoSolver::MMAP);
+
+  for (size_t chunk_size : {1, 3, 7, 16, 61})
+    EXPECT_EQ(readOutput(path, GalileoSolver::STREAM, chunk_size), mapped_output);
+
+  std::remove(path.c_str());
+}
+
+TEST(InputModeTest, AsyncReadsMatchStream)
+{
+  std::vector<uint8_t> capture;
+
+  for (int i = 0; i < 40; i++)
+  {
+    std::vector<uint8_t> part = (i % 2) ? makeEphemerisCapture() : makeCapture();
+    capture.insert(capture.end(), part.begin(), part.end());
+  }
+
+  std::string path = writeCapture(capture);
+
+  // Small blocks, so the blocks are reused many times and the last one is short
+  for (bool direct : {false, true})
+  {
+    AsyncFileSource source(4096, 3);
+    ASSERT_TRUE(source.open(path, direct));
+
+    std::vector<uint8_t> read(capture.size() + 1);
+    size_t size = 0;
+    long count;
+
+    while ((count = source.read(read.data() + size, std::min<size_t>(1000, read.size() - size))) > 0)
+      size += count;
+
+    EXPECT_EQ(count, 0);
+    read.resize(size);
+    EXPECT_TRUE(read == capture) << "direct " << direct;
+  }
+
+  std::string stream_output = readOutput(path, GalileoSolver::STREAM);
+
+  EXPECT_EQ(readOutput(path, GalileoSolver::ASYNC), stream_output);
+  EXPECT_EQ(readOutput(path, GalileoSolver::DIRECT, 61), stream_output);
+
+  std::remove(path.c_str());
+}
+
+// Compresses each part on its own, so the result has several gzip members or zstd frames
+std::vector<uint8_t> compress(CompressedSource::Format format, const std::vector<std::vector<uint8_t>> &parts)
+{
+  std::vector<uint8_t> compressed;
+
+  for (const std::vector<uint8_t> &part : parts)
+  {
+    std::vector<uint8_t> block(part.size() + 1024);
+    size_t size = 0;
+
+#ifdef GALILEO_HAVE_ZLIB
+    if (format == CompressedSource::GZIP)
+    {
+      z_stream stream{};
+      deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+      stream.next_in = const_cast<Bytef *>(part.data());
+      stream.avail_in = part.size();
+      stream.next_out = block.data();
+      stream.avail_out = block.size();
+
+      deflate(&stream, Z_FINISH);
+      size = stream.total_out;
+      deflateEnd(&stream);
+    }
+#endif
+
+#ifdef GALILEO_HAVE_ZSTD
+    if (format == CompressedSource::ZSTD)
+      size = ZSTD_compress(block.data(), block.size(), part.data(), part.size(), 3);
+#endif
+
+    compressed.insert(compressed.end(), block.begin(), block.begin() + size);
+  }
+
+  return compressed;
+}
+
+TEST(InputModeTest, CompressedMatchesPlain)
+{
+  std::vector<uint8_t> first = makeCapture();
+  std::vector<uint8_t> second = makeEphemerisCapture();
+
+  std::vector<uint8_t> capture = first;
+  capture.insert(capture.end(), second.begin(), second.end());
+
+  std::string path = writeCapture(capture);
+  std::string plain_output = readOutput(path, GalileoSolver::STREAM);
+
+  for (CompressedSource::Format format : {CompressedSource::GZIP, CompressedSource::ZSTD})
+  {
+    if (!CompressedSource::supported(format))
+      continue;
+
+    std::vector<uint8_t> compressed = compress(format, {first, second});
+    ASSERT_FALSE(compressed.empty());
+
+    std::string compressed_path = writeCapture(compressed, "galileo_capture.ubx.z");
+    EXPECT_EQ(CompressedSource::detect(compressed_path), format);
+
+    for (size_t chunk_size : {7, 61, 4096})
+      EXPECT_EQ(readOutput(compressed_path, GalileoSolver::STREAM, chunk_size), plain_output) << format;
+
+    // A memory mapped read streams and decompresses too
+    EXPECT_EQ(readOutput(compressed_path, GalileoSolver::MMAP), plain_output) << format;
+
+    // A cut off capture keeps what was decompressed and says so
+    compressed.resize(compressed.size() - 20);
+    writeCapture(compressed, "galileo_capture.ubx.z");
+    EXPECT_NE(readOutput(compressed_path, GalileoSolver::STREAM).find("Compressed data is corrupt"), std::string::npos);
+
+    std::remove(compressed_path.c_str());
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST(InputModeTest, SkipsUnhandledFramesByLength)
+{
+  // A valid SFRBX frame nested in the payload of an unhandled message and
+  // a sync header byte right before the next frame
+  std::vector<uint8_t> nested = makeCapture();
+  std::vector<uint8_t> capture = makeFrame(0x02, 0x15, nested);
+  capture.push_back(0xb5);
+  std::vector<uint8_t> navsig = makeFrame(0x01, 0x43, {0x10, 0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+  capture.insert(capture.end(), navsig.begin(), navsig.end());
+
+  std::string path = writeCapture(capture);
+  std::string output = readOutput(path, GalileoSolver::STREAM);
+
+  EXPECT_NE(output.find("UBX-RXM-SFRBX: 0"), std::string::npos);
+  EXPECT_NE(output.find("UBX-NAV-SIG: 1"), std::string::npos);
+  EXPECT_NE(output.find("Skipped frames: 1"), std::string::npos);
+  EXPECT_EQ(output.find("checksum false"), std::string::npos);
+
+  std::remove(path.c_str());
+}
+
+TEST(InputModeTest, SkipsSatellitesOutOfRange)
+{
+  // Pages of every word type the solver keeps per satellite, from satellites 0 and 40
+  std::vector<uint8_t> capture;
+  uint32_t seed = 1;
+
+  for (unsigned svId : {0, 40})
+    for (unsigned word_type : {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 16, 17, 18, 19, 20})
+    {
+      std::vector<uint8_t> page = makePage(svId, 1, word_type, seed++);
+      capture.insert(capture.end(), page.begin(), page.end());
+    }
+
+  std::vector<uint8_t> valid = makePage(11, 1, 5, seed++);
+  capture.insert(capture.end(), valid.begin(), valid.end());
+
+  std::string path = writeCapture(capture);
+
+  for (GalileoSolver::InputMode mode : {GalileoSolver::STREAM, GalileoSolver::MMAP})
+  {
+    std::ostringstream console, nav_data_file;
+    GalileoSolver solver(path, console, nav_data_file, mode);
+
+    EXPECT_TRUE(solver.read());
+    EXPECT_EQ(solver.pageCount(), 1u);
+    EXPECT_EQ(solver.fec2RecoveredCount(), 0u);
+  }
+
+  std::ostringstream console, nav_data_file;
+  GalileoSolver solver(path, console, nav_data_file, GalileoSolver::MMAP);
+  solver.readParallel(3, 64);
+  EXPECT_EQ(solver.pageCount(), 1u);
+
+  std::remove(path.c_str());
+}
+
+TEST(InputModeTest, ParallelMatchesSerial)
+{
+  // Nested captures make some range workers start on frames that the
+  // serial read jumps over, the unknown GNSS id prints a warning
+  std::vector<uint8_t> unknown_gnss = makeFrame(0x01, 0x43, {0x10, 0x27, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+                                                             0x04, 0x0b, 0x01, 0x00, 0x00, 0x00, 0x28, 0x07,
+                                                             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+  std::vector<uint8_t> capture;
+  for (int i = 0; i < 20; i++)
+  {
+    std::vector<uint8_t> part = (i % 3 == 0) ? makeFrame(0x02, 0x15, makeCapture()) : makeCapture();
+    capture.insert(capture.end(), part.begin(), part.end());
+    capture.insert(capture.end(), unknown_gnss.begin(), unknown_gnss.end());
+  }
+
+  std::string path = writeCapture(capture);
+  std::string serial = readOutput(path, GalileoSolver::MMAP);
+
+  for (unsigned threads : {1, 3})
+  {
+    for (size_t range_size : {1, 5, 37, 64, 500, 100000})
+    {
+      std::ostringstream console, nav_data_file;
+      GalileoSolver solver(path, console, nav_data_file, GalileoSolver::MMAP);
+      solver.readParallel(threads, range_size);
+
+      EXPECT_EQ(console.str(), serial) << threads << " threads, " << range_size << " byte ranges";
+    }
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST(BatchTest, ConvertsOnceAndSkipsCopies)
+{
+  namespace fs = std::filesystem;
+
+  const fs::path dir = fs::path(testing::TempDir()) / "galileo_batch";
+  fs::remove_all(dir);
+  fs::create_directories(dir / "in" / "sub");
+
+  std::vector<uint8_t> capture = makeCapture();
+  std::vector<uint8_t> nested = makeFrame(0x02, 0x15, capture);
+
+  for (const auto &file : {std::make_pair("in/a.ubx", capture), std::make_pair("in/b.ubx", nested),
+                           std::make_pair("in/sub/a_copy.ubx", capture)})
+  {
+    std::ofstream out(dir / file.first, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(file.second.data()), file.second.size());
+  }
+
+  BatchDriver first((dir / "out").string(), 2);
+  ASSERT_TRUE(first.addInput((dir / "in").string()));
+
+  testing::internal::CaptureStdout();
+  EXPECT_TRUE(first.run());
+  testing::internal::GetCapturedStdout();
+
+  ASSERT_EQ(first.results().size(), 3u);
+  EXPECT_EQ(first.results()[0].status, BatchResult::CONVERTED);
+  EXPECT_EQ(first.results()[1].status, BatchResult::CONVERTED);
+  EXPECT_EQ(first.results()[2].status, BatchResult::SKIPPED);
+  EXPECT_EQ(first.results()[0].hash, first.results()[2].hash);
+
+  // The per file log is the console output of a single solver
+  std::ifstream log(dir / "out" / ("a.ubx." + first.results()[0].hash + ".log.txt"));
+  std::stringstream text;
+  text << log.rdbuf();
+  EXPECT_EQ(text.str(), readOutput((dir / "in" / "a.ubx").string(), GalileoSolver::STREAM));
+
+  BatchDriver second((dir / "out").string(), 2);
+  second.addInput((dir / "in" / "*.ubx").string());
+
+  testing::internal::CaptureStdout();
+  EXPECT_TRUE(second.run());
+  testing::internal::GetCapturedStdout();
+
+  ASSERT_EQ(second.results().size(), 2u);
+  EXPECT_EQ(second.results()[0].status, BatchResult::SKIPPED);
+  EXPECT_EQ(second.results()[1].status, BatchResult::SKIPPED);
+
+  fs::remove_all(dir);
+}
+
+
+TEST(BatchTest, ConvertsCopyWhenFirstConversionFails)
+{
+  namespace fs = std::filesystem;
+
+  const fs::path dir = fs::path(testing::TempDir()) / "galileo_batch_retry";
+  fs::remove_all(dir);
+  fs::create_directories(dir / "in");
+
+  std::vector<uint8_t> capture = makeCapture();
+
+  for (const char *name : {"in/a.ubx", "in/b.ubx"})
+  {
+    std::ofstream out(dir / name, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(capture.data()), capture.size());
+  }
+
+  // A directory in the way of the temporary output of the first copy
+  std::string hash;
+  uint64_t bytes;
+  ASSERT_TRUE(BatchDriver::hashFile((dir / "in" / "a.ubx").string(), hash, bytes));
+  fs::create_directories(dir / "out" / ("a.ubx." + hash + ".nav.txt.part"));
+
+  BatchDriver driver((dir / "out").string(), 2);
+  ASSERT_TRUE(driver.addInput((dir / "in").string()));
+
+  testing::internal::CaptureStdout();
+  EXPECT_FALSE(driver.run());
+  testing::internal::GetCapturedStdout();
+
+  ASSERT_EQ(driver.results().size(), 2u);
+  EXPECT_EQ(driver.results()[0].status, BatchResult::FAILED);
+  EXPECT_EQ(driver.results()[1].status, BatchResult::CONVERTED);
+  EXPECT_TRUE(fs::exists(dir / "out" / ("b.ubx." + hash + ".nav.txt")));
+
+  fs::remove_all(dir);
+}
+
+TEST(ReentrancyTest, ConcurrentSolversKeepOwnOutput)
+{
+  std::string path = writeCapture(makeEphemerisCapture());
+
+  std::ostringstream expected_console, expected_nav_data;
+  GalileoSolver(path, expected_console, expected_nav_data).read();
+
+  EXPECT_NE(expected_nav_data.str().find("HEADER"), std::string::npos);
+  EXPECT_NE(expected_nav_data.str().find("\nE26\t"), std::string::npos);
+
+  const int count = 8;
+  std::ostringstream console[count], nav_data[count];
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < count; i++)
+    threads.emplace_back([&, i] {
+      GalileoSolver solver(path, console[i], nav_data[i], (i % 2) ? GalileoSolver::MMAP : GalileoSolver::STREAM);
+      solver.read();
+    });
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  // Every solver writes its own header, with the number format of a fresh stream
+  for (int i = 0; i < count; i++)
+  {
+    EXPECT_EQ(console[i].str(), expected_console.str());
+    EXPECT_EQ(nav_data[i].str(), expected_nav_data.str());
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST(FrameIndexTest, SelectedPagesMatchFilteredCapture)
+{
+  std::vector<uint8_t> capture = {0x00, 0xb5, 0x62, 0x02};
+  std::vector<uint8_t> selected;
+  uint32_t seed = 1;
+
+  for (uint8_t svId : {11, 12})
+    for (unsigned word_type : {10, 6, 1, 2, 3, 4, 5})
+    {
+      std::vector<uint8_t> navsig = makeFrame(0x01, 0x43, {0x10, 0x27, 0x00, static_cast<uint8_t>(seed), 0x00, 0x00, 0x00, 0x00});
+      std::vector<uint8_t> page = makePage(svId, 1, word_type, seed++, ephemerisIod(word_type));
+
+      capture.insert(capture.end(), navsig.begin(), navsig.end());
+      capture.insert(capture.end(), page.begin(), page.end());
+
+      if (svId == 11 && word_type <= 5)
+        selected.insert(selected.end(), page.begin(), page.end());
+    }
+
+  std::string path = writeCapture(capture);
+  std::string selected_path = writeCapture(selected, "galileo_selected.ubx");
+
+  std::ostringstream console, nav_data_file;
+  GalileoSolver solver(path, console, nav_data_file);
+
+  FrameIndex index;
+  ASSERT_TRUE(solver.buildIndex(index));
+  ASSERT_EQ(index.size(), 28u);
+
+  const FrameIndexEntry &first = index[1];
+  EXPECT_EQ(first.offset, 4u + 16);
+  EXPECT_EQ(first.svId, 11);
+  EXPECT_EQ(first.word_type, 10);
+  EXPECT_EQ(first.iTOW, 0x01002710u);
+  EXPECT_EQ(index[0].word_type, FrameIndexEntry::NONE);
+
+  // Through the sidecar file, as a later run would
+  std::string index_path = FrameIndex::sidecarPath(path);
+  ASSERT_TRUE(index.write(index_path));
+
+  FrameIndex loaded;
+  ASSERT_TRUE(loaded.load(index_path));
+  EXPECT_TRUE(loaded.isCurrent(path));
+  EXPECT_EQ(loaded.size(), index.size());
+
+  FrameQuery query;
+  ASSERT_TRUE(FrameQuery::parse("E11:1-5", query));
+  EXPECT_FALSE(FrameQuery::parse("E11:5-1", query));
+  EXPECT_FALSE(FrameQuery::parse("G11", query));
+
+  ASSERT_TRUE(solver.readIndexed(loaded, query));
+
+  std::ostringstream expected_console, expected_nav_data;
+  GalileoSolver(selected_path, expected_console, expected_nav_data).read();
+
+  EXPECT_EQ(console.str(), expected_console.str());
+  EXPECT_EQ(nav_data_file.str(), expected_nav_data.str());
+  EXPECT_NE(nav_data_file.str().find("E11"), std::string::npos);
+
+  // The same capture rewritten in place with its size unchanged
+  const auto modified = std::filesystem::last_write_time(path);
+  writeCapture(capture);
+  std::filesystem::last_write_time(path, modified + std::chrono::seconds(1));
+
+  EXPECT_FALSE(loaded.isCurrent(path));
+  EXPECT_FALSE(solver.readIndexed(loaded, query));
+
+  std::remove(index_path.c_str());
+  std::remove(selected_path.c_str());
+  std::remove(path.c_str());
+}
+
+TEST(FrameIndexTest, WindowDecodesOnlyItsSubframes)
+{
+  // Subframes of E11 every 30 s, word 5 and 6 carry the time
+  const uint32_t week = 1148;
+  const uint32_t start = 302400;
+
+  std::vector<uint8_t> capture, window;
+  uint32_t seed = 1;
+
+  for (uint32_t subframe = 0; subframe < 10; subframe++)
+  {
+    const uint32_t tow = start + 30 * subframe;
+
+    for (unsigned word_type : {6, 10, 1, 2, 3, 4, 5})
+    {
+      std::vector<std::array<uint32_t, 3>> fields;
+
+      if (word_type == 5)
+        fields = {{67, 12, week}, {79, 20, tow}};
+      else if (word_type == 6)
+        fields = {{99, 20, tow}};
+      else if (word_type <= 4)
+        fields = {{0, 10, subframe}}; // A new IODnav in every subframe
+
+      std::vector<uint8_t> page = makePage(11, 1, word_type, seed++, fields);
+      capture.insert(capture.end(), page.begin(), page.end());
+
+      // A page carries the time of the last word 5 or 6 up to it
+      if (subframe >= 4 && subframe <= 6)
+        window.insert(window.end(), page.begin(), page.end());
+    }
+  }
+
+  std::string path = writeCapture(capture);
+  std::string window_path = writeCapture(window, "galileo_window.ubx");
+
+  std::ostringstream console, nav_data_file;
+  GalileoSolver solver(path, console, nav_data_file);
+
+  FrameIndex index;
+  ASSERT_TRUE(solver.buildIndex(index));
+  ASSERT_EQ(index.size(), 70u);
+
+  EXPECT_EQ(index[0].gst, FrameIndexEntry::NO_GST);
+  EXPECT_EQ(index[6].gst, week * 604800 + start);
+  EXPECT_EQ(index[7].gst, week * 604800 + start + 30);
+
+  uint32_t first, last;
+  ASSERT_TRUE(FrameQuery::parseWindow("1148:302550,1148:302580", first, last));
+  EXPECT_FALSE(FrameQuery::parseWindow("1148:302580,1148:302550", first, last));
+  ASSERT_TRUE(FrameQuery::parseWindow("1148:302550,1148:302580", first, last));
+
+  // The lead-in of one subframe reaches back to the word 5 of subframe 4
+  FrameQuery query;
+  query.setWindow(first, last, 30);
+
+  ASSERT_TRUE(solver.readIndexed(index, query));
+
+  std::ostringstream expected_console, expected_nav_data;
+  GalileoSolver(window_path, expected_console, expected_nav_data).read();
+
+  EXPECT_EQ(console.str(), expected_console.str());
+  EXPECT_EQ(nav_data_file.str(), expected_nav_data.str());
+
+  std::remove(window_path.c_str());
+  std::remove(path.c_str());
+}
+
+TEST(FollowTest, ResumesFromCheckpointAndFollowsGrowth)
+{
+  std::vector<uint8_t> capture = makeCapture();
+  std::vector<uint8_t> ephemeris = makeEphemerisCapture();
+  capture.insert(capture.end(), ephemeris.begin(), ephemeris.end());
+
+  const std::string path = testing::TempDir() + "galileo_follow.ubx";
+  const std::string checkpoint = path + ".ckpt";
+  std::remove(path.c_str());
+  std::remove(checkpoint.c_str());
+
+  auto append = [&](size_t begin, size_t end) {
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    file.write(reinterpret_cast<const char *>(capture.data() + begin), end - begin);
+  };
+
+  // Both splits fall inside frames
+  const size_t split1 = capture.size() / 3 + 7;
+  const size_t split2 = 2 * capture.size() / 3 + 1;
+
+  append(0, split1);
+
+  std::ostringstream nav_data_file;
+  std::atomic<bool> stopped(true);
+
+  {
+    std::ostringstream console;
+    GalileoSolver first(path, console, nav_data_file);
+    ASSERT_TRUE(first.follow(checkpoint, stopped));
+  }
+
+  append(split1, split2);
+
+  std::ostringstream console;
+  GalileoSolver second(path, console, nav_data_file);
+  std::atomic<bool> stop(false);
+
+  std::thread follower([&] { EXPECT_TRUE(second.follow(checkpoint, stop)); });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  append(split2, capture.size());
+  stop = true;
+  follower.join();
+
+  std::ostringstream expected_console, expected_nav_data;
+  GalileoSolver(path, expected_console, expected_nav_data).read();
+
+  EXPECT_NE(expected_nav_data.str().find("HEADER"), std::string::npos);
+  EXPECT_EQ(nav_data_file.str(), expected_nav_data.str());
+
+  std::remove(checkpoint.c_str());
+  std::remove(path.c_str());
+}
+
+// Navigation data sink that can be looked at while a solver writes into it
+class LiveSink : public std::streambuf
+{
+private:
+  std::mutex mutex_;
+  std::string text_;
+  std::string flushed_;
+
+protected:
+  int overflow(int c) override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    text_.push_back(static_cast<char>(c));
+    return c;
+  }
+
+  std::streamsize xsputn(const char *s, std::streamsize n) override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    text_.append(s, n);
+    return n;
+  }
+
+  int sync() override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushed_ = text_;
+    return 0;
+  }
+
+public:
+  std::string flushed()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return flushed_;
+  }
+};
+
+TEST(FollowTest, CheckpointKeepsPageClock)
+{
+  const uint32_t week = 1300, time_of_week = 345600;
+  const double gst = week * 604800.0 + time_of_week;
+
+  // Word 5 sets the page clock before the stop, word 16 is dated by it after the resume
+  std::vector<uint8_t> before = makePage(11, 1, 5, 1, {{67, 12, week}, {79, 20, time_of_week}});
+  std::vector<uint8_t> after = makePage(11, 1, 16, 2, {{0, 31, 0}, {31, 17, 0}});
+
+  const std::string path = testing::TempDir() + "galileo_follow_clock.ubx";
+  const std::string checkpoint = path + ".ckpt";
+  std::remove(checkpoint.c_str());
+
+  std::ostringstream console, nav_data_file;
+  std::atomic<bool> stopped(true);
+
+  writeCapture(before, "galileo_follow_clock.ubx");
+  {
+    GalileoSolver first(path, console, nav_data_file);
+    ASSERT_TRUE(first.follow(checkpoint, stopped));
+    EXPECT_EQ(first.clock().pageTime(11, 1), gst);
+  }
+
+  std::ofstream(path, std::ios::binary | std::ios::app).write(reinterpret_cast<const char *>(after.data()), after.size());
+
+  GalileoSolver second(path, console, nav_data_file);
+  ASSERT_TRUE(second.follow(checkpoint, stopped));
+
+  EXPECT_EQ(second.clock().pageTime(11, 1), gst + 2);
+  EXPECT_EQ(second.orbits().source(11, gst + 2), OrbitStore::REDUCED);
+
+  std::remove(checkpoint.c_str());
+  std::remove(path.c_str());
+}
+
+
+TEST(FollowTest, CheckpointKeepsFec2Words)
+{
+  // Words 1, 3, 4 and 17 before the stop, word 18 after the resume rebuilds word 2
+  std::vector<uint8_t> before, after;
+  std::array<InavPage, 4> words;
+  uint32_t seed = 1;
+
+  for (unsigned word_type : {1, 2, 3, 4})
+  {
+    std::vector<uint8_t> page = makePage(11, 1, word_type, seed++, {{0, 10, 0x2c5}});
+
+    uint32_t dwords[8];
+    std::memcpy(dwords, page.data() + 6 + 8, sizeof(dwords));
+    words[word_type - 1] = InavPage(dwords);
+
+    if (word_type != 2)
+      before.insert(before.end(), page.begin(), page.end());
+  }
+
+  std::array<InavPage, 4> fec2 = makeFec2Pages(words);
+
+  for (unsigned word = 0; word < 2; word++)
+  {
+    std::vector<std::array<uint32_t, 3>> fields = {{120, 2, uint32_t(fec2[word].bits(126, 2))}};
+    for (unsigned i = 0; i < 15; i++)
+      fields.push_back({8 * i, 8, uint32_t(fec2[word].bits(6 + 8 * i, 8))});
+
+    std::vector<uint8_t> page = makePage(11, 1, 17 + word, seed++, fields);
+    std::vector<uint8_t> &part = (word == 0) ? before : after;
+    part.insert(part.end(), page.begin(), page.end());
+  }
+
+  const std::string path = writeCapture(before, "galileo_follow_fec2.ubx");
+  const std::string checkpoint = path + ".ckpt";
+  std::remove(checkpoint.c_str());
+
+  std::ostringstream console, nav_data_file;
+  std::atomic<bool> stopped(true);
+  {
+    GalileoSolver first(path, console, nav_data_file);
+    ASSERT_TRUE(first.follow(checkpoint, stopped));
+    EXPECT_EQ(first.fec2RecoveredCount(), 0u);
+  }
+
+  std::ofstream(path, std::ios::binary | std::ios::app).write(reinterpret_cast<const char *>(after.data()), after.size());
+
+  GalileoSolver second(path, console, nav_data_file);
+  ASSERT_TRUE(second.follow(checkpoint, stopped));
+  EXPECT_EQ(second.fec2RecoveredCount(), 1u);
+
+  std::remove(checkpoint.c_str());
+  std::remove(path.c_str());
+}
+
+
+TEST(LiveInputTest, PublishesEphemerisBeforeNextFrame)
+{
+  const std::vector<uint8_t> capture = makeEphemerisCapture();
+  const std::string path = writeCapture(capture, "galileo_live.ubx");
+
+  std::ostringstream expected_console, expected_nav_data;
+  GalileoSolver(path, expected_console, expected_nav_data).read();
+  ASSERT_NE(expected_nav_data.str().find("HEADER"), std::string::npos);
+
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  ASSERT_GE(master, 0);
+  ASSERT_EQ(grantpt(master), 0);
+  ASSERT_EQ(unlockpt(master), 0);
+
+  const std::string device = ptsname(master);
+
+  // Raw from the start, so the bytes written before the solver opens the device stay as they are
+  int slave = open(device.c_str(), O_RDWR | O_NOCTTY);
+  termios tty;
+  ASSERT_EQ(tcgetattr(slave, &tty), 0);
+  cfmakeraw(&tty);
+  tcsetattr(slave, TCSANOW, &tty);
+
+  LiveSink sink;
+  std::ostream nav_data_file(&sink);
+  std::ostringstream console;
+  GalileoSolver solver(device, console, nav_data_file);
+
+  std::thread reader([&] { EXPECT_TRUE(solver.read()); });
+
+  // Frame by frame at 115200 baud, 10 bits per byte
+  auto start = std::chrono::steady_clock::now();
+  size_t written = 0;
+
+  for (size_t begin = 0; begin < capture.size();)
+  {
+    size_t length = 8 + (capture[begin + 4] | capture[begin + 5] << 8);
+    EXPECT_EQ(write(master, capture.data() + begin, length), static_cast<ssize_t>(length));
+
+    begin += length;
+    written += length;
+    std::this_thread::sleep_until(start + std::chrono::microseconds(written * 10 * 1000000 / 115200));
+  }
+
+  // The last page completes the last ephemeris, no frame follows it while the link stays open
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+
+  while (sink.flushed() != expected_nav_data.str() && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  EXPECT_EQ(sink.flushed(), expected_nav_data.str());
+
+  close(master);
+  reader.join();
+  close(slave);
+
+  EXPECT_EQ(console.str(), expected_console.str());
+
+  std::remove(path.c_str());
+}
+
+TEST(IngestServerTest, ConnectionsDecodeLikeFiles)
+{
+  std::vector<uint8_t> capture = makeCapture();
+  std::vector<uint8_t> ephemeris = makeEphemerisCapture();
+  capture.insert(capture.end(), ephemeris.begin(), ephemeris.end());
+
+  const std::string path = writeCapture(capture, "galileo_served.ubx");
+  const std::string output_dir = testing::TempDir() + "galileo_server";
+  std::filesystem::remove_all(output_dir);
+
+  std::ostringstream expected_console, expected_nav_data;
+  GalileoSolver(path, expected_console, expected_nav_data).read();
+
+  std::ostringstream server_console;
+  IngestServer server(output_dir, server_console);
+  ASSERT_TRUE(server.listen(0, "127.0.0.1"));
+
+  std::atomic<bool> stop(false);
+  std::thread serving([&] { EXPECT_TRUE(server.run(2, stop)); });
+
+  // Receivers replay the capture at the same time, each in its own piece sizes
+  const size_t receivers = 3;
+  std::vector<int> sockets;
+  std::vector<std::string> bases;
+
+  for (size_t i = 0; i < receivers; i++)
+  {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(server.port());
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+
+    socklen_t length = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &length);
+
+    sockets.push_back(fd);
+    bases.push_back(IngestServer::outputBase(output_dir, "127.0.0.1", ntohs(addr.sin_port)));
+  }
+
+  std::vector<size_t> sent(receivers, 0);
+
+  for (size_t piece = 0; *std::min_element(sent.begin(), sent.end()) < capture.size(); piece++)
+    for (size_t i = 0; i < receivers; i++)
+    {
+      size_t size = std::min(capture.size() - sent[i], 1 + (piece * 7 + i * 13) % 61);
+
+      EXPECT_EQ(send(sockets[i], capture.data() + sent[i], size, 0), static_cast<ssize_t>(size));
+      sent[i] += size;
+    }
+
+  for (int fd : sockets)
+    close(fd);
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+  while ((server.acceptCount() < receivers || server.openCount() > 0) && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+  stop = true;
+  serving.join();
+
+  EXPECT_EQ(server.acceptCount(), receivers);
+
+  for (const std::string &base : bases)
+  {
+    std::ifstream nav_data_file(base + ".nav.txt"), console(base + ".log.txt");
+    std::stringstream nav_data, log;
+    nav_data << nav_data_file.rdbuf();
+    log << console.rdbuf();
+
+    EXPECT_EQ(nav_data.str(), expected_nav_data.str()) << base;
+    EXPECT_EQ(log.str(), expected_console.str()) << base;
+  }
+
+  std::filesystem::remove_all(output_dir);
+  std::remove(path.c_str());
+}
+
+TEST(SyncScannerTest, BackendsFindSameCandidates)
+{
+  std::vector<uint8_t> buffer(300, 0xb5);
+  for (size_t i = 0; i < buffer.size(); i += 7)
+    buffer[i] = 0x62;
+  buffer[31] = 0xb5; buffer[32] = 0x62; // Across a 32 byte block
+  buffer.back() = 0xb5; // Trailing first header byte
+
+  for (size_t begin = 0; begin < 40; begin++)
+  {
+    const uint8_t *p = buffer.data() + begin;
+    const uint8_t *end = buffer.data() + buffer.size();
+
+    while (p < end)
+    {
+      const uint8_t *expected = findSyncHeaders(SCALAR_SCANNER, p, end);
+
+      EXPECT_EQ(findSyncHeaders(SSE2_SCANNER, p, end), expected);
+      EXPECT_EQ(findSyncHeaders(AVX2_SCANNER, p, end), expected);
+      EXPECT_EQ(findSyncHeaders(p, end), expected);
+
+      p = expected + 1;
+    }
+  }
+
+  EXPECT_EQ(findSyncHeaders(buffer.data() + 295, buffer.data() + 300), buffer.data() + 299);
+}
+
+TEST(ChecksumTest, KernelsMatchScalar)
+{
+  std::vector<uint8_t> data(1000);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = (i * 167 + 13) & 0xff;
+
+  for (size_t size : {0, 1, 15, 16, 31, 32, 33, 63, 64, 100, 511, 1000})
+  {
+    uint8_t expected_a = 0x12, expected_b = 0x34;
+    updateChecksum(SCALAR_CHECKSUM, expected_a, expected_b, data.data(), size);
+
+    for (ChecksumKernel kernel : {SSE2_CHECKSUM, AVX2_CHECKSUM})
+    {
+      uint8_t ck_a = 0x12, ck_b = 0x34;
+      updateChecksum(kernel, ck_a, ck_b, data.data(), size);
+
+      EXPECT_EQ(ck_a, expected_a);
+      EXPECT_EQ(ck_b, expected_b);
+    }
+  }
+}
+
+TEST(ChecksumTest, MatchesFrameChecksum)
 {
-  uint64_t util_word = 0x3F00C0000000;
-  uint64_t data_word = 0xFFFFC0003FFFC000; 
+  std::vector<uint8_t> frame = makeFrame(0x01, 0x43, std::vector<uint8_t>(200, 0xa7));
 
-  test->maskWordUtilMiddle(util_word);
-  EXPECT_EQ(test->getBits(util_word, 8), 0xff); 
+  uint8_t ck_a = 0, ck_b = 0;
+  updateChecksum(ck_a, ck_b, frame.data() + 2, frame.size() - 4);
 
-  test->maskWordDataMiddle(data_word);
-  EXPECT_EQ(test->getBits(data_word, 34), 0x3FFFFFFFF); 
+  EXPECT_EQ(ck_a, frame[frame.size() - 2]);
+  EXPECT_EQ(ck_b, frame[frame.size() - 1]);
 }
 
 TEST_F(NavigationDataTest, MemberInitializing) {} // Memberları public yapmam gerekiyor test edebilmem için???